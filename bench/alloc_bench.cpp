@@ -0,0 +1,540 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+// 分配器基准：pool_allocator、loki（concurrent_fixed_allocator 按 8 字节分级）与 glibc malloc
+//
+// 负载：
+//   churn      随机大小的工作集，每次释放一个随机槽位再分配一个新的
+//   lifo/fifo/random  先分配一批再按后进先出、先进先出、随机顺序释放
+//   prodcons   生产者分配、消费者释放，成对的线程之间用无锁环形队列传递
+//   larson     Larson 服务器模拟：每轮线程接手上一轮其他线程的对象数组，随机替换其中的对象
+//   frag       稳态碎片：先填满小对象，随机释放 90%，再用大一些的对象填回去，比较 RSS 与存活字节数
+//   large      32 KiB ~ 256 KiB 的 churn，工作集 LARGE_SLOTS 个；这个负载不测 loki（大小都转给 malloc），
+//              换成测 malloc 语义的 global_allocator
+//
+// 每个 (负载, 分配器, 线程数) 在 fork 出的子进程中运行，RSS 互不影响。延迟每 16 次操作采样一次
+// 用法：zephyr_bench [--threads 1,2,4] [--ops N] [--filter 负载名] [--json 文件]，--json 按行输出 JSON
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <utility>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+
+namespace zephyr
+{
+
+namespace bench
+{
+
+// ---------------------------------------------------------------------------
+// 计时与结果
+// ---------------------------------------------------------------------------
+
+typedef std::chrono::steady_clock clock_type;
+
+// 每个线程一个；每 16 次操作记录一次单次操作的纳秒数
+class recorder {
+
+public:
+    recorder() : ops_(0) { samples_.reserve(1 << 16); }
+
+    template <typename F>
+    void op(F f) {
+        if ((ops_++ & 15) != 0) {
+            f();
+            return ;
+        }
+        clock_type::time_point t0 = clock_type::now();
+        f();
+        clock_type::time_point t1 = clock_type::now();
+        samples_.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+    }
+
+    // 把另一段运行的计数与采样并进来
+    void merge(const recorder& other) {
+        ops_ += other.ops_;
+        samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    }
+
+    uint64_t ops() const { return ops_; }
+    const std::vector<uint32_t>& samples() const { return samples_; }
+
+private:
+    uint64_t ops_;
+    std::vector<uint32_t> samples_;
+};
+
+// 通过管道从子进程传回父进程，只含平凡类型
+struct result {
+    char workload[16];
+    char allocator[16];
+    int threads;
+    uint64_t ops;
+    double seconds;
+    double p50, p90, p99, p999, max;
+    long rss_peak_kb;
+    long rss_end_kb;
+    long live_kb;       // 只有 frag 负载填写
+};
+
+void summarize(const std::vector<recorder>& recorders, result& r) {
+    std::vector<uint32_t> all;
+    r.ops = 0;
+    for (const recorder& rec : recorders) {
+        r.ops += rec.ops();
+        all.insert(all.end(), rec.samples().begin(), rec.samples().end());
+    }
+    std::sort(all.begin(), all.end());
+    auto at = [&all](double q) {
+        if (all.empty()) return 0.0;
+        size_t i = static_cast<size_t>(q * (all.size() - 1));
+        return static_cast<double>(all[i]);
+    };
+    r.p50 = at(0.5);
+    r.p90 = at(0.9);
+    r.p99 = at(0.99);
+    r.p999 = at(0.999);
+    r.max = all.empty() ? 0.0 : static_cast<double>(all.back());
+}
+
+// 大多是小对象：70% 在 8 ~ 64 字节，25% 在 65 ~ 512 字节，5% 在 513 ~ 4096 字节
+size_t random_size(std::mt19937_64& rng) {
+    uint64_t x = rng();
+    uint64_t bucket = x % 100;
+    x >>= 8;
+    if (bucket < 70) return 8 + x % 57;
+    if (bucket < 95) return 65 + x % 448;
+    return 513 + x % 3584;
+}
+
+// 在 threads 个线程上并发运行 body(thread_index, recorder)，返回墙钟秒数
+template <typename Body>
+double run_threads(int threads, std::vector<recorder>& recorders, Body body) {
+    recorders.assign(threads, recorder());
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            body(t, recorders[t]);
+        });
+    }
+    while (ready.load() != threads)
+        std::this_thread::yield();
+    clock_type::time_point start = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& th : pool)
+        th.join();
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+struct block {
+    void* p;
+    size_t n;
+};
+
+// ---------------------------------------------------------------------------
+// 负载
+// ---------------------------------------------------------------------------
+
+enum { WORKING_SET = 20000 };
+
+template <typename A>
+void churn(int threads, uint64_t ops, result& r) {
+    std::vector<recorder> recs;
+    r.seconds = run_threads(threads, recs, [ops](int t, recorder& rec) {
+        std::mt19937_64 rng(t + 1);
+        std::vector<block> slots(WORKING_SET);
+        for (block& b : slots) {
+            b.n = random_size(rng);
+            b.p = A::allocate(b.n);
+        }
+        for (uint64_t i = 0; i < ops / 2; ++i) {
+            block& b = slots[rng() % WORKING_SET];
+            rec.op([&b]() { A::deallocate(b.p, b.n); });
+            b.n = random_size(rng);
+            rec.op([&b]() { b.p = A::allocate(b.n); });
+        }
+        for (block& b : slots)
+            A::deallocate(b.p, b.n);
+    });
+    summarize(recs, r);
+}
+
+enum { LARGE_SLOTS = 16 };
+enum { LARGE_OPS_DIVISOR = 16 };
+
+// 32 KiB + 1 ~ 256 KiB 均匀分布：刚好超出 pool 尺寸分级的请求，例如增长中的 vector、string
+size_t large_size(std::mt19937_64& rng) {
+    return (32 << 10) + 1 + rng() % (224 << 10);
+}
+
+// 与 churn 相同，但大小都在 32 KiB 以上；每次分配写第一个字节，操作数为 ops / LARGE_OPS_DIVISOR
+template <typename A>
+void large(int threads, uint64_t ops, result& r) {
+    std::vector<recorder> recs;
+    r.seconds = run_threads(threads, recs, [ops](int t, recorder& rec) {
+        std::mt19937_64 rng(t + 1);
+        std::vector<block> slots(LARGE_SLOTS);
+        for (block& b : slots) {
+            b.n = large_size(rng);
+            b.p = A::allocate(b.n);
+        }
+        for (uint64_t i = 0; i < ops / LARGE_OPS_DIVISOR / 2; ++i) {
+            block& b = slots[rng() % LARGE_SLOTS];
+            rec.op([&b]() { A::deallocate(b.p, b.n); });
+            b.n = large_size(rng);
+            rec.op([&b]() { b.p = A::allocate(b.n); });
+            *static_cast<char*>(b.p) = 1;
+        }
+        for (block& b : slots)
+            A::deallocate(b.p, b.n);
+    });
+    summarize(recs, r);
+}
+
+enum free_order { LIFO, FIFO, RANDOM };
+
+enum { BATCH = 10000 };
+
+template <typename A>
+void ordered(free_order order, int threads, uint64_t ops, result& r) {
+    std::vector<recorder> recs;
+    r.seconds = run_threads(threads, recs, [order, ops](int t, recorder& rec) {
+        std::mt19937_64 rng(t + 1);
+        std::vector<block> batch(BATCH);
+        std::vector<size_t> index(BATCH);
+        for (size_t i = 0; i < index.size(); ++i)
+            index[i] = i;
+        for (uint64_t done = 0; done < ops; done += 2 * BATCH) {
+            for (block& b : batch) {
+                b.n = random_size(rng);
+                rec.op([&b]() { b.p = A::allocate(b.n); });
+            }
+            if (order == LIFO)
+                std::reverse(index.begin(), index.end());
+            else if (order == RANDOM)
+                std::shuffle(index.begin(), index.end(), rng);
+            for (size_t i : index) {
+                block& b = batch[i];
+                rec.op([&b]() { A::deallocate(b.p, b.n); });
+            }
+            if (order == LIFO)
+                std::reverse(index.begin(), index.end());
+        }
+    });
+    summarize(recs, r);
+}
+
+// 单生产者单消费者的环形队列
+class ring {
+
+public:
+    enum { capacity = 4096 };
+
+    ring() : head_(0), tail_(0) {}
+
+    bool push(const block& b) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == capacity)
+            return false;
+        slots_[tail % capacity] = b;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(block& b) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+        b = slots_[head % capacity];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+    block slots_[capacity];
+};
+
+// 偶数号线程生产，下一个线程消费；需要至少 2 个线程
+template <typename A>
+void prodcons(int threads, uint64_t ops, result& r) {
+    int pairs = threads / 2;
+    std::vector<ring> rings(pairs);
+    std::vector<recorder> recs;
+    r.seconds = run_threads(pairs * 2, recs, [&rings, ops](int t, recorder& rec) {
+        ring& q = rings[t / 2];
+        if (t % 2 == 0) {
+            std::mt19937_64 rng(t + 1);
+            for (uint64_t i = 0; i < ops; ++i) {
+                block b;
+                b.n = random_size(rng);
+                rec.op([&b]() { b.p = A::allocate(b.n); });
+                while (!q.push(b))
+                    std::this_thread::yield();
+            }
+        }
+        else {
+            block b;
+            for (uint64_t i = 0; i < ops; ++i) {
+                while (!q.pop(b))
+                    std::this_thread::yield();
+                rec.op([&b]() { A::deallocate(b.p, b.n); });
+            }
+        }
+    });
+    summarize(recs, r);
+}
+
+enum { LARSON_ROUNDS = 8 };
+enum { LARSON_SLOTS = 5000 };
+
+// 第 round 轮时线程 t 处理第 (t + round) % threads 个数组，数组里的对象多是别的线程分配的
+template <typename A>
+void larson(int threads, uint64_t ops, result& r) {
+    std::vector<std::vector<block>> arrays(threads, std::vector<block>(LARSON_SLOTS));
+    std::mt19937_64 seed(42);
+    for (std::vector<block>& a : arrays) {
+        for (block& b : a) {
+            b.n = random_size(seed);
+            b.p = A::allocate(b.n);
+        }
+    }
+    std::vector<recorder> all(threads);
+    r.seconds = 0;
+    for (int round = 0; round < LARSON_ROUNDS; ++round) {
+        std::vector<recorder> recs;
+        r.seconds += run_threads(threads, recs, [&arrays, round, threads, ops](int t, recorder& rec) {
+            std::mt19937_64 rng(t * 131 + round);
+            std::vector<block>& a = arrays[(t + round) % threads];
+            for (uint64_t i = 0; i < ops / LARSON_ROUNDS / 2; ++i) {
+                block& b = a[rng() % LARSON_SLOTS];
+                rec.op([&b]() { A::deallocate(b.p, b.n); });
+                b.n = random_size(rng);
+                rec.op([&b]() { b.p = A::allocate(b.n); });
+            }
+        });
+        for (int t = 0; t < threads; ++t)
+            all[t].merge(recs[t]);
+    }
+    for (std::vector<block>& a : arrays)
+        for (block& b : a)
+            A::deallocate(b.p, b.n);
+    summarize(all, r);
+}
+
+enum { FRAG_LIVE_BYTES = 64 << 20 };
+
+// 单线程：16 ~ 128 字节的对象填到 FRAG_LIVE_BYTES，随机释放 90%，再用 200 ~ 2000 字节的对象填回去
+template <typename A>
+void frag(int, uint64_t, result& r) {
+    std::vector<recorder> recs;
+    std::vector<block> live;
+    size_t live_bytes = 0;
+    r.seconds = run_threads(1, recs, [&live, &live_bytes](int, recorder& rec) {
+        std::mt19937_64 rng(7);
+        while (live_bytes < static_cast<size_t>(FRAG_LIVE_BYTES)) {
+            block b;
+            b.n = 16 + rng() % 113;
+            rec.op([&b]() { b.p = A::allocate(b.n); });
+            live.push_back(b);
+            live_bytes += b.n;
+        }
+        std::shuffle(live.begin(), live.end(), rng);
+        size_t keep = live.size() / 10;
+        for (size_t i = keep; i < live.size(); ++i) {
+            block& b = live[i];
+            rec.op([&b]() { A::deallocate(b.p, b.n); });
+            live_bytes -= b.n;
+        }
+        live.resize(keep);
+        while (live_bytes < static_cast<size_t>(FRAG_LIVE_BYTES)) {
+            block b;
+            b.n = 200 + rng() % 1801;
+            rec.op([&b]() { b.p = A::allocate(b.n); });
+            live.push_back(b);
+            live_bytes += b.n;
+        }
+    });
+    summarize(recs, r);
+    r.live_kb = static_cast<long>(live_bytes / 1024);
+    r.rss_end_kb = proc_status_kb("VmRSS");
+    for (block& b : live)
+        A::deallocate(b.p, b.n);
+}
+
+// ---------------------------------------------------------------------------
+// 驱动
+// ---------------------------------------------------------------------------
+
+template <typename A>
+void run_workload(const std::string& workload, int threads, uint64_t ops, result& r) {
+    if (workload == "churn")
+        churn<A>(threads, ops, r);
+    else if (workload == "lifo")
+        ordered<A>(LIFO, threads, ops, r);
+    else if (workload == "fifo")
+        ordered<A>(FIFO, threads, ops, r);
+    else if (workload == "random")
+        ordered<A>(RANDOM, threads, ops, r);
+    else if (workload == "prodcons")
+        prodcons<A>(threads, ops, r);
+    else if (workload == "larson")
+        larson<A>(threads, ops, r);
+    else if (workload == "frag")
+        frag<A>(threads, ops, r);
+    else if (workload == "large")
+        large<A>(threads, ops, r);
+}
+
+// 在子进程中运行，结果经管道传回；子进程异常退出时返回 false
+template <typename A>
+bool measure(const std::string& workload, int threads, uint64_t ops, result& r) {
+    r = result();
+    snprintf(r.workload, sizeof(r.workload), "%s", workload.c_str());
+    snprintf(r.allocator, sizeof(r.allocator), "%s", A::name());
+    r.threads = threads;
+    return run_in_child(r, [&workload, threads, ops](result& out) {
+        run_workload<A>(workload, threads, ops, out);
+        out.rss_peak_kb = proc_status_kb("VmHWM");
+        if (out.rss_end_kb == 0)
+            out.rss_end_kb = proc_status_kb("VmRSS");
+    });
+}
+
+std::string to_json(const result& r) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3)
+        << "{\"workload\":\"" << r.workload << "\",\"allocator\":\"" << r.allocator << "\""
+        << ",\"threads\":" << r.threads
+        << ",\"ops\":" << r.ops
+        << ",\"seconds\":" << r.seconds
+        << ",\"mops\":" << (r.seconds > 0 ? r.ops / r.seconds / 1e6 : 0.0)
+        << ",\"mops_per_thread\":" << (r.seconds > 0 ? r.ops / r.seconds / 1e6 / r.threads : 0.0)
+        << ",\"p50_ns\":" << r.p50
+        << ",\"p90_ns\":" << r.p90
+        << ",\"p99_ns\":" << r.p99
+        << ",\"p999_ns\":" << r.p999
+        << ",\"max_ns\":" << r.max
+        << ",\"rss_peak_kb\":" << r.rss_peak_kb
+        << ",\"rss_end_kb\":" << r.rss_end_kb
+        << ",\"live_kb\":" << r.live_kb << "}";
+    return out.str();
+}
+
+void print_header() {
+    std::cout << std::left << std::setw(10) << "workload" << std::setw(8) << "alloc" << std::right
+              << std::setw(4) << "thr" << std::setw(10) << "Mops/s" << std::setw(10) << "p50 ns"
+              << std::setw(10) << "p99 ns" << std::setw(10) << "p99.9 ns" << std::setw(11) << "max ns"
+              << std::setw(12) << "peak RSS KB" << std::setw(12) << "live KB" << std::endl;
+}
+
+void print_row(const result& r) {
+    std::cout << std::left << std::setw(10) << r.workload << std::setw(8) << r.allocator << std::right
+              << std::setw(4) << r.threads << std::fixed << std::setprecision(2)
+              << std::setw(10) << (r.seconds > 0 ? r.ops / r.seconds / 1e6 : 0.0)
+              << std::setprecision(0)
+              << std::setw(10) << r.p50 << std::setw(10) << r.p99 << std::setw(10) << r.p999
+              << std::setw(11) << r.max << std::setw(12) << r.rss_peak_kb << std::setw(12) << r.live_kb
+              << std::endl;
+}
+
+std::vector<int> parse_threads(const char* list) {
+    std::vector<int> threads;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+        if (atoi(item.c_str()) > 0)
+            threads.push_back(atoi(item.c_str()));
+    return threads;
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> threads = { 1, 2, 4 };
+    uint64_t ops = 2000000;
+    std::string filter;
+    std::string json_path;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--threads")
+            threads = parse_threads(argv[i + 1]);
+        else if (flag == "--ops")
+            ops = strtoull(argv[i + 1], nullptr, 10);
+        else if (flag == "--filter")
+            filter = argv[i + 1];
+        else if (flag == "--json")
+            json_path = argv[i + 1];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--threads 1,2,4] [--ops N] [--filter workload] [--json file]"
+                      << std::endl;
+            return 2;
+        }
+    }
+
+    std::ofstream json;
+    if (!json_path.empty())
+        json.open(json_path.c_str());
+
+    const char* workloads[] = { "churn", "lifo", "fifo", "random", "prodcons", "larson", "frag", "large" };
+    print_header();
+    int failures = 0;
+    for (const char* workload : workloads) {
+        if (!filter.empty() && filter != workload)
+            continue;
+        std::string w = workload;
+        std::vector<int> done;
+        for (int t : threads) {
+            // frag 只用一个线程；prodcons 需要成对的线程，取整后重复的线程数只跑一次
+            int n = w == "frag" ? 1 : (w == "prodcons" ? (t < 2 ? 2 : t / 2 * 2) : t);
+            if (std::find(done.begin(), done.end(), n) != done.end())
+                continue;
+            done.push_back(n);
+            result rows[3];
+            bool ok[3] = {
+                measure<pool_backend>(w, n, ops, rows[0]),
+                w == "large" ? measure<global_backend>(w, n, ops, rows[1])
+                             : measure<loki_backend>(w, n, ops, rows[1]),
+                measure<malloc_backend>(w, n, ops, rows[2])
+            };
+            for (int k = 0; k < 3; ++k) {
+                if (!ok[k]) {
+                    ++failures;
+                    std::cerr << workload << ": run failed" << std::endl;
+                    continue;
+                }
+                print_row(rows[k]);
+                if (json.is_open())
+                    json << to_json(rows[k]) << '\n';
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace zephyr::bench
+
+} // namespace zephyr
+
+int main(int argc, char** argv) {
+    return zephyr::bench::main(argc, argv);
+}
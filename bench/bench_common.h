@@ -0,0 +1,163 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#ifndef ZEPHYR_BENCH_COMMON_H
+#define ZEPHYR_BENCH_COMMON_H
+
+// zephyr_bench 与 zephyr_trace_replay 共用：被测的分配器，以及在子进程中运行一次测量
+
+#include <utility>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../src/include/memory/pool_allocator.h"
+#include "../src/include/memory/loki_allocator.h"
+#include "../src/include/memory/global_allocator.h"
+
+namespace zephyr
+{
+
+namespace bench
+{
+
+// ---------------------------------------------------------------------------
+// 被测的分配器：都按 (指针, 大小) 释放
+// ---------------------------------------------------------------------------
+
+struct pool_backend {
+    static const char* name() { return "pool"; }
+    static void* allocate(size_t n) { return pool_allocator::allocate(n); }
+    static void deallocate(void* p, size_t n) { pool_allocator::deallocate(p, n); }
+};
+
+struct malloc_backend {
+    static const char* name() { return "malloc"; }
+    static void* allocate(size_t n) { return malloc(n); }
+    static void deallocate(void* p, size_t) { free(p); }
+};
+
+// malloc 语义的 global_allocator，释放时不用大小
+struct global_backend {
+    static const char* name() { return "global"; }
+    static void* allocate(size_t n) { return global_allocator::allocate(n); }
+    static void deallocate(void* p, size_t) { global_allocator::deallocate(p); }
+};
+
+// 不超过 loki_max_bytes 的大小按 8 字节分级交给 concurrent_fixed_allocator，其余交给 malloc
+enum { loki_step = 8 };
+enum { loki_max_bytes = 256 };
+
+struct loki_backend {
+    typedef void* (*allocate_fn)();
+    typedef void (*deallocate_fn)(void*);
+
+    static const char* name() { return "loki"; }
+
+    static void* allocate(size_t n) {
+        if (n > static_cast<size_t>(loki_max_bytes))
+            return malloc(n);
+        return table().allocate[index(n)]();
+    }
+
+    static void deallocate(void* p, size_t n) {
+        if (n > static_cast<size_t>(loki_max_bytes)) {
+            free(p);
+            return ;
+        }
+        table().deallocate[index(n)](p);
+    }
+
+private:
+    struct functions {
+        allocate_fn allocate[loki_max_bytes / loki_step];
+        deallocate_fn deallocate[loki_max_bytes / loki_step];
+    };
+
+    static size_t index(size_t n) {
+        return n == 0 ? 0 : (n - 1) / loki_step;
+    }
+
+    template <size_t ... I>
+    static functions make(std::index_sequence<I...>) {
+        return functions {
+            { &concurrent_fixed_allocator<(I + 1) * loki_step>::allocate ... },
+            { &concurrent_fixed_allocator<(I + 1) * loki_step>::deallocate ... }
+        };
+    }
+
+    static const functions& table() {
+        static const functions f = make(std::make_index_sequence<loki_max_bytes / loki_step>());
+        return f;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// 进程
+// ---------------------------------------------------------------------------
+
+// /proc/self/status 中的一项，单位 KiB
+inline long proc_status_kb(const char* key) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f == nullptr)
+        return 0;
+    char line[256];
+    long value = 0;
+    size_t len = strlen(key);
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (strncmp(line, key, len) == 0 && line[len] == ':') {
+            value = atol(line + len + 1);
+            break;
+        }
+    }
+    fclose(f);
+    return value;
+}
+
+// 把 VmHWM 重置为当前的 VmRSS（Linux 4.0 起支持），失败时返回 false
+inline bool reset_peak_rss() {
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f == nullptr)
+        return false;
+    bool ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+// 在 fork 出的子进程中运行 body(r)，结果经管道传回，各次测量的 RSS 与分配器状态互不影响
+// Result 必须是平凡类型；子进程异常退出时返回 false
+template <typename Result, typename Body>
+bool run_in_child(Result& r, Body body) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        Result out = r;
+        body(out);
+        ssize_t written = write(fds[1], &out, sizeof(out));
+        _exit(written == static_cast<ssize_t>(sizeof(out)) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &r, sizeof(r));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == static_cast<ssize_t>(sizeof(r)) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace zephyr::bench
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_BENCH_COMMON_H
@@ -0,0 +1,219 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+// construct.h 的区间算法与 std::uninitialized_* 的对比：批量构造 n 个元素的每元素纳秒数
+//
+// 类型：int、64 字节的 POD、std::string（短串，在 SSO 缓冲内）、带 unique_ptr 的句柄（特化为可平凡重定位）
+// 操作：copy、move、fill、value_construct，以及 relocate 对比 std::uninitialized_move 之后 std::destroy 源区间
+//
+// libstdc++ 对平凡类型本来也会走 memmove / memset，这两类主要看是否持平；
+// 差别在于 fill 的非零字节模式、value_construct 与 relocate
+// 用法：zephyr_construct_bench [--n 16,1024,65536] [--json 文件]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <stdlib.h>
+
+#include "../src/include/memory/construct.h"
+
+namespace zephyr
+{
+
+namespace bench
+{
+
+struct pod64 {
+    int v[16];
+};
+
+struct handle {
+    std::unique_ptr<int> p;
+    handle() = default;
+    explicit handle(int v) : p(new int(v)) {}
+};
+
+} // namespace zephyr::bench
+
+template <>
+struct is_trivially_relocatable<bench::handle> : std::true_type {};
+
+namespace bench
+{
+
+typedef std::chrono::steady_clock clock_type;
+
+template <typename T> T sample(size_t i);
+template <> int sample<int>(size_t i) { return static_cast<int>(i); }
+template <> pod64 sample<pod64>(size_t i) { pod64 p; std::fill(p.v, p.v + 16, static_cast<int>(i)); return p; }
+template <> std::string sample<std::string>(size_t i) { return std::string(8, char('a' + i % 26)); }
+template <> handle sample<handle>(size_t i) { return handle(static_cast<int>(i)); }
+
+template <typename T> const char* type_name();
+template <> const char* type_name<int>() { return "int"; }
+template <> const char* type_name<pod64>() { return "pod64"; }
+template <> const char* type_name<std::string>() { return "string"; }
+template <> const char* type_name<handle>() { return "handle"; }
+
+struct result {
+    std::string op;
+    std::string type;
+    std::string impl;
+    size_t n;
+    double ns_per_element;
+};
+
+// 在未初始化的 dst 上执行 body，随后由 cleanup 恢复；取 5 轮中最快一轮的平均值
+template <typename Body, typename Cleanup>
+double measure(size_t n, Body body, Cleanup cleanup) {
+    size_t reps = std::max<size_t>(1, (size_t(1) << 22) / n);
+    double best = 1e30;
+    for (int round = 0; round < 5; round++) {
+        double ns = 0;
+        for (size_t r = 0; r < reps; r++) {
+            clock_type::time_point t0 = clock_type::now();
+            body();
+            ns += std::chrono::duration<double, std::nano>(clock_type::now() - t0).count();
+            cleanup();
+        }
+        best = std::min(best, ns / static_cast<double>(reps * n));
+    }
+    return best;
+}
+
+template <typename T>
+struct buffers {
+    std::vector<T> src;
+    T* dst;
+    T* tmp;
+
+    explicit buffers(size_t n) {
+        src.reserve(n);
+        for (size_t i = 0; i < n; i++)
+            src.push_back(sample<T>(i));
+        dst = static_cast<T*>(::operator new(n * sizeof(T)));
+        tmp = static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    ~buffers() {
+        ::operator delete(dst);
+        ::operator delete(tmp);
+    }
+};
+
+template <typename T>
+void copy_cases(size_t n, std::vector<result>& out) {
+    buffers<T> b(n);
+    T* first = b.src.data();
+    T* dst = b.dst;
+    auto cleanup = [&] { zephyr::destroy(dst, dst + n); };
+    out.push_back({"copy", type_name<T>(), "zephyr", n,
+                   measure(n, [&] { zephyr::uninitialized_copy(first, first + n, dst); }, cleanup)});
+    out.push_back({"copy", type_name<T>(), "std", n,
+                   measure(n, [&] { std::uninitialized_copy(first, first + n, dst); }, cleanup)});
+    // 移动以后源对象仍然有效，重复移动同一段源区间即可
+    out.push_back({"move", type_name<T>(), "zephyr", n,
+                   measure(n, [&] { zephyr::uninitialized_move(first, first + n, dst); }, cleanup)});
+    out.push_back({"move", type_name<T>(), "std", n,
+                   measure(n, [&] { std::uninitialized_move(first, first + n, dst); }, cleanup)});
+    const T value = sample<T>(7);
+    out.push_back({"fill", type_name<T>(), "zephyr", n,
+                   measure(n, [&] { zephyr::uninitialized_fill_n(dst, n, value); }, cleanup)});
+    out.push_back({"fill", type_name<T>(), "std", n,
+                   measure(n, [&] { std::uninitialized_fill_n(dst, n, value); }, cleanup)});
+    out.push_back({"value_construct", type_name<T>(), "zephyr", n,
+                   measure(n, [&] { zephyr::uninitialized_value_construct_n(dst, n); }, cleanup)});
+    out.push_back({"value_construct", type_name<T>(), "std", n,
+                   measure(n, [&] { std::uninitialized_value_construct_n(dst, n); }, cleanup)});
+}
+
+// relocate 在 dst 与 tmp 之间来回搬，每次计时之后再搬回 dst，两种实现都不用重新构造源区间
+template <typename T>
+void relocate_cases(size_t n, std::vector<result>& out) {
+    buffers<T> b(n);
+    T* dst = b.dst;
+    T* tmp = b.tmp;
+    zephyr::uninitialized_move(b.src.data(), b.src.data() + n, dst);
+    auto back = [&] { zephyr::relocate(tmp, tmp + n, dst); };
+    out.push_back({"relocate", type_name<T>(), "zephyr", n,
+                   measure(n, [&] { zephyr::relocate(dst, dst + n, tmp); }, back)});
+    out.push_back({"relocate", type_name<T>(), "std", n,
+                   measure(n, [&] {
+                       std::uninitialized_move(dst, dst + n, tmp);
+                       std::destroy(dst, dst + n);
+                   }, back)});
+    zephyr::destroy(dst, dst + n);
+}
+
+std::vector<size_t> parse_list(const char* s) {
+    std::vector<size_t> v;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            v.push_back(strtoull(item.c_str(), nullptr, 10));
+    return v;
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {16, 1024, 65536};
+    std::string json_path;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--n" && i + 1 < argc)
+            sizes = parse_list(argv[++i]);
+        else if (flag == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--n 16,1024,65536] [--json file]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<result> results;
+    for (size_t n : sizes) {
+        if (n == 0)
+            continue;
+        copy_cases<int>(n, results);
+        copy_cases<pod64>(n, results);
+        copy_cases<std::string>(n, results);
+        relocate_cases<int>(n, results);
+        relocate_cases<std::string>(n, results);
+        relocate_cases<handle>(n, results);
+    }
+
+    std::ofstream json;
+    if (!json_path.empty())
+        json.open(json_path.c_str());
+    std::cout << std::left << std::setw(18) << "op" << std::setw(8) << "type" << std::setw(8) << "n"
+              << std::right << std::setw(12) << "zephyr ns" << std::setw(12) << "std ns" << std::setw(10) << "ratio"
+              << std::endl;
+    for (size_t i = 0; i + 1 < results.size(); i += 2) {
+        const result& z = results[i];
+        const result& s = results[i + 1];
+        std::cout << std::left << std::setw(18) << z.op << std::setw(8) << z.type << std::setw(8) << z.n
+                  << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << z.ns_per_element << std::setw(12) << s.ns_per_element
+                  << std::setprecision(2) << std::setw(10) << s.ns_per_element / z.ns_per_element << std::endl;
+        if (json.is_open())
+            for (const result* r : {&z, &s})
+                json << "{\"op\":\"" << r->op << "\",\"type\":\"" << r->type << "\",\"impl\":\"" << r->impl
+                     << "\",\"n\":" << r->n << ",\"ns_per_element\":" << r->ns_per_element << "}\n";
+    }
+    return 0;
+}
+
+} // namespace zephyr::bench
+
+} // namespace zephyr
+
+int main(int argc, char** argv) {
+    return zephyr::bench::main(argc, argv);
+}
@@ -0,0 +1,170 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+// flat_hash_map、node_hash_map 与 std::unordered_map 的对比，键、值都是 uint64_t
+//
+// 容器：std::unordered_map（std::allocator）、std::unordered_map + zephyr::allocator、flat_hash_map、node_hash_map
+// 操作（每操作纳秒数，5 轮取最快）：
+//   insert  从空表插入 n 个随机键，不预留容量
+//   hit     按打乱的顺序查找全部 n 个键
+//   miss    查找 n 个不存在的键
+//   erase   按打乱的顺序删除全部 n 个键
+// 用法：zephyr_hash_bench [--n 1000,65536,1048576] [--json 文件]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../src/include/container/hash_map.h"
+
+namespace zephyr
+{
+
+namespace bench
+{
+
+typedef std::chrono::steady_clock clock_type;
+
+struct result {
+    std::string op;
+    std::string container;
+    size_t n;
+    double ns;
+};
+
+// 防止查找被优化掉
+volatile uint64_t sink;
+
+template <typename Map>
+void run(const char* name, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& order,
+         const std::vector<uint64_t>& absent, std::vector<result>& out) {
+    const size_t n = keys.size();
+    const char* ops[] = {"insert", "hit", "miss", "erase"};
+    double best[4] = {1e30, 1e30, 1e30, 1e30};
+    size_t rounds = n >= (1 << 20) ? 3 : 5;
+    size_t reps = std::max<size_t>(1, (size_t(1) << 18) / n);
+    for (size_t round = 0; round < rounds; round++) {
+        double ns[4] = {0, 0, 0, 0};
+        for (size_t r = 0; r < reps; r++) {
+            Map m;
+            clock_type::time_point t0 = clock_type::now();
+            for (size_t i = 0; i < n; i++)
+                m.insert(std::make_pair(keys[i], keys[i]));
+            clock_type::time_point t1 = clock_type::now();
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; i++)
+                sum += m.find(order[i])->second;
+            clock_type::time_point t2 = clock_type::now();
+            for (size_t i = 0; i < n; i++)
+                sum += m.find(absent[i]) == m.end();
+            clock_type::time_point t3 = clock_type::now();
+            for (size_t i = 0; i < n; i++)
+                sum += m.erase(order[i]);
+            clock_type::time_point t4 = clock_type::now();
+            sink = sum;
+            clock_type::time_point t[] = {t0, t1, t2, t3, t4};
+            for (int k = 0; k < 4; k++)
+                ns[k] += std::chrono::duration<double, std::nano>(t[k + 1] - t[k]).count();
+        }
+        for (int k = 0; k < 4; k++)
+            best[k] = std::min(best[k], ns[k] / static_cast<double>(reps * n));
+    }
+    for (int k = 0; k < 4; k++)
+        out.push_back({ops[k], name, n, best[k]});
+}
+
+std::vector<size_t> parse_list(const char* s) {
+    std::vector<size_t> v;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            v.push_back(strtoull(item.c_str(), nullptr, 10));
+    return v;
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {1000, 65536, 1048576};
+    std::string json_path;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--n" && i + 1 < argc)
+            sizes = parse_list(argv[++i]);
+        else if (flag == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--n 1000,65536,1048576] [--json file]" << std::endl;
+            return 1;
+        }
+    }
+
+    typedef std::pair<const uint64_t, uint64_t> value_type;
+    typedef std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                               allocator<value_type>> pool_unordered_map;
+    const char* names[] = {"std", "std+pool", "flat", "node"};
+
+    std::vector<result> results;
+    for (size_t n : sizes) {
+        if (n == 0)
+            continue;
+        // 偶数键在表中，奇数键用于不命中的查找
+        std::mt19937_64 rng(n);
+        std::vector<uint64_t> keys(n), absent(n);
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = rng() & ~uint64_t(1);
+            absent[i] = rng() | 1;
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::shuffle(keys.begin(), keys.end(), rng);
+        absent.resize(keys.size());
+        std::vector<uint64_t> order = keys;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        run<std::unordered_map<uint64_t, uint64_t>>(names[0], keys, order, absent, results);
+        run<pool_unordered_map>(names[1], keys, order, absent, results);
+        run<flat_hash_map<uint64_t, uint64_t>>(names[2], keys, order, absent, results);
+        run<node_hash_map<uint64_t, uint64_t>>(names[3], keys, order, absent, results);
+    }
+
+    // 每行一个 (操作, n)，四列依次是四种容器
+    std::ofstream json;
+    if (!json_path.empty())
+        json.open(json_path.c_str());
+    std::cout << std::left << std::setw(8) << "op" << std::setw(10) << "n" << std::right;
+    for (const char* name : names)
+        std::cout << std::setw(12) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i + 16 <= results.size(); i += 16) {
+        for (size_t op = 0; op < 4; op++) {
+            std::cout << std::left << std::setw(8) << results[i + op].op << std::setw(10) << results[i + op].n
+                      << std::right << std::fixed << std::setprecision(2);
+            for (size_t c = 0; c < 4; c++)
+                std::cout << std::setw(12) << results[i + c * 4 + op].ns;
+            std::cout << std::endl;
+        }
+    }
+    if (json.is_open())
+        for (const result& r : results)
+            json << "{\"op\":\"" << r.op << "\",\"container\":\"" << r.container
+                 << "\",\"n\":" << r.n << ",\"ns\":" << r.ns << "}\n";
+    return 0;
+}
+
+} // namespace zephyr::bench
+
+} // namespace zephyr
+
+int main(int argc, char** argv) {
+    return zephyr::bench::main(argc, argv);
+}
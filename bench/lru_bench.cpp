@@ -0,0 +1,290 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+// lru_cache、sharded_lru_cache 与 std::list + std::unordered_map 的 LRU 对比，键、值都是 uint64_t
+//
+// 访问序列：n 个键上参数 s = 0.99 的 Zipf 分布，预先生成，缓存容量为 n / 10 个条目
+// 每次访问先 get，不命中时 put（缓存旁路），报告每次访问的纳秒数与命中率
+//   single   单线程：std（list + unordered_map）与 lru_cache
+//   threads  1、2、4 个线程共用一个缓存：std + std::mutex 与 sharded_lru_cache（16 个分片），
+//            每个线程访问序列中各自的一段，纳秒数为总耗时除以总访问次数
+// 用法：zephyr_lru_bench [--n 100000,1000000] [--json 文件]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../src/include/container/lru_cache.h"
+
+namespace zephyr
+{
+
+namespace bench
+{
+
+typedef std::chrono::steady_clock clock_type;
+
+struct result {
+    std::string op;
+    std::string container;
+    size_t n;
+    size_t threads;
+    double ns;
+    double hit_rate;
+};
+
+// 常见的 list + unordered_map 写法，list 中保存键，表中保存值与 list 位置
+class std_lru {
+    typedef std::list<uint64_t> list_type;
+    typedef std::unordered_map<uint64_t, std::pair<uint64_t, list_type::iterator>> map_type;
+
+public:
+    explicit std_lru(size_t capacity) : capacity_(capacity) {}
+
+    bool get(uint64_t key, uint64_t& out) {
+        map_type::iterator it = map_.find(key);
+        if (it == map_.end())
+            return false;
+        list_.splice(list_.begin(), list_, it->second.second);
+        out = it->second.first;
+        return true;
+    }
+
+    void put(uint64_t key, uint64_t value) {
+        map_type::iterator it = map_.find(key);
+        if (it != map_.end()) {
+            it->second.first = value;
+            list_.splice(list_.begin(), list_, it->second.second);
+            return;
+        }
+        list_.push_front(key);
+        map_.emplace(key, std::make_pair(value, list_.begin()));
+        if (map_.size() > capacity_) {
+            map_.erase(list_.back());
+            list_.pop_back();
+        }
+    }
+
+private:
+    size_t capacity_;
+    list_type list_;
+    map_type map_;
+};
+
+class locked_std_lru {
+public:
+    explicit locked_std_lru(size_t capacity) : lru_(capacity) {}
+
+    bool get(uint64_t key, uint64_t& out) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return lru_.get(key, out);
+    }
+
+    void put(uint64_t key, uint64_t value) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        lru_.put(key, value);
+    }
+
+private:
+    std::mutex mutex_;
+    std_lru lru_;
+};
+
+class zephyr_lru {
+public:
+    explicit zephyr_lru(size_t capacity) : lru_(capacity) {}
+
+    bool get(uint64_t key, uint64_t& out) {
+        uint64_t* v = lru_.get(key);
+        if (v == nullptr)
+            return false;
+        out = *v;
+        return true;
+    }
+
+    void put(uint64_t key, uint64_t value) { lru_.put(key, value); }
+
+private:
+    lru_cache<uint64_t, uint64_t> lru_;
+};
+
+// 防止访问被优化掉
+volatile uint64_t sink;
+
+// Zipf 分布：预先算好累积分布，用二分查找取样；秩打乱后映射到键，热点不集中在小键上
+std::vector<uint64_t> zipf_trace(size_t n, size_t length, double s, uint64_t seed) {
+    std::vector<double> cdf(n);
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(n);
+    for (size_t i = 0; i < n; i++)
+        keys[i] = rng();
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<uint64_t> trace(length);
+    for (size_t i = 0; i < length; i++) {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        trace[i] = keys[std::min(rank, n - 1)];
+    }
+    return trace;
+}
+
+template <typename Cache>
+size_t replay(Cache& cache, const uint64_t* first, const uint64_t* last) {
+    size_t hits = 0;
+    uint64_t sum = 0;
+    for (; first != last; ++first) {
+        uint64_t v;
+        if (cache.get(*first, v)) {
+            hits++;
+            sum += v;
+        }
+        else
+            cache.put(*first, *first);
+    }
+    sink = sum;
+    return hits;
+}
+
+// 先用序列的前半段预热，再计时后半段；3 轮取最快
+template <typename Cache>
+void run(const char* op, const char* name, size_t n, size_t threads, const std::vector<uint64_t>& trace,
+         std::vector<result>& out) {
+    const size_t half = trace.size() / 2;
+    const size_t per_thread = half / threads;
+    double best = 1e30, hit_rate = 0;
+    for (int round = 0; round < 3; round++) {
+        Cache cache(n / 10);
+        replay(cache, trace.data(), trace.data() + half);
+        std::vector<size_t> hits(threads, 0);
+        std::vector<std::thread> workers;
+        clock_type::time_point t0 = clock_type::now();
+        for (size_t t = 0; t < threads; t++) {
+            const uint64_t* first = trace.data() + half + t * per_thread;
+            workers.emplace_back([&cache, &hits, t, first, per_thread]() {
+                hits[t] = replay(cache, first, first + per_thread);
+            });
+        }
+        for (std::thread& w : workers)
+            w.join();
+        clock_type::time_point t1 = clock_type::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(per_thread * threads);
+        size_t total = 0;
+        for (size_t h : hits)
+            total += h;
+        if (ns < best) {
+            best = ns;
+            hit_rate = static_cast<double>(total) / static_cast<double>(per_thread * threads);
+        }
+    }
+    out.push_back({op, name, n, threads, best, hit_rate});
+}
+
+// 单线程的缓存直接在当前线程回放，不经过 std::thread
+template <typename Cache>
+void run_single(const char* name, size_t n, const std::vector<uint64_t>& trace, std::vector<result>& out) {
+    const size_t half = trace.size() / 2;
+    double best = 1e30, hit_rate = 0;
+    for (int round = 0; round < 3; round++) {
+        Cache cache(n / 10);
+        replay(cache, trace.data(), trace.data() + half);
+        clock_type::time_point t0 = clock_type::now();
+        size_t hits = replay(cache, trace.data() + half, trace.data() + trace.size());
+        clock_type::time_point t1 = clock_type::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(trace.size() - half);
+        if (ns < best) {
+            best = ns;
+            hit_rate = static_cast<double>(hits) / static_cast<double>(trace.size() - half);
+        }
+    }
+    out.push_back({"single", name, n, 1, best, hit_rate});
+}
+
+struct sharded_lru {
+    explicit sharded_lru(size_t capacity) : lru(capacity) {}
+
+    bool get(uint64_t key, uint64_t& out) { return lru.get(key, out); }
+    void put(uint64_t key, uint64_t value) { lru.put(key, value); }
+
+    sharded_lru_cache<uint64_t, uint64_t> lru;
+};
+
+std::vector<size_t> parse_list(const char* s) {
+    std::vector<size_t> v;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            v.push_back(strtoull(item.c_str(), nullptr, 10));
+    return v;
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {100000, 1000000};
+    std::string json_path;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--n" && i + 1 < argc)
+            sizes = parse_list(argv[++i]);
+        else if (flag == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--n 100000,1000000] [--json file]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<result> results;
+    for (size_t n : sizes) {
+        if (n < 10)
+            continue;
+        std::vector<uint64_t> trace = zipf_trace(n, std::max<size_t>(n * 4, 1 << 21), 0.99, n);
+        run_single<std_lru>("std", n, trace, results);
+        run_single<zephyr_lru>("lru_cache", n, trace, results);
+        for (size_t threads : {1, 2, 4}) {
+            run<locked_std_lru>("threads", "std+mutex", n, threads, trace, results);
+            run<sharded_lru>("threads", "sharded", n, threads, trace, results);
+        }
+    }
+
+    std::ofstream json;
+    if (!json_path.empty())
+        json.open(json_path.c_str());
+    std::cout << std::left << std::setw(9) << "op" << std::setw(12) << "container" << std::setw(10) << "n"
+              << std::setw(9) << "threads" << std::right << std::setw(10) << "ns/op" << std::setw(10) << "hit%"
+              << std::endl;
+    for (const result& r : results) {
+        std::cout << std::left << std::setw(9) << r.op << std::setw(12) << r.container << std::setw(10) << r.n
+                  << std::setw(9) << r.threads << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << r.ns << std::setw(10) << r.hit_rate * 100 << std::endl;
+        if (json.is_open())
+            json << "{\"op\":\"" << r.op << "\",\"container\":\"" << r.container << "\",\"n\":" << r.n
+                 << ",\"threads\":" << r.threads << ",\"ns\":" << r.ns << ",\"hit_rate\":" << r.hit_rate << "}\n";
+    }
+    return 0;
+}
+
+} // namespace zephyr::bench
+
+} // namespace zephyr
+
+int main(int argc, char** argv) {
+    return zephyr::bench::main(argc, argv);
+}
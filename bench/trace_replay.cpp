@@ -0,0 +1,398 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+// 离线重放 alloc_trace 记录的分配事件，比较各个分配器在真实流量下的耗时、峰值 RSS 与碎片
+//
+// 事件先整理成每个线程一段程序：地址换成槽位编号，释放使用对应分配的大小；
+// 记录开始之前分配、或者分配事件已被环覆盖的释放没有对应的分配，直接跳过
+// 默认每个记录到的线程各用一个线程重放，释放别的线程分配的块时等待那次分配完成；--serial 时在一个线程上按序号重放
+// 每个块每 4 KiB 写一个字节，RSS 才能反映块真正占用的页
+//
+// 碎片按 1 - 存活字节数 / RSS 增量计算：峰值时比较 VmHWM 的增量与请求字节数的峰值，结束时比较 VmRSS 的增量与剩余的请求字节数
+// 请求字节数的峰值按记录时的顺序算出，多线程重放时各线程的交错与记录时不同，峰值碎片只是近似
+//
+// 用法：zephyr_trace_replay 文件 [--allocators pool,loki,global,malloc] [--source pool|fixed|global]
+//                            [--serial] [--classes] [--json 文件]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+#include "../src/include/memory/alloc_trace.h"
+
+namespace zephyr
+{
+
+namespace bench
+{
+
+// ---------------------------------------------------------------------------
+// 整理
+// ---------------------------------------------------------------------------
+
+struct step {
+    uint32_t slot;
+    uint32_t size;
+    trace_op op;
+    bool shared;        // 分配：由别的线程释放，完成后要发布；释放：要等别的线程的分配完成
+};
+
+struct program {
+    std::vector<std::vector<step>> threads;
+    std::vector<uint32_t> slot_sizes;
+    std::vector<uint32_t> leftover;     // 重放结束时仍然存活的槽位，在计时之外释放
+    uint64_t ops = 0;
+    uint64_t unmatched_frees = 0;       // 找不到对应分配的释放
+    uint64_t lost_frees = 0;            // 地址被再次分配前没有看到释放，视为泄漏
+    uint64_t peak_live_bytes = 0;
+    uint64_t end_live_bytes = 0;
+};
+
+// source 为 nullptr 时接受所有来源
+program build(const std::vector<trace_event>& events, const trace_source* source, bool serial) {
+    struct live_block {
+        uint32_t slot;
+        uint32_t size;
+        size_t thread;
+        size_t index;       // 分配在该线程程序中的位置
+    };
+    program prog;
+    std::unordered_map<uint64_t, live_block> live;
+    std::unordered_map<uint16_t, size_t> thread_index;
+    uint64_t live_bytes = 0;
+    for (const trace_event& e : events) {
+        if (source != nullptr && e.source != *source)
+            continue;
+        size_t t = 0;
+        if (!serial) {
+            auto it = thread_index.find(e.thread);
+            if (it == thread_index.end()) {
+                it = thread_index.emplace(e.thread, prog.threads.size()).first;
+                prog.threads.emplace_back();
+            }
+            t = it->second;
+        }
+        else if (prog.threads.empty())
+            prog.threads.emplace_back();
+        std::vector<step>& code = prog.threads[t];
+
+        if (e.op == trace_op::allocate) {
+            auto it = live.find(e.address);
+            if (it != live.end()) {
+                ++prog.lost_frees;
+                prog.leftover.push_back(it->second.slot);
+                live.erase(it);
+            }
+            uint32_t slot = static_cast<uint32_t>(prog.slot_sizes.size());
+            prog.slot_sizes.push_back(e.size);
+            live[e.address] = live_block { slot, e.size, t, code.size() };
+            code.push_back(step { slot, e.size, trace_op::allocate, false });
+            live_bytes += e.size;
+            if (live_bytes > prog.peak_live_bytes)
+                prog.peak_live_bytes = live_bytes;
+        }
+        else {
+            auto it = live.find(e.address);
+            if (it == live.end()) {
+                ++prog.unmatched_frees;
+                continue;
+            }
+            const live_block& b = it->second;
+            bool cross = b.thread != t;
+            if (cross)
+                prog.threads[b.thread][b.index].shared = true;
+            code.push_back(step { b.slot, b.size, trace_op::deallocate, cross });
+            live_bytes -= b.size;
+            live.erase(it);
+        }
+        ++prog.ops;
+    }
+    for (const auto& kv : live)
+        prog.leftover.push_back(kv.second.slot);
+    prog.end_live_bytes = live_bytes;
+    return prog;
+}
+
+// ---------------------------------------------------------------------------
+// 重放
+// ---------------------------------------------------------------------------
+
+struct replay_result {
+    char allocator[16];
+    int threads;
+    uint64_t ops;
+    double seconds;
+    long rss_base_kb;
+    long rss_peak_kb;
+    long rss_end_kb;
+};
+
+inline void touch(void* p, size_t n) {
+    char* c = static_cast<char*>(p);
+    for (size_t off = 0; off < n; off += 4096)
+        c[off] = 1;
+}
+
+template <typename A>
+void replay(const program& prog, replay_result& r) {
+    typedef std::chrono::steady_clock clock_type;
+    const size_t slots = prog.slot_sizes.size();
+    std::vector<void*> ptrs(slots, nullptr);
+    std::unique_ptr<std::atomic<uint8_t>[]> ready(new std::atomic<uint8_t>[slots]());
+
+    reset_peak_rss();
+    r.rss_base_kb = proc_status_kb("VmRSS");
+
+    std::atomic<size_t> waiting(prog.threads.size());
+    std::atomic<bool> go(false);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < prog.threads.size(); ++t) {
+        pool.emplace_back([&, t]() {
+            waiting.fetch_sub(1);
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (const step& s : prog.threads[t]) {
+                if (s.op == trace_op::allocate) {
+                    void* p = A::allocate(s.size);
+                    touch(p, s.size);
+                    ptrs[s.slot] = p;
+                    if (s.shared)
+                        ready[s.slot].store(1, std::memory_order_release);
+                }
+                else {
+                    if (s.shared)
+                        while (ready[s.slot].load(std::memory_order_acquire) == 0)
+                            std::this_thread::yield();
+                    A::deallocate(ptrs[s.slot], s.size);
+                }
+            }
+        });
+    }
+    while (waiting.load() != 0)
+        std::this_thread::yield();
+    clock_type::time_point start = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& th : pool)
+        th.join();
+    r.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+    r.ops = prog.ops;
+    r.rss_peak_kb = proc_status_kb("VmHWM");
+    r.rss_end_kb = proc_status_kb("VmRSS");
+
+    for (uint32_t slot : prog.leftover)
+        if (ptrs[slot] != nullptr)
+            A::deallocate(ptrs[slot], prog.slot_sizes[slot]);
+}
+
+template <typename A>
+bool measure(const program& prog, replay_result& r) {
+    r = replay_result();
+    snprintf(r.allocator, sizeof(r.allocator), "%s", A::name());
+    r.threads = static_cast<int>(prog.threads.size());
+    return run_in_child(r, [&prog](replay_result& out) { replay<A>(prog, out); });
+}
+
+// ---------------------------------------------------------------------------
+// 报告
+// ---------------------------------------------------------------------------
+
+// 1 - live / rss，rss 不大于 live 时为 0
+double fragmentation(uint64_t live_bytes, long rss_kb) {
+    double rss = static_cast<double>(rss_kb) * 1024;
+    return rss > static_cast<double>(live_bytes) ? 1.0 - static_cast<double>(live_bytes) / rss : 0.0;
+}
+
+void print_summary(const std::vector<trace_event>& events, uint64_t dropped, const program& prog) {
+    std::cout << "events " << events.size() << ", overwritten " << dropped
+              << ", replayed " << prog.ops << ", threads " << prog.threads.size()
+              << ", unmatched frees " << prog.unmatched_frees << ", lost frees " << prog.lost_frees << std::endl;
+    std::cout << "peak live " << prog.peak_live_bytes / 1024 << " KB, live at end "
+              << prog.end_live_bytes / 1024 << " KB" << std::endl;
+}
+
+// pool_allocator 各尺寸分级的请求数与取整浪费，用来调整分级
+void print_classes(const program& prog) {
+    uint64_t count[Z_free_list_size] = {};
+    uint64_t requested[Z_free_list_size] = {};
+    uint64_t large = 0;
+    for (const std::vector<step>& code : prog.threads) {
+        for (const step& s : code) {
+            if (s.op != trace_op::allocate)
+                continue;
+            if (s.size > static_cast<size_t>(Z_max_bytes)) {
+                ++large;
+                continue;
+            }
+            size_t index = pool_allocator::Z_class_index(s.size);
+            ++count[index];
+            requested[index] += s.size;
+        }
+    }
+    uint64_t total_requested = 0, total_rounded = 0;
+    std::cout << std::setw(8) << "class" << std::setw(12) << "allocs" << std::setw(12) << "avg bytes"
+              << std::setw(10) << "waste" << std::endl;
+    for (size_t i = 0; i < Z_free_list_size; ++i) {
+        if (count[i] == 0)
+            continue;
+        uint64_t rounded = count[i] * pool_allocator::Z_class_size(i);
+        total_requested += requested[i];
+        total_rounded += rounded;
+        std::cout << std::setw(8) << pool_allocator::Z_class_size(i) << std::setw(12) << count[i]
+                  << std::setw(12) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(requested[i]) / count[i]
+                  << std::setw(9) << std::setprecision(1)
+                  << 100.0 * (rounded - requested[i]) / rounded << "%" << std::endl;
+    }
+    if (total_rounded > 0)
+        std::cout << "rounding waste " << std::setprecision(1)
+                  << 100.0 * (total_rounded - total_requested) / total_rounded << "%, "
+                  << large << " allocations above " << Z_max_bytes << " bytes" << std::endl;
+}
+
+void print_header() {
+    std::cout << std::left << std::setw(8) << "alloc" << std::right << std::setw(5) << "thr"
+              << std::setw(12) << "ops" << std::setw(10) << "ms" << std::setw(9) << "ns/op"
+              << std::setw(14) << "peak RSS KB" << std::setw(11) << "peak frag"
+              << std::setw(13) << "end RSS KB" << std::setw(10) << "end frag" << std::endl;
+}
+
+void print_row(const program& prog, const replay_result& r) {
+    long peak = r.rss_peak_kb - r.rss_base_kb;
+    long end = r.rss_end_kb - r.rss_base_kb;
+    std::cout << std::left << std::setw(8) << r.allocator << std::right << std::setw(5) << r.threads
+              << std::setw(12) << r.ops << std::fixed << std::setprecision(1)
+              << std::setw(10) << r.seconds * 1e3
+              << std::setw(9) << (r.ops > 0 ? r.seconds * 1e9 / r.ops : 0.0)
+              << std::setw(14) << peak
+              << std::setw(10) << 100 * fragmentation(prog.peak_live_bytes, peak) << "%"
+              << std::setw(13) << end
+              << std::setw(9) << 100 * fragmentation(prog.end_live_bytes, end) << "%" << std::endl;
+}
+
+std::string to_json(const program& prog, const replay_result& r) {
+    long peak = r.rss_peak_kb - r.rss_base_kb;
+    long end = r.rss_end_kb - r.rss_base_kb;
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4)
+        << "{\"allocator\":\"" << r.allocator << "\""
+        << ",\"threads\":" << r.threads
+        << ",\"ops\":" << r.ops
+        << ",\"seconds\":" << r.seconds
+        << ",\"ns_per_op\":" << (r.ops > 0 ? r.seconds * 1e9 / r.ops : 0.0)
+        << ",\"rss_peak_kb\":" << peak
+        << ",\"rss_end_kb\":" << end
+        << ",\"live_peak_kb\":" << prog.peak_live_bytes / 1024
+        << ",\"live_end_kb\":" << prog.end_live_bytes / 1024
+        << ",\"fragmentation_peak\":" << fragmentation(prog.peak_live_bytes, peak)
+        << ",\"fragmentation_end\":" << fragmentation(prog.end_live_bytes, end) << "}";
+    return out.str();
+}
+
+int usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " trace [--allocators pool,loki,global,malloc] [--source pool|fixed|global]"
+              << " [--serial] [--classes] [--json file]" << std::endl;
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2)
+        return usage(argv[0]);
+    std::string allocators = "pool,loki,global,malloc";
+    std::string json_path;
+    bool serial = false;
+    bool classes = false;
+    bool filtered = false;
+    trace_source source = trace_source::pool;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--serial")
+            serial = true;
+        else if (flag == "--classes")
+            classes = true;
+        else if (flag == "--allocators" && i + 1 < argc)
+            allocators = argv[++i];
+        else if (flag == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else if (flag == "--source" && i + 1 < argc) {
+            std::string s = argv[++i];
+            filtered = true;
+            if (s == "pool")
+                source = trace_source::pool;
+            else if (s == "fixed")
+                source = trace_source::fixed;
+            else if (s == "global")
+                source = trace_source::global;
+            else
+                return usage(argv[0]);
+        }
+        else
+            return usage(argv[0]);
+    }
+
+    std::vector<trace_event> events;
+    uint64_t dropped = 0;
+    if (!alloc_trace::read(argv[1], events, &dropped)) {
+        std::cerr << argv[1] << ": not a zephyr allocation trace" << std::endl;
+        return 1;
+    }
+    program prog = build(events, filtered ? &source : nullptr, serial);
+    print_summary(events, dropped, prog);
+    if (classes)
+        print_classes(prog);
+
+    std::ofstream json;
+    if (!json_path.empty())
+        json.open(json_path.c_str());
+
+    print_header();
+    int failures = 0;
+    std::stringstream list(allocators);
+    std::string name;
+    while (std::getline(list, name, ',')) {
+        replay_result r;
+        bool ok = false;
+        if (name == "pool")
+            ok = measure<pool_backend>(prog, r);
+        else if (name == "loki")
+            ok = measure<loki_backend>(prog, r);
+        else if (name == "global")
+            ok = measure<global_backend>(prog, r);
+        else if (name == "malloc")
+            ok = measure<malloc_backend>(prog, r);
+        else {
+            std::cerr << "unknown allocator " << name << std::endl;
+            ++failures;
+            continue;
+        }
+        if (!ok) {
+            std::cerr << name << ": replay failed" << std::endl;
+            ++failures;
+            continue;
+        }
+        print_row(prog, r);
+        if (json.is_open())
+            json << to_json(prog, r) << '\n';
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace zephyr::bench
+
+} // namespace zephyr
+
+int main(int argc, char** argv) {
+    return zephyr::bench::main(argc, argv);
+}
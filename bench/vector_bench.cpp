@@ -0,0 +1,202 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+// zephyr::vector、small_vector 与 std::vector 的对比
+//
+// 容器：std::vector（std::allocator）、std::vector + zephyr::allocator、zephyr::vector、zephyr::small_vector<T, 16>
+// 元素：int、std::string（短串）、持有 unique_ptr 的句柄（特化为可平凡重定位）
+// 操作：
+//   push_back  从空容器逐个追加到 n 个元素，每元素纳秒数（包括容器的析构）
+//   insert     在 n 个元素的容器中随机位置逐个插入 64 个元素，每次插入的纳秒数
+//   erase      再从随机位置逐个删除 64 个元素，每次删除的纳秒数
+// 用法：zephyr_vector_bench [--n 16,256,4096,65536] [--json 文件]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <stdlib.h>
+
+#include "../src/include/container/vector.h"
+
+namespace zephyr
+{
+
+namespace bench
+{
+
+struct handle {
+    std::unique_ptr<int> p;
+    explicit handle(int v) : p(new int(v)) {}
+};
+
+} // namespace zephyr::bench
+
+template <>
+struct is_trivially_relocatable<bench::handle> : std::true_type {};
+
+namespace bench
+{
+
+typedef std::chrono::steady_clock clock_type;
+
+inline int make(int i, int*) { return i; }
+inline std::string make(int i, std::string*) { return std::string(8, char('a' + i % 26)); }
+inline handle make(int i, handle*) { return handle(i); }
+
+template <typename T> const char* type_name();
+template <> const char* type_name<int>() { return "int"; }
+template <> const char* type_name<std::string>() { return "string"; }
+template <> const char* type_name<handle>() { return "handle"; }
+
+struct result {
+    std::string op;
+    std::string type;
+    std::string container;
+    size_t n;
+    double ns;
+};
+
+enum { Z_edits = 64 };
+
+// 5 轮中最快一轮的平均值；work 为每次 body 大致搬动的元素数，决定每轮重复的次数
+template <typename Body>
+double best_of(size_t ops, size_t work, Body body) {
+    size_t reps = std::max<size_t>(3, (size_t(1) << 21) / work);
+    double best = 1e30;
+    for (int round = 0; round < 5; round++) {
+        double ns = 0;
+        for (size_t r = 0; r < reps; r++)
+            ns += body();
+        best = std::min(best, ns / static_cast<double>(reps * ops));
+    }
+    return best;
+}
+
+template <typename Vec>
+void run(const char* name, size_t n, std::vector<result>& out) {
+    typedef typename Vec::value_type T;
+    std::mt19937 rng(42);
+    std::vector<size_t> at(Z_edits);
+    for (size_t i = 0; i < at.size(); i++)
+        at[i] = rng() % (n + i + 1);
+
+    double push = best_of(n, n, [&] {
+        clock_type::time_point t0 = clock_type::now();
+        {
+            Vec v;
+            for (size_t i = 0; i < n; i++)
+                v.push_back(make(static_cast<int>(i), static_cast<T*>(nullptr)));
+        }
+        return std::chrono::duration<double, std::nano>(clock_type::now() - t0).count();
+    });
+
+    Vec v;
+    for (size_t i = 0; i < n; i++)
+        v.push_back(make(static_cast<int>(i), static_cast<T*>(nullptr)));
+    // 插入与删除成对执行，容器大小保持在 n 附近；分别计时
+    double insert = best_of(Z_edits, Z_edits * n, [&] {
+        clock_type::time_point t0 = clock_type::now();
+        for (size_t i = 0; i < at.size(); i++)
+            v.insert(v.begin() + at[i], make(static_cast<int>(i), static_cast<T*>(nullptr)));
+        double ns = std::chrono::duration<double, std::nano>(clock_type::now() - t0).count();
+        for (size_t i = at.size(); i-- > 0; )
+            v.erase(v.begin() + at[i]);
+        return ns;
+    });
+    double erase = best_of(Z_edits, Z_edits * n, [&] {
+        for (size_t i = 0; i < at.size(); i++)
+            v.insert(v.begin() + at[i], make(static_cast<int>(i), static_cast<T*>(nullptr)));
+        clock_type::time_point t0 = clock_type::now();
+        for (size_t i = at.size(); i-- > 0; )
+            v.erase(v.begin() + at[i]);
+        return std::chrono::duration<double, std::nano>(clock_type::now() - t0).count();
+    });
+
+    out.push_back({"push_back", type_name<T>(), name, n, push});
+    out.push_back({"insert", type_name<T>(), name, n, insert});
+    out.push_back({"erase", type_name<T>(), name, n, erase});
+}
+
+template <typename T>
+void run_all(size_t n, std::vector<result>& out) {
+    run<std::vector<T>>("std", n, out);
+    run<std::vector<T, allocator<T>>>("std+pool", n, out);
+    run<zephyr::vector<T>>("zephyr", n, out);
+    run<zephyr::small_vector<T, 16>>("small16", n, out);
+}
+
+std::vector<size_t> parse_list(const char* s) {
+    std::vector<size_t> v;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            v.push_back(strtoull(item.c_str(), nullptr, 10));
+    return v;
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {16, 256, 4096, 65536};
+    std::string json_path;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--n" && i + 1 < argc)
+            sizes = parse_list(argv[++i]);
+        else if (flag == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--n 16,256,4096,65536] [--json file]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<result> results;
+    for (size_t n : sizes) {
+        if (n == 0)
+            continue;
+        run_all<int>(n, results);
+        run_all<std::string>(n, results);
+        run_all<handle>(n, results);
+    }
+
+    // 每行一个 (操作, 类型, n)，四列依次是四种容器的纳秒数
+    std::ofstream json;
+    if (!json_path.empty())
+        json.open(json_path.c_str());
+    const char* names[] = {"std", "std+pool", "zephyr", "small16"};
+    std::cout << std::left << std::setw(11) << "op" << std::setw(8) << "type" << std::setw(8) << "n" << std::right;
+    for (const char* name : names)
+        std::cout << std::setw(12) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i + 12 <= results.size(); i += 12) {
+        for (size_t op = 0; op < 3; op++) {
+            const result& r = results[i + op];
+            std::cout << std::left << std::setw(11) << r.op << std::setw(8) << r.type << std::setw(8) << r.n
+                      << std::right << std::fixed << std::setprecision(2);
+            for (size_t c = 0; c < 4; c++)
+                std::cout << std::setw(12) << results[i + c * 3 + op].ns;
+            std::cout << std::endl;
+        }
+    }
+    if (json.is_open())
+        for (const result& r : results)
+            json << "{\"op\":\"" << r.op << "\",\"type\":\"" << r.type << "\",\"container\":\"" << r.container
+                 << "\",\"n\":" << r.n << ",\"ns\":" << r.ns << "}\n";
+    return 0;
+}
+
+} // namespace zephyr::bench
+
+} // namespace zephyr
+
+int main(int argc, char** argv) {
+    return zephyr::bench::main(argc, argv);
+}
@@ -0,0 +1,659 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#ifndef ZEPHYR_HASH_MAP_H
+#define ZEPHYR_HASH_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "../math/internal_bit.hpp"
+#include "../memory/allocator.h"
+#include "../memory/loki_allocator.h"
+#include "../memory/construct.h"
+
+// 这个头文件包含开放寻址的哈希表 flat_hash_map<K, V> 与节点稳定的 node_hash_map<K, V>
+//
+// 布局与 Swiss table 相同：每个槽位对应一个控制字节，空为 ctrl_empty，删除为 ctrl_deleted，
+// 有元素时为哈希值的低 7 位（h2）；其余高位（h1）决定探测的起点
+// 查找时一次读入 16 个控制字节（一组），SSE2 一条比较得到与 h2 相等的槽位掩码，bsf 取第一个候选再比较键；
+// 组中有空槽位说明键不存在，否则按三角数跳到下一组。绝大多数查找只读一组控制字节、比较一次键
+//
+// 容量是 2 的幂（ceil_pow2），至少 16；控制字节末尾多出 16 个，复制开头的 16 个，
+// 从任何位置起读一组都不越界，也不需要回绕。元素个数达到容量的 7/8 时扩容
+// 删除时所在位置前后 16 个槽位内有空槽位，说明没有探测序列越过这里，直接置空；否则留下 ctrl_deleted
+//
+// flat_hash_map 的元素直接放在槽位数组中：没有每个元素一次的分配，查找没有指针跳转，
+// 但扩容会搬动元素（可以平凡重定位时 memcpy），之前的引用和迭代器失效
+// node_hash_map 的槽位只保存指针，元素从 loki_alloc 分配，扩容只搬指针，元素的地址在删除之前一直不变
+// 槽位数组与控制字节从 Alloc（默认 zephyr::allocator）分配
+//
+// 插入、扩容之后迭代器失效；删除只使指向被删除元素的迭代器失效
+
+namespace zephyr
+{
+
+namespace hash_detail
+{
+
+enum : int8_t {
+    ctrl_empty = -128,      // 0b10000000
+    ctrl_deleted = -2,      // 0b11111110
+    ctrl_sentinel = -1      // 比较用：小于它的是空或删除
+};
+
+enum { group_width = 16 };
+
+// 16 个控制字节，match 系列返回 16 位的掩码，第 i 位对应组中第 i 个槽位
+struct group {
+#ifdef __SSE2__
+    explicit group(const int8_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    uint32_t match(int8_t h2) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+    }
+
+    uint32_t match_empty() const { return match(ctrl_empty); }
+
+    uint32_t match_empty_or_deleted() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl)));
+    }
+
+    __m128i ctrl;
+#else
+    explicit group(const int8_t* p) { memcpy(ctrl, p, group_width); }
+
+    uint32_t match(int8_t h2) const {
+        uint32_t mask = 0;
+        for (int i = 0; i < group_width; ++i)
+            mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+        return mask;
+    }
+
+    uint32_t match_empty() const { return match(ctrl_empty); }
+
+    uint32_t match_empty_or_deleted() const {
+        uint32_t mask = 0;
+        for (int i = 0; i < group_width; ++i)
+            mask |= static_cast<uint32_t>(ctrl[i] < ctrl_sentinel) << i;
+        return mask;
+    }
+
+    int8_t ctrl[group_width];
+#endif
+};
+
+// std::hash 对整数是恒等映射，乘一个奇数再把高半折叠下来，低 7 位与高位都依赖所有输入位
+inline size_t mix(size_t h) {
+    uint64_t m = static_cast<uint64_t>(h) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(m ^ (m >> 32));
+}
+
+inline size_t h1(size_t hash) { return hash >> 7; }
+inline int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+// 元素直接放在槽位中
+template <typename K, typename V>
+struct flat_policy {
+    typedef K                       key_type;
+    typedef V                       mapped_type;
+    typedef std::pair<const K, V>   value_type;
+    typedef value_type              slot_type;
+
+    // 搬到新槽位不会抛出：可以平凡重定位（memcpy），或者移动构造不抛出
+    typedef std::integral_constant<bool, is_trivially_relocatable<value_type>::value
+                                         || std::is_nothrow_move_constructible<value_type>::value
+                                         || !std::is_copy_constructible<value_type>::value> nothrow_transfer;
+
+    static value_type& element(slot_type* slot) { return *slot; }
+
+    template <typename ...Args>
+    static void construct(slot_type* slot, Args&& ...args) {
+        ::new (static_cast<void*>(slot)) value_type(std::forward<Args>(args)...);
+    }
+
+    static void destroy(slot_type* slot) { zephyr::destroy(slot); }
+
+    static void transfer(slot_type* dst, slot_type* src) { zephyr::relocate(src, src + 1, dst); }
+};
+
+// 槽位只保存指针，元素从 loki_alloc 分配
+template <typename K, typename V>
+struct node_policy {
+    typedef K                       key_type;
+    typedef V                       mapped_type;
+    typedef std::pair<const K, V>   value_type;
+    typedef value_type*             slot_type;
+    typedef std::true_type          nothrow_transfer;
+
+    static value_type& element(slot_type* slot) { return **slot; }
+
+    template <typename ...Args>
+    static void construct(slot_type* slot, Args&& ...args) {
+        value_type* p = loki_alloc<value_type>::allocate();
+        try {
+            ::new (static_cast<void*>(p)) value_type(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            loki_alloc<value_type>::deallocate(p);
+            throw;
+        }
+        *slot = p;
+    }
+
+    static void destroy(slot_type* slot) {
+        zephyr::destroy(*slot);
+        loki_alloc<value_type>::deallocate(*slot);
+    }
+
+    static void transfer(slot_type* dst, slot_type* src) { *dst = *src; }
+};
+
+} // namespace zephyr::hash_detail
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+class hash_table {
+
+    typedef typename Policy::slot_type slot_type;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<int8_t> ctrl_allocator;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<slot_type> slot_allocator;
+
+public:
+    typedef typename Policy::key_type       key_type;
+    typedef typename Policy::mapped_type    mapped_type;
+    typedef typename Policy::value_type     value_type;
+    typedef size_t                          size_type;
+    typedef ptrdiff_t                       difference_type;
+    typedef Hash                            hasher;
+    typedef KeyEqual                        key_equal;
+    typedef Alloc                           allocator_type;
+    typedef value_type&                     reference;
+    typedef const value_type&               const_reference;
+
+    template <bool Const>
+    class iterator_base {
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename hash_table::value_type value_type;
+        typedef ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const value_type*, value_type*>::type pointer;
+        typedef typename std::conditional<Const, const value_type&, value_type&>::type reference;
+
+        iterator_base() noexcept : ctrl_(nullptr), slot_(nullptr), end_(nullptr) {}
+
+        // iterator 可以转换为 const_iterator
+        template <bool C, typename = typename std::enable_if<Const && !C>::type>
+        iterator_base(const iterator_base<C>& other) noexcept
+            : ctrl_(other.ctrl_), slot_(other.slot_), end_(other.end_) {}
+
+        reference operator*() const { return Policy::element(slot_); }
+        pointer operator->() const { return &Policy::element(slot_); }
+
+        iterator_base& operator++() {
+            ++ctrl_;
+            ++slot_;
+            skip_empty();
+            return *this;
+        }
+
+        iterator_base operator++(int) {
+            iterator_base it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const iterator_base& lhs, const iterator_base& rhs) { return lhs.ctrl_ == rhs.ctrl_; }
+        friend bool operator!=(const iterator_base& lhs, const iterator_base& rhs) { return lhs.ctrl_ != rhs.ctrl_; }
+
+    private:
+        friend class hash_table;
+        template <bool> friend class iterator_base;
+
+        iterator_base(const int8_t* ctrl, slot_type* slot, const int8_t* end) noexcept
+            : ctrl_(ctrl), slot_(slot), end_(end) {}
+
+        void skip_empty() {
+            while (ctrl_ != end_ && *ctrl_ < 0) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+        const int8_t* ctrl_;
+        slot_type* slot_;
+        const int8_t* end_;
+    };
+
+    typedef iterator_base<false> iterator;
+    typedef iterator_base<true>  const_iterator;
+
+public:
+    hash_table() : hash_table(0) {}
+
+    explicit hash_table(size_type bucket_count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual(),
+                        const Alloc& alloc = Alloc())
+        : ctrl_(nullptr), slots_(nullptr), size_(0), capacity_(0), growth_left_(0),
+          hash_(hash), equal_(equal), alloc_(alloc) {
+        if (bucket_count != 0)
+            reserve(bucket_count);
+    }
+
+    explicit hash_table(const Alloc& alloc) : hash_table(0, Hash(), KeyEqual(), alloc) {}
+
+    template <typename InputIter>
+    hash_table(InputIter first, InputIter last, size_type bucket_count = 0, const Hash& hash = Hash(),
+               const KeyEqual& equal = KeyEqual(), const Alloc& alloc = Alloc())
+        : hash_table(bucket_count, hash, equal, alloc) {
+        insert(first, last);
+    }
+
+    hash_table(std::initializer_list<value_type> list, size_type bucket_count = 0, const Hash& hash = Hash(),
+               const KeyEqual& equal = KeyEqual(), const Alloc& alloc = Alloc())
+        : hash_table(list.begin(), list.end(), bucket_count, hash, equal, alloc) {}
+
+    hash_table(const hash_table& other)
+        : hash_table(other.size_, other.hash_, other.equal_,
+                     std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_)) {
+        for (const value_type& v : other)
+            emplace_new(v.first, v);
+    }
+
+    hash_table(hash_table&& other) noexcept
+        : ctrl_(other.ctrl_), slots_(other.slots_), size_(other.size_), capacity_(other.capacity_),
+          growth_left_(other.growth_left_), hash_(std::move(other.hash_)), equal_(std::move(other.equal_)),
+          alloc_(std::move(other.alloc_)) {
+        other.reset();
+    }
+
+    ~hash_table() {
+        destroy_slots();
+        deallocate_arrays(ctrl_, slots_, capacity_);
+    }
+
+    hash_table& operator=(const hash_table& other) {
+        if (this != &other) {
+            hash_table tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    hash_table& operator=(hash_table&& other) noexcept {
+        if (this != &other) {
+            destroy_slots();
+            deallocate_arrays(ctrl_, slots_, capacity_);
+            ctrl_ = other.ctrl_;
+            slots_ = other.slots_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            growth_left_ = other.growth_left_;
+            hash_ = std::move(other.hash_);
+            equal_ = std::move(other.equal_);
+            alloc_ = std::move(other.alloc_);
+            other.reset();
+        }
+        return *this;
+    }
+
+    iterator begin() noexcept {
+        iterator it(ctrl_, slots_, ctrl_ + capacity_);
+        it.skip_empty();
+        return it;
+    }
+
+    const_iterator begin() const noexcept { return const_cast<hash_table*>(this)->begin(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator end() noexcept { return iterator(ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_); }
+    const_iterator end() const noexcept { return const_cast<hash_table*>(this)->end(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+    size_type bucket_count() const noexcept { return capacity_; }
+    size_type max_size() const noexcept { return std::allocator_traits<slot_allocator>::max_size(slot_allocator(alloc_)) / 2; }
+    float load_factor() const noexcept { return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / capacity_; }
+    float max_load_factor() const noexcept { return 0.875f; }
+
+    hasher hash_function() const { return hash_; }
+    key_equal key_eq() const { return equal_; }
+    allocator_type get_allocator() const { return alloc_; }
+
+    // 析构所有元素，保留容量
+    void clear() noexcept {
+        destroy_slots();
+        if (capacity_ != 0) {
+            memset(ctrl_, hash_detail::ctrl_empty, capacity_ + hash_detail::group_width);
+            growth_left_ = max_load(capacity_);
+        }
+        size_ = 0;
+    }
+
+    // 保证插入到 n 个元素之前不再扩容
+    void reserve(size_type n) {
+        if (n > max_load(capacity_)) {
+            if (n > max_size())
+                throw std::length_error("zephyr::hash_table::reserve");
+            size_type cap = size_type(1) << ceil_pow2_constexpr(n + n / 7);
+            while (max_load(cap) < n)
+                cap <<= 1;
+            resize(cap < hash_detail::group_width ? hash_detail::group_width : cap);
+        }
+    }
+
+    // 查找
+    iterator find(const key_type& key) {
+        if (size_ == 0)
+            return end();
+        size_type i = find_index(key, hash_detail::mix(hash_(key)));
+        return i == npos ? end() : iterator_at(i);
+    }
+
+    const_iterator find(const key_type& key) const { return const_cast<hash_table*>(this)->find(key); }
+
+    bool contains(const key_type& key) const { return find(key) != end(); }
+    size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    mapped_type& at(const key_type& key) {
+        iterator it = find(key);
+        if (it == end())
+            throw std::out_of_range("zephyr::hash_table::at");
+        return it->second;
+    }
+
+    const mapped_type& at(const key_type& key) const { return const_cast<hash_table*>(this)->at(key); }
+
+    mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+    mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // 插入
+    std::pair<iterator, bool> insert(const value_type& value) { return emplace_new(value.first, value); }
+    std::pair<iterator, bool> insert(value_type&& value) { return emplace_new(value.first, std::move(value)); }
+
+    template <typename InputIter>
+    void insert(InputIter first, InputIter last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    void insert(std::initializer_list<value_type> list) { insert(list.begin(), list.end()); }
+
+    // 先构造出元素才知道键；键已经存在时这个元素被丢弃
+    template <typename ...Args>
+    std::pair<iterator, bool> emplace(Args&& ...args) {
+        value_type value(std::forward<Args>(args)...);
+        return emplace_new(value.first, std::move(value));
+    }
+
+    // 键不存在时才构造 mapped_type
+    template <typename ...Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&& ...args) {
+        return emplace_new(key, std::piecewise_construct, std::forward_as_tuple(key),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template <typename ...Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&& ...args) {
+        return emplace_new(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) {
+        std::pair<iterator, bool> r = try_emplace(key, std::forward<M>(value));
+        if (!r.second)
+            r.first->second = std::forward<M>(value);
+        return r;
+    }
+
+    // 删除
+    iterator erase(const_iterator pos) {
+        size_type i = static_cast<size_type>(pos.ctrl_ - ctrl_);
+        erase_at(i);
+        iterator it = iterator_at(i);
+        it.skip_empty();
+        return it;
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    size_type erase(const key_type& key) {
+        if (size_ == 0)
+            return 0;
+        size_type i = find_index(key, hash_detail::mix(hash_(key)));
+        if (i == npos)
+            return 0;
+        erase_at(i);
+        return 1;
+    }
+
+    void swap(hash_table& other) noexcept {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(hash_, other.hash_);
+        std::swap(equal_, other.equal_);
+        std::swap(alloc_, other.alloc_);
+    }
+
+private:
+    static constexpr size_type npos = ~size_type(0);
+
+    static size_type max_load(size_type cap) { return cap - cap / 8; }
+
+    iterator iterator_at(size_type i) { return iterator(ctrl_ + i, slots_ + i, ctrl_ + capacity_); }
+
+    const key_type& key_at(slot_type* slots, size_type i) const { return Policy::element(slots + i).first; }
+
+    void reset() noexcept {
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        size_ = capacity_ = growth_left_ = 0;
+    }
+
+    // 写入控制字节；开头 16 个同时写到末尾的副本
+    static void set_ctrl(int8_t* ctrl, size_type cap, size_type i, int8_t h) {
+        ctrl[i] = h;
+        if (i < static_cast<size_type>(hash_detail::group_width))
+            ctrl[cap + i] = h;
+    }
+
+    // 键所在的槽位，没有时返回 npos
+    size_type find_index(const key_type& key, size_type hash) const {
+        const size_type mask = capacity_ - 1;
+        const int8_t h2 = hash_detail::h2(hash);
+        size_type pos = hash_detail::h1(hash) & mask;
+        for (size_type step = hash_detail::group_width; ; step += hash_detail::group_width) {
+            hash_detail::group g(ctrl_ + pos);
+            for (uint32_t m = g.match(h2); m != 0; m &= m - 1) {
+                size_type i = (pos + bsf(m)) & mask;
+                if (equal_(key_at(slots_, i), key))
+                    return i;
+            }
+            if (g.match_empty() != 0)
+                return npos;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // 探测序列上第一个空或已删除的槽位；表中总有空槽位，一定能找到
+    static size_type find_first_non_full(const int8_t* ctrl, size_type cap, size_type hash) {
+        const size_type mask = cap - 1;
+        size_type pos = hash_detail::h1(hash) & mask;
+        for (size_type step = hash_detail::group_width; ; step += hash_detail::group_width) {
+            uint32_t m = hash_detail::group(ctrl + pos).match_empty_or_deleted();
+            if (m != 0)
+                return (pos + bsf(m)) & mask;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // 键不存在时在探测序列上找到位置并用 args 构造元素；构造抛出时表不变
+    template <typename ...Args>
+    std::pair<iterator, bool> emplace_new(const key_type& key, Args&& ...args) {
+        size_type hash = hash_detail::mix(hash_(key));
+        if (size_ != 0) {
+            size_type i = find_index(key, hash);
+            if (i != npos)
+                return std::make_pair(iterator_at(i), false);
+        }
+        size_type i = capacity_ == 0 ? npos : find_first_non_full(ctrl_, capacity_, hash);
+        // 复用已删除的槽位不占用新的余量
+        if (i == npos || (growth_left_ == 0 && ctrl_[i] != hash_detail::ctrl_deleted)) {
+            grow();
+            i = find_first_non_full(ctrl_, capacity_, hash);
+        }
+        Policy::construct(slots_ + i, std::forward<Args>(args)...);
+        growth_left_ -= ctrl_[i] == hash_detail::ctrl_empty;
+        set_ctrl(ctrl_, capacity_, i, hash_detail::h2(hash));
+        ++size_;
+        return std::make_pair(iterator_at(i), true);
+    }
+
+    // 余量用完：删除留下的槽位占了一半以上时按原容量重建，否则容量翻倍
+    void grow() {
+        if (capacity_ == 0)
+            resize(hash_detail::group_width);
+        else if (size_ * 2 <= max_load(capacity_))
+            resize(capacity_);
+        else
+            resize(capacity_ * 2);
+    }
+
+    void erase_at(size_type i) {
+        Policy::destroy(slots_ + i);
+        --size_;
+        // i 前后相连的非空槽位不满一组：所有覆盖 i 的组都有空槽位，探测不会越过这里
+        const size_type mask = capacity_ - 1;
+        uint32_t empty_after = hash_detail::group(ctrl_ + i).match_empty();
+        uint32_t empty_before = hash_detail::group(ctrl_ + ((i - hash_detail::group_width) & mask)).match_empty();
+        bool never_full = empty_before != 0 && empty_after != 0
+                          && bsf(empty_after) + (15 - bsr(empty_before)) < hash_detail::group_width;
+        set_ctrl(ctrl_, capacity_, i, never_full ? hash_detail::ctrl_empty : hash_detail::ctrl_deleted);
+        growth_left_ += never_full;
+    }
+
+    void allocate_arrays(int8_t*& ctrl, slot_type*& slots, size_type cap) {
+        ctrl_allocator ca(alloc_);
+        slot_allocator sa(alloc_);
+        ctrl = std::allocator_traits<ctrl_allocator>::allocate(ca, cap + hash_detail::group_width);
+        try {
+            slots = std::allocator_traits<slot_allocator>::allocate(sa, cap);
+        }
+        catch (...) {
+            std::allocator_traits<ctrl_allocator>::deallocate(ca, ctrl, cap + hash_detail::group_width);
+            throw;
+        }
+        memset(ctrl, hash_detail::ctrl_empty, cap + hash_detail::group_width);
+    }
+
+    void deallocate_arrays(int8_t* ctrl, slot_type* slots, size_type cap) noexcept {
+        if (cap == 0)
+            return ;
+        ctrl_allocator ca(alloc_);
+        slot_allocator sa(alloc_);
+        std::allocator_traits<slot_allocator>::deallocate(sa, slots, cap);
+        std::allocator_traits<ctrl_allocator>::deallocate(ca, ctrl, cap + hash_detail::group_width);
+    }
+
+    void destroy_slots() noexcept {
+        if (std::is_trivially_destructible<slot_type>::value && std::is_same<slot_type, value_type>::value)
+            return ;
+        for (size_type i = 0; i < capacity_; ++i)
+            if (ctrl_[i] >= 0)
+                Policy::destroy(slots_ + i);
+    }
+
+    // 以容量 cap 重建，同时清掉删除留下的槽位
+    void resize(size_type cap) {
+        int8_t* ctrl;
+        slot_type* slots;
+        allocate_arrays(ctrl, slots, cap);
+        transfer_all(ctrl, slots, cap, typename Policy::nothrow_transfer{});
+        deallocate_arrays(ctrl_, slots_, capacity_);
+        ctrl_ = ctrl;
+        slots_ = slots;
+        capacity_ = cap;
+        growth_left_ = max_load(cap) - size_;
+    }
+
+    void transfer_all(int8_t* ctrl, slot_type* slots, size_type cap, std::true_type) noexcept {
+        for (size_type i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] < 0)
+                continue;
+            size_type hash = hash_detail::mix(hash_(key_at(slots_, i)));
+            size_type j = find_first_non_full(ctrl, cap, hash);
+            set_ctrl(ctrl, cap, j, hash_detail::h2(hash));
+            Policy::transfer(slots + j, slots_ + i);
+        }
+    }
+
+    // 移动可能抛出：先复制到新数组，全部成功以后才析构旧元素，失败时原表不变
+    void transfer_all(int8_t* ctrl, slot_type* slots, size_type cap, std::false_type) {
+        try {
+            for (size_type i = 0; i < capacity_; ++i) {
+                if (ctrl_[i] < 0)
+                    continue;
+                size_type hash = hash_detail::mix(hash_(key_at(slots_, i)));
+                size_type j = find_first_non_full(ctrl, cap, hash);
+                Policy::construct(slots + j, static_cast<const value_type&>(Policy::element(slots_ + i)));
+                set_ctrl(ctrl, cap, j, hash_detail::h2(hash));
+            }
+        }
+        catch (...) {
+            for (size_type j = 0; j < cap; ++j)
+                if (ctrl[j] >= 0)
+                    Policy::destroy(slots + j);
+            deallocate_arrays(ctrl, slots, cap);
+            throw;
+        }
+        destroy_slots();
+    }
+
+    int8_t* ctrl_;
+    slot_type* slots_;
+    size_type size_;
+    size_type capacity_;
+    size_type growth_left_;     // 不扩容还能占用的空槽位数
+    Hash hash_;
+    KeyEqual equal_;
+    Alloc alloc_;
+};
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+constexpr typename hash_table<Policy, Hash, KeyEqual, Alloc>::size_type hash_table<Policy, Hash, KeyEqual, Alloc>::npos;
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+inline void swap(hash_table<Policy, Hash, KeyEqual, Alloc>& lhs, hash_table<Policy, Hash, KeyEqual, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Alloc = allocator<std::pair<const K, V>>>
+using flat_hash_map = hash_table<hash_detail::flat_policy<K, V>, Hash, KeyEqual, Alloc>;
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Alloc = allocator<std::pair<const K, V>>>
+using node_hash_map = hash_table<hash_detail::node_policy<K, V>, Hash, KeyEqual, Alloc>;
+
+}
+
+
+#endif //ZEPHYR_HASH_MAP_H
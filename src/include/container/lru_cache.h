@@ -0,0 +1,374 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#ifndef ZEPHYR_LRU_CACHE_H
+#define ZEPHYR_LRU_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <mutex>
+#include <utility>
+#include <functional>
+
+#include "hash_map.h"
+#include "../math/internal_bit.hpp"
+#include "../memory/pool_allocator.h"
+#include "../util/spin_lock.h"
+
+// 这个头文件包含 LRU 缓存 lru_cache<K, V> 与按键分片加锁的 sharded_lru_cache<K, V>
+//
+// 条目放在 node_hash_map<K, entry> 的节点里：节点从 loki_alloc 分配，扩容时地址不变，
+// 最近使用顺序的双向链表指针直接嵌在 entry 中，每个条目只有一次 loki_alloc 分配，没有单独的链表节点
+// get、put、erase 与淘汰都是 O(1)：一次哈希查找加常数次指针修改
+//
+// 容量按“费用”计：Charge 给每个条目一个费用，总费用超过容量时从最久未使用的一端淘汰
+//   lru_count   每个条目 1，容量就是条目数
+//   lru_bytes   条目节点本身的字节数（键、值对象与链表指针），不含键、值在堆上持有的内存；
+//               值持有堆内存时用 put(key, value, charge) 给出实际的字节数
+// 费用超过整个容量的条目不会留在缓存中
+//
+// lru_cache 不是线程安全的。sharded_lru_cache 按键的哈希分成若干个 lru_cache，各自用一把 spin_lock 保护，
+// 每个分片独占整数条缓存行；容量平均分给各个分片，淘汰只在分片内进行
+// 定义 ZEPHYR_LOKI_SINGLE_THREAD 时 loki_alloc 不是线程安全的，sharded_lru_cache 也只能在一个线程中使用
+
+namespace zephyr
+{
+
+struct lru_count {
+    template <typename K, typename V>
+    size_t operator()(const K&, const V&) const { return 1; }
+};
+
+namespace lru_detail
+{
+
+template <typename K, typename V>
+struct entry {
+    typedef std::pair<const K, entry> node;
+
+    template <typename U>
+    explicit entry(U&& v) : value(std::forward<U>(v)), charge(0), prev(nullptr), next(nullptr) {}
+
+    V value;
+    size_t charge;
+    node* prev;     // 更近使用的一侧
+    node* next;     // 更久未使用的一侧
+};
+
+} // namespace zephyr::lru_detail
+
+struct lru_bytes {
+    template <typename K, typename V>
+    size_t operator()(const K&, const V&) const { return sizeof(typename lru_detail::entry<K, V>::node); }
+};
+
+struct lru_stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Charge = lru_count>
+class lru_cache {
+
+    typedef lru_detail::entry<K, V> entry;
+    typedef node_hash_map<K, entry, Hash, KeyEqual> map_type;
+    typedef typename entry::node node;
+
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+
+    explicit lru_cache(size_t capacity, const Charge& charge = Charge(), const Hash& hash = Hash(),
+                       const KeyEqual& equal = KeyEqual())
+        : map_(0, hash, equal), head_(nullptr), tail_(nullptr), usage_(0), capacity_(capacity),
+          charge_(charge), stats_() {}
+
+    // 链表指针指向节点，复制、移动都需要重建，不提供
+    lru_cache(const lru_cache&) = delete;
+    lru_cache& operator=(const lru_cache&) = delete;
+
+    // 命中时移到最近使用的一端；返回的指针在下一次 put、erase、clear 之前有效
+    V* get(const K& key) {
+        typename map_type::iterator it = map_.find(key);
+        if (it == map_.end()) {
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.hits;
+        node* n = &*it;
+        if (n != head_) {
+            unlink(n);
+            push_front(n);
+        }
+        return &n->second.value;
+    }
+
+    // 不改变使用顺序，也不计入命中统计
+    const V* peek(const K& key) const {
+        typename map_type::const_iterator it = map_.find(key);
+        return it == map_.end() ? nullptr : &it->second.value;
+    }
+
+    bool contains(const K& key) const { return map_.contains(key); }
+
+    // 插入或覆盖，放到最近使用的一端，然后淘汰到总费用不超过容量；条目本身超过容量时不保留，返回 false
+    template <typename U>
+    bool put(const K& key, U&& value) {
+        node* n = assign(key, std::forward<U>(value));
+        return admit(n, charge_(n->first, n->second.value));
+    }
+
+    template <typename U>
+    bool put(const K& key, U&& value, size_t charge) {
+        return admit(assign(key, std::forward<U>(value)), charge);
+    }
+
+    bool erase(const K& key) {
+        typename map_type::iterator it = map_.find(key);
+        if (it == map_.end())
+            return false;
+        remove(&*it);
+        return true;
+    }
+
+    void clear() {
+        map_.clear();
+        head_ = tail_ = nullptr;
+        usage_ = 0;
+    }
+
+    // 缩小容量时立即淘汰
+    void set_capacity(size_t capacity) {
+        capacity_ = capacity;
+        evict();
+    }
+
+    // 从最近使用到最久未使用依次调用 f(key, value)
+    template <typename F>
+    void for_each(F f) const {
+        for (const node* n = head_; n != nullptr; n = n->second.next)
+            f(n->first, n->second.value);
+    }
+
+    size_t size() const noexcept { return map_.size(); }
+    bool empty() const noexcept { return map_.empty(); }
+    size_t usage() const noexcept { return usage_; }
+    size_t capacity() const noexcept { return capacity_; }
+    lru_stats stats() const noexcept { return stats_; }
+
+private:
+    template <typename U>
+    node* assign(const K& key, U&& value) {
+        std::pair<typename map_type::iterator, bool> r = map_.try_emplace(key, std::forward<U>(value));
+        node* n = &*r.first;
+        if (r.second) {
+            push_front(n);
+            return n;
+        }
+        // try_emplace 在键已经存在时不会使用 value
+        n->second.value = std::forward<U>(value);
+        if (n != head_) {
+            unlink(n);
+            push_front(n);
+        }
+        return n;
+    }
+
+    bool admit(node* n, size_t charge) {
+        usage_ = usage_ - n->second.charge + charge;
+        n->second.charge = charge;
+        if (charge > capacity_) {
+            remove(n);
+            return false;
+        }
+        evict();
+        return true;
+    }
+
+    void evict() {
+        while (usage_ > capacity_ && tail_ != nullptr) {
+            remove(tail_);
+            ++stats_.evictions;
+        }
+    }
+
+    void remove(node* n) {
+        unlink(n);
+        usage_ -= n->second.charge;
+        map_.erase(n->first);
+    }
+
+    void unlink(node* n) {
+        entry& e = n->second;
+        if (e.prev != nullptr)
+            e.prev->second.next = e.next;
+        else
+            head_ = e.next;
+        if (e.next != nullptr)
+            e.next->second.prev = e.prev;
+        else
+            tail_ = e.prev;
+        e.prev = e.next = nullptr;
+    }
+
+    void push_front(node* n) {
+        n->second.prev = nullptr;
+        n->second.next = head_;
+        if (head_ != nullptr)
+            head_->second.prev = n;
+        else
+            tail_ = n;
+        head_ = n;
+    }
+
+    map_type map_;
+    node* head_;        // 最近使用
+    node* tail_;        // 最久未使用，下一个被淘汰
+    size_t usage_;
+    size_t capacity_;
+    Charge charge_;
+    lru_stats stats_;
+};
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Charge = lru_count>
+class sharded_lru_cache {
+
+    typedef lru_cache<K, V, Hash, KeyEqual, Charge> cache_type;
+
+    struct alignas(Z_cache_line) shard {
+        shard(size_t capacity, const Charge& charge, const Hash& hash, const KeyEqual& equal)
+            : cache(capacity, charge, hash, equal) {}
+
+        spin_lock lock;
+        cache_type cache;
+    };
+
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+
+    enum { default_shards = 16 };
+
+    // shards 向上取整到 2 的幂，每个分片的容量为 capacity / shards 向上取整
+    explicit sharded_lru_cache(size_t capacity, size_t shards = default_shards, const Charge& charge = Charge(),
+                               const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        : shards_(nullptr), bits_(ceil_pow2_constexpr(shards == 0 ? 1 : shards)), hash_(hash) {
+        size_t n = size_t(1) << bits_;
+        size_t per_shard = (capacity + n - 1) / n;
+        shards_ = static_cast<shard*>(pool_allocator::allocate_padded(n * sizeof(shard)));
+        size_t i = 0;
+        try {
+            for (; i < n; ++i)
+                ::new (static_cast<void*>(shards_ + i)) shard(per_shard, charge, hash, equal);
+        }
+        catch (...) {
+            zephyr::destroy(shards_, shards_ + i);
+            pool_allocator::deallocate_padded(shards_, n * sizeof(shard));
+            throw;
+        }
+    }
+
+    sharded_lru_cache(const sharded_lru_cache&) = delete;
+    sharded_lru_cache& operator=(const sharded_lru_cache&) = delete;
+
+    ~sharded_lru_cache() {
+        zephyr::destroy(shards_, shards_ + shard_count());
+        pool_allocator::deallocate_padded(shards_, shard_count() * sizeof(shard));
+    }
+
+    // 命中时把值复制到 out
+    bool get(const K& key, V& out) {
+        shard& s = shard_of(key);
+        std::lock_guard<spin_lock> guard(s.lock);
+        V* v = s.cache.get(key);
+        if (v == nullptr)
+            return false;
+        out = *v;
+        return true;
+    }
+
+    bool contains(const K& key) {
+        shard& s = shard_of(key);
+        std::lock_guard<spin_lock> guard(s.lock);
+        return s.cache.contains(key);
+    }
+
+    template <typename U>
+    bool put(const K& key, U&& value) {
+        shard& s = shard_of(key);
+        std::lock_guard<spin_lock> guard(s.lock);
+        return s.cache.put(key, std::forward<U>(value));
+    }
+
+    template <typename U>
+    bool put(const K& key, U&& value, size_t charge) {
+        shard& s = shard_of(key);
+        std::lock_guard<spin_lock> guard(s.lock);
+        return s.cache.put(key, std::forward<U>(value), charge);
+    }
+
+    bool erase(const K& key) {
+        shard& s = shard_of(key);
+        std::lock_guard<spin_lock> guard(s.lock);
+        return s.cache.erase(key);
+    }
+
+    void clear() {
+        for (size_t i = 0; i < shard_count(); ++i) {
+            std::lock_guard<spin_lock> guard(shards_[i].lock);
+            shards_[i].cache.clear();
+        }
+    }
+
+    // 以下逐个分片加锁累加，不是整个缓存的一致快照
+    size_t size() const { return sum([](const cache_type& c) { return c.size(); }); }
+    size_t usage() const { return sum([](const cache_type& c) { return c.usage(); }); }
+    size_t capacity() const { return sum([](const cache_type& c) { return c.capacity(); }); }
+
+    lru_stats stats() const {
+        lru_stats total = {0, 0, 0};
+        for (size_t i = 0; i < shard_count(); ++i) {
+            std::lock_guard<spin_lock> guard(shards_[i].lock);
+            lru_stats s = shards_[i].cache.stats();
+            total.hits += s.hits;
+            total.misses += s.misses;
+            total.evictions += s.evictions;
+        }
+        return total;
+    }
+
+    size_t shard_count() const noexcept { return size_t(1) << bits_; }
+
+private:
+    // 用混合后哈希值的最高几位选分片；分片内的表用低位定位，两者不相关
+    shard& shard_of(const K& key) const {
+        if (bits_ == 0)
+            return shards_[0];
+        size_t h = hash_detail::mix(hash_(key));
+        return shards_[h >> (sizeof(size_t) * 8 - bits_)];
+    }
+
+    template <typename F>
+    size_t sum(F f) const {
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count(); ++i) {
+            std::lock_guard<spin_lock> guard(shards_[i].lock);
+            total += f(shards_[i].cache);
+        }
+        return total;
+    }
+
+    shard* shards_;
+    int bits_;
+    Hash hash_;
+};
+
+}
+
+
+#endif //ZEPHYR_LRU_CACHE_H
@@ -0,0 +1,842 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#ifndef ZEPHYR_VECTOR_H
+#define ZEPHYR_VECTOR_H
+
+#include <stddef.h>
+#include <string.h>
+#include <new>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+#include "../memory/allocator.h"
+#include "../memory/construct.h"
+
+// 这个头文件包含动态数组 vector<T, Alloc, N> 与别名 small_vector<T, N>
+//
+// 接口与 std::vector 相同，默认从 zephyr::allocator<T> 分配；N 不为 0 时前 N 个元素放在对象内部，
+// 超过以后才分配堆内存（small_vector），shrink_to_fit 在元素不超过 N 时搬回对象内部
+//
+// 与 std::vector 的不同之处在于增长时怎样搬移元素：
+//   - 可以平凡重定位（is_trivially_relocatable，见 construct.h）的元素整段 memcpy / memmove，
+//     中间插入、删除时尾部也整段 memmove，不调用移动构造、移动赋值与析构；
+//   - 内存来自全局 pool_allocator 时容量取满整个块（pool_allocator::good_size），
+//     可以平凡重定位的元素增长时直接 pool_allocator::reallocate：同一分级内原地返回，
+//     两端都是直接 mmap 的大块时用 mremap，只改页表不复制；
+//   - 其余类型移动构造不抛出时一趟移动并析构，否则先复制，全部成功以后才析构旧元素
+// push_back / emplace_back 与 reserve 提供强异常保证，中间插入与删除提供基本保证
+//
+// allocator 在拷贝、移动、交换时总是跟着容器一起传播（zephyr::allocator 的 propagate_* 都是 true_type）
+
+namespace zephyr
+{
+
+namespace vector_detail
+{
+
+template <typename T, size_t N>
+struct inline_storage {
+    T* inline_data() noexcept { return reinterpret_cast<T*>(&buffer_); }
+
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type buffer_;
+};
+
+template <typename T>
+struct inline_storage<T, 0> {
+    T* inline_data() noexcept { return nullptr; }
+};
+
+} // namespace zephyr::vector_detail
+
+template <typename T, typename Alloc = allocator<T>, size_t N = 0>
+class vector : private vector_detail::inline_storage<T, N> {
+
+    static_assert(std::is_same<typename Alloc::value_type, T>::value, "Alloc::value_type must be T");
+
+    typedef std::allocator_traits<Alloc> alloc_traits;
+    typedef vector_detail::inline_storage<T, N> storage_base;
+
+    // 元素可以整段按字节搬移
+    typedef std::integral_constant<bool, is_trivially_relocatable<T>::value> trivial_tag;
+    // 搬移元素不会抛出；只能移动的类型也按此处理，与 std::vector 相同
+    typedef std::integral_constant<bool, is_trivially_relocatable<T>::value
+                                         || std::is_nothrow_move_constructible<T>::value
+                                         || !std::is_copy_constructible<T>::value> relocate_tag;
+    // 内存来自 zephyr::allocator，运行时再看是否绑定了全局 pool_allocator
+    typedef std::integral_constant<bool, std::is_same<Alloc, allocator<T>>::value
+                                         && alignof(T) <= static_cast<size_t>(Z_align)> pool_tag;
+
+public:
+    typedef T                                       value_type;
+    typedef Alloc                                   allocator_type;
+    typedef size_t                                  size_type;
+    typedef ptrdiff_t                               difference_type;
+    typedef T&                                      reference;
+    typedef const T&                                const_reference;
+    typedef T*                                      pointer;
+    typedef const T*                                const_pointer;
+    typedef T*                                      iterator;
+    typedef const T*                                const_iterator;
+    typedef std::reverse_iterator<iterator>         reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>   const_reverse_iterator;
+
+    static constexpr size_type inline_capacity = N;
+
+public:
+    vector() noexcept(noexcept(Alloc())) : vector(Alloc()) {}
+
+    explicit vector(const Alloc& alloc) noexcept
+        : begin_(inline_data()), end_(begin_), cap_(begin_ + N), alloc_(alloc) {}
+
+    explicit vector(size_type n, const Alloc& alloc = Alloc()) : vector(alloc) {
+        resize(n);
+    }
+
+    vector(size_type n, const T& value, const Alloc& alloc = Alloc()) : vector(alloc) {
+        assign(n, value);
+    }
+
+    template <typename InputIter, typename = typename std::enable_if<!std::is_integral<InputIter>::value>::type>
+    vector(InputIter first, InputIter last, const Alloc& alloc = Alloc()) : vector(alloc) {
+        assign(first, last);
+    }
+
+    vector(std::initializer_list<T> list, const Alloc& alloc = Alloc()) : vector(alloc) {
+        assign(list.begin(), list.end());
+    }
+
+    vector(const vector& other)
+        : vector(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+        assign(other.begin_, other.end_);
+    }
+
+    vector(const vector& other, const Alloc& alloc) : vector(alloc) {
+        assign(other.begin_, other.end_);
+    }
+
+    vector(vector&& other) noexcept(N == 0 || relocate_tag::value)
+        : begin_(inline_data()), end_(begin_), cap_(begin_ + N), alloc_(std::move(other.alloc_)) {
+        take(other);
+    }
+
+    ~vector() {
+        zephyr::destroy(begin_, end_);
+        deallocate_storage(begin_, capacity());
+    }
+
+    vector& operator=(const vector& other) {
+        if (this != &other) {
+            if (!(alloc_ == other.alloc_)) {
+                clear();
+                release_storage();
+            }
+            alloc_ = other.alloc_;
+            assign(other.begin_, other.end_);
+        }
+        return *this;
+    }
+
+    vector& operator=(vector&& other) noexcept(N == 0 || relocate_tag::value) {
+        if (this != &other) {
+            clear();
+            release_storage();
+            alloc_ = std::move(other.alloc_);
+            take(other);
+        }
+        return *this;
+    }
+
+    vector& operator=(std::initializer_list<T> list) {
+        assign(list.begin(), list.end());
+        return *this;
+    }
+
+    void assign(size_type n, const T& value);
+
+    template <typename InputIter, typename = typename std::enable_if<!std::is_integral<InputIter>::value>::type>
+    void assign(InputIter first, InputIter last) {
+        assign_cat(first, last, typename std::iterator_traits<InputIter>::iterator_category{});
+    }
+
+    void assign(std::initializer_list<T> list) { assign(list.begin(), list.end()); }
+
+    allocator_type get_allocator() const { return alloc_; }
+
+    // 元素访问
+    reference operator[](size_type i) noexcept { return begin_[i]; }
+    const_reference operator[](size_type i) const noexcept { return begin_[i]; }
+
+    reference at(size_type i) {
+        if (i >= size())
+            throw std::out_of_range("zephyr::vector::at");
+        return begin_[i];
+    }
+
+    const_reference at(size_type i) const {
+        if (i >= size())
+            throw std::out_of_range("zephyr::vector::at");
+        return begin_[i];
+    }
+
+    reference front() noexcept { return *begin_; }
+    const_reference front() const noexcept { return *begin_; }
+    reference back() noexcept { return end_[-1]; }
+    const_reference back() const noexcept { return end_[-1]; }
+    T* data() noexcept { return begin_; }
+    const T* data() const noexcept { return begin_; }
+
+    // 迭代器
+    iterator begin() noexcept { return begin_; }
+    const_iterator begin() const noexcept { return begin_; }
+    const_iterator cbegin() const noexcept { return begin_; }
+    iterator end() noexcept { return end_; }
+    const_iterator end() const noexcept { return end_; }
+    const_iterator cend() const noexcept { return end_; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end_); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end_); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin_); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin_); }
+
+    // 容量
+    bool empty() const noexcept { return begin_ == end_; }
+    size_type size() const noexcept { return static_cast<size_type>(end_ - begin_); }
+    size_type capacity() const noexcept { return static_cast<size_type>(cap_ - begin_); }
+    size_type max_size() const noexcept { return alloc_traits::max_size(alloc_); }
+
+    // 元素是否放在对象内部
+    bool is_inline() const noexcept {
+        return N != 0 && begin_ == const_cast<vector*>(this)->inline_data();
+    }
+
+    void reserve(size_type n) {
+        if (n > capacity()) {
+            if (n > max_size())
+                throw std::length_error("zephyr::vector::reserve");
+            reallocate_storage(n);
+        }
+    }
+
+    void shrink_to_fit();
+
+    // 修改
+    void clear() noexcept {
+        zephyr::destroy(begin_, end_);
+        end_ = begin_;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename ...Args>
+    reference emplace_back(Args&& ...args) {
+        if (end_ != cap_) {
+            ::new (static_cast<void*>(end_)) T(std::forward<Args>(args)...);
+            return *end_++;
+        }
+        return *reallocate_append(std::forward<Args>(args)...);
+    }
+
+    void pop_back() noexcept {
+        --end_;
+        zephyr::destroy(end_);
+    }
+
+    template <typename ...Args>
+    iterator emplace(const_iterator pos, Args&& ...args);
+
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+    iterator insert(const_iterator pos, size_type count, const T& value);
+
+    template <typename InputIter, typename = typename std::enable_if<!std::is_integral<InputIter>::value>::type>
+    iterator insert(const_iterator pos, InputIter first, InputIter last) {
+        return insert_cat(static_cast<size_type>(pos - begin_), first, last,
+                          typename std::iterator_traits<InputIter>::iterator_category{});
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> list) {
+        return insert(pos, list.begin(), list.end());
+    }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+    iterator erase(const_iterator first, const_iterator last);
+
+    void resize(size_type n);
+    void resize(size_type n, const T& value);
+
+    void swap(vector& other) noexcept(N == 0 || relocate_tag::value);
+
+private:
+    T* inline_data() noexcept { return storage_base::inline_data(); }
+
+    // 把 other 的元素接过来，调用前本对象没有元素并且在使用内部（或空）的存储
+    void take(vector& other) {
+        if (N == 0 || !other.is_inline()) {
+            begin_ = other.begin_;
+            end_ = other.end_;
+            cap_ = other.cap_;
+            other.begin_ = other.end_ = other.inline_data();
+            other.cap_ = other.begin_ + N;
+            return ;
+        }
+        end_ = zephyr::relocate(other.begin_, other.end_, begin_);
+        other.end_ = other.begin_;
+    }
+
+    // 容纳 n 个元素的新容量：至少翻倍
+    size_type next_capacity(size_type n) const {
+        if (n > max_size())
+            throw std::length_error("zephyr::vector");
+        size_type cap = capacity();
+        size_type grown = cap > max_size() - cap ? max_size() : cap * 2;
+        return grown < n ? n : grown;
+    }
+
+    // 池内的块按分级取整，多出来的部分也算作容量
+    size_type fit_capacity(size_type cap) const { return fit_capacity_cat(cap, pool_tag{}); }
+
+    size_type fit_capacity_cat(size_type cap, std::true_type) const {
+        if (alloc_.backend() != allocator_backend::pool)
+            return cap;
+        size_type fit = pool_allocator::good_size(cap * sizeof(T)) / sizeof(T);
+        return fit < max_size() ? fit : max_size();
+    }
+
+    size_type fit_capacity_cat(size_type cap, std::false_type) const { return cap; }
+
+    // 可以直接交给 pool_allocator::reallocate：元素可以平凡重定位，并且存储是全局 pool 上的堆内存
+    bool can_reallocate() const { return trivial_tag::value && begin_ != nullptr && !is_inline()
+                                         && pool_backend(pool_tag{}); }
+
+    bool pool_backend(std::true_type) const { return alloc_.backend() == allocator_backend::pool; }
+    bool pool_backend(std::false_type) const { return false; }
+
+    T* allocate_storage(size_type& cap) {
+        cap = fit_capacity(cap);
+        return alloc_traits::allocate(alloc_, cap);
+    }
+
+    void deallocate_storage(T* p, size_type cap) noexcept {
+        if (p != nullptr && p != inline_data())
+            alloc_traits::deallocate(alloc_, p, cap);
+    }
+
+    // 元素已经搬走或析构，归还存储并回到内部（或空）的存储
+    void release_storage() noexcept {
+        deallocate_storage(begin_, capacity());
+        begin_ = end_ = inline_data();
+        cap_ = begin_ + N;
+    }
+
+    void reallocate_storage(size_type cap);
+
+    template <typename ...Args>
+    T* reallocate_append(Args&& ...args);
+
+    template <typename Construct>
+    T* reallocate_insert(size_type idx, size_type count, size_type cap, Construct construct);
+
+    void transfer(T* nb, size_type cap, size_type idx, size_type count, std::true_type) noexcept;
+    void transfer(T* nb, size_type cap, size_type idx, size_type count, std::false_type);
+
+    template <typename ForwardIter>
+    void assign_cat(ForwardIter first, ForwardIter last, std::forward_iterator_tag);
+    template <typename InputIter>
+    void assign_cat(InputIter first, InputIter last, std::input_iterator_tag);
+
+    template <typename ForwardIter>
+    iterator insert_cat(size_type idx, ForwardIter first, ForwardIter last, std::forward_iterator_tag);
+    template <typename InputIter>
+    iterator insert_cat(size_type idx, InputIter first, InputIter last, std::input_iterator_tag);
+
+    // 容量足够时在 idx 处插入，可以平凡重定位的元素整段 memmove 腾出位置
+    template <typename ...Args>
+    void emplace_gap(size_type idx, std::true_type, Args&& ...args);
+    template <typename ...Args>
+    void emplace_gap(size_type idx, std::false_type, Args&& ...args);
+    void fill_gap(size_type idx, size_type count, const T& value, std::true_type);
+    void fill_gap(size_type idx, size_type count, const T& value, std::false_type);
+    template <typename ForwardIter>
+    void copy_gap(size_type idx, ForwardIter first, ForwardIter last, size_type count, std::true_type);
+    template <typename ForwardIter>
+    void copy_gap(size_type idx, ForwardIter first, ForwardIter last, size_type count, std::false_type);
+
+    void erase_cat(T* first, T* last, std::true_type) noexcept;
+    void erase_cat(T* first, T* last, std::false_type);
+
+    void move_tail(size_type from, size_type to) noexcept {
+        memmove(static_cast<void*>(begin_ + to), static_cast<const void*>(begin_ + from),
+                (size() - from) * sizeof(T));
+    }
+
+    T* begin_;
+    T* end_;
+    T* cap_;
+    Alloc alloc_;
+};
+
+// 元素在 N 个以内时不分配堆内存的 vector
+template <typename T, size_t N, typename Alloc = allocator<T>>
+using small_vector = vector<T, Alloc, N>;
+
+template <typename T, typename Alloc, size_t N>
+constexpr typename vector<T, Alloc, N>::size_type vector<T, Alloc, N>::inline_capacity;
+
+// ---------------------------------------------------------------------------
+// 存储
+// ---------------------------------------------------------------------------
+
+// 把容量调整为 cap（不少于 size()），元素数不变
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::reallocate_storage(size_type cap) {
+    if (can_reallocate()) {
+        size_type n = size();
+        cap = fit_capacity(cap);
+        T* p = static_cast<T*>(pool_allocator::reallocate(begin_, capacity() * sizeof(T), cap * sizeof(T)));
+        begin_ = p;
+        end_ = p + n;
+        cap_ = p + cap;
+        return ;
+    }
+    reallocate_insert(size(), 0, cap, [](T*) {});
+}
+
+// 先在新存储中构造出新元素（参数可能引用旧存储中的元素），再把旧元素搬过去
+template <typename T, typename Alloc, size_t N>
+template <typename ...Args>
+T* vector<T, Alloc, N>::reallocate_append(Args&& ...args) {
+    size_type cap = next_capacity(size() + 1);
+    if (can_reallocate()) {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type slot;
+        T* value = ::new (static_cast<void*>(&slot)) T(std::forward<Args>(args)...);
+        try {
+            reallocate_storage(cap);
+        }
+        catch (...) {
+            zephyr::destroy(value);
+            throw;
+        }
+        memcpy(static_cast<void*>(end_), static_cast<const void*>(value), sizeof(T));
+        return end_++;
+    }
+    return reallocate_insert(size(), 1, cap, [&](T* p) {
+        ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+    });
+}
+
+// 分配容量为 cap 的新存储，construct 在 idx 处构造 count 个新元素，旧元素搬到它们两侧
+template <typename T, typename Alloc, size_t N>
+template <typename Construct>
+T* vector<T, Alloc, N>::reallocate_insert(size_type idx, size_type count, size_type cap, Construct construct) {
+    size_type n = size();
+    T* nb = allocate_storage(cap);
+    try {
+        construct(nb + idx);
+    }
+    catch (...) {
+        alloc_traits::deallocate(alloc_, nb, cap);
+        throw;
+    }
+    transfer(nb, cap, idx, count, relocate_tag{});
+    release_storage();
+    begin_ = nb;
+    end_ = nb + n + count;
+    cap_ = nb + cap;
+    return nb + idx;
+}
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::transfer(T* nb, size_type, size_type idx, size_type count, std::true_type) noexcept {
+    zephyr::relocate(begin_, begin_ + idx, nb);
+    zephyr::relocate(begin_ + idx, end_, nb + idx + count);
+    end_ = begin_;
+}
+
+// 移动可能抛出：复制到新存储，全部成功以后才析构旧元素，失败时旧存储原样保留
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::transfer(T* nb, size_type cap, size_type idx, size_type count, std::false_type) {
+    T* done = nb;
+    try {
+        done = zephyr::uninitialized_copy(begin_, begin_ + idx, nb);
+        zephyr::uninitialized_copy(begin_ + idx, end_, nb + idx + count);
+    }
+    catch (...) {
+        zephyr::destroy(nb, done);
+        zephyr::destroy(nb + idx, nb + idx + count);
+        alloc_traits::deallocate(alloc_, nb, cap);
+        throw;
+    }
+    clear();
+}
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::shrink_to_fit() {
+    if (is_inline() || end_ == cap_)
+        return ;
+    size_type n = size();
+    if (n <= N) {
+        // 搬回对象内部；N 为 0 时只会是空容器，直接归还存储
+        T* old = begin_;
+        size_type cap = capacity();
+        T* dst = inline_data();
+        zephyr::relocate(old, end_, dst);
+        deallocate_storage(old, cap);
+        begin_ = dst;
+        end_ = dst + n;
+        cap_ = dst + N;
+        return ;
+    }
+    if (fit_capacity(n) < capacity())
+        reallocate_storage(n);
+}
+
+// ---------------------------------------------------------------------------
+// assign
+// ---------------------------------------------------------------------------
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::assign(size_type n, const T& value) {
+    if (n > capacity()) {
+        if (n > max_size())
+            throw std::length_error("zephyr::vector::assign");
+        size_type cap = n;
+        T* nb = allocate_storage(cap);
+        try {
+            zephyr::uninitialized_fill_n(nb, n, value);
+        }
+        catch (...) {
+            alloc_traits::deallocate(alloc_, nb, cap);
+            throw;
+        }
+        clear();
+        release_storage();
+        begin_ = nb;
+        end_ = nb + n;
+        cap_ = nb + cap;
+    }
+    else if (n <= size()) {
+        std::fill_n(begin_, n, value);
+        zephyr::destroy(begin_ + n, end_);
+        end_ = begin_ + n;
+    }
+    else {
+        std::fill(begin_, end_, value);
+        end_ = zephyr::uninitialized_fill_n(end_, n - size(), value);
+    }
+}
+
+template <typename T, typename Alloc, size_t N>
+template <typename ForwardIter>
+void vector<T, Alloc, N>::assign_cat(ForwardIter first, ForwardIter last, std::forward_iterator_tag) {
+    size_type n = static_cast<size_type>(std::distance(first, last));
+    if (n > capacity()) {
+        if (n > max_size())
+            throw std::length_error("zephyr::vector::assign");
+        size_type cap = n;
+        T* nb = allocate_storage(cap);
+        try {
+            zephyr::uninitialized_copy(first, last, nb);
+        }
+        catch (...) {
+            alloc_traits::deallocate(alloc_, nb, cap);
+            throw;
+        }
+        clear();
+        release_storage();
+        begin_ = nb;
+        end_ = nb + n;
+        cap_ = nb + cap;
+    }
+    else if (n <= size()) {
+        T* new_end = std::copy(first, last, begin_);
+        zephyr::destroy(new_end, end_);
+        end_ = new_end;
+    }
+    else {
+        ForwardIter mid = first;
+        std::advance(mid, size());
+        std::copy(first, mid, begin_);
+        end_ = zephyr::uninitialized_copy(mid, last, end_);
+    }
+}
+
+template <typename T, typename Alloc, size_t N>
+template <typename InputIter>
+void vector<T, Alloc, N>::assign_cat(InputIter first, InputIter last, std::input_iterator_tag) {
+    clear();
+    for (; first != last; ++first)
+        emplace_back(*first);
+}
+
+// ---------------------------------------------------------------------------
+// insert
+// ---------------------------------------------------------------------------
+
+template <typename T, typename Alloc, size_t N>
+template <typename ...Args>
+typename vector<T, Alloc, N>::iterator vector<T, Alloc, N>::emplace(const_iterator pos, Args&& ...args) {
+    size_type idx = static_cast<size_type>(pos - begin_);
+    if (end_ == cap_)
+        return reallocate_insert(idx, 1, next_capacity(size() + 1), [&](T* p) {
+            ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+        });
+    if (begin_ + idx == end_) {
+        ::new (static_cast<void*>(end_)) T(std::forward<Args>(args)...);
+        ++end_;
+    }
+    else
+        emplace_gap(idx, trivial_tag{}, std::forward<Args>(args)...);
+    return begin_ + idx;
+}
+
+// 先构造出新元素再挪动尾部：参数可能引用容器中的元素
+template <typename T, typename Alloc, size_t N>
+template <typename ...Args>
+void vector<T, Alloc, N>::emplace_gap(size_type idx, std::true_type, Args&& ...args) {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type slot;
+    T* value = ::new (static_cast<void*>(&slot)) T(std::forward<Args>(args)...);
+    move_tail(idx, idx + 1);
+    memcpy(static_cast<void*>(begin_ + idx), static_cast<const void*>(value), sizeof(T));
+    ++end_;
+}
+
+template <typename T, typename Alloc, size_t N>
+template <typename ...Args>
+void vector<T, Alloc, N>::emplace_gap(size_type idx, std::false_type, Args&& ...args) {
+    T value(std::forward<Args>(args)...);
+    ::new (static_cast<void*>(end_)) T(std::move(end_[-1]));
+    ++end_;
+    std::move_backward(begin_ + idx, end_ - 2, end_ - 1);
+    begin_[idx] = std::move(value);
+}
+
+template <typename T, typename Alloc, size_t N>
+typename vector<T, Alloc, N>::iterator
+vector<T, Alloc, N>::insert(const_iterator pos, size_type count, const T& value) {
+    size_type idx = static_cast<size_type>(pos - begin_);
+    if (count == 0)
+        return begin_ + idx;
+    if (count > static_cast<size_type>(cap_ - end_))
+        return reallocate_insert(idx, count, next_capacity(size() + count), [&](T* p) {
+            zephyr::uninitialized_fill_n(p, count, value);
+        });
+    T copy(value);
+    fill_gap(idx, count, copy, trivial_tag{});
+    return begin_ + idx;
+}
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::fill_gap(size_type idx, size_type count, const T& value, std::true_type) {
+    move_tail(idx, idx + count);
+    try {
+        zephyr::uninitialized_fill_n(begin_ + idx, count, value);
+    }
+    catch (...) {
+        memmove(static_cast<void*>(begin_ + idx), static_cast<const void*>(begin_ + idx + count),
+                (size() - idx) * sizeof(T));
+        throw;
+    }
+    end_ += count;
+}
+
+// 与 libstdc++ 相同：尾部比新元素多时尾部末端移动构造到未初始化的部分、其余向后移动赋值，
+// 否则多出来的新元素直接构造在末尾之后
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::fill_gap(size_type idx, size_type count, const T& value, std::false_type) {
+    T* pos = begin_ + idx;
+    T* old_end = end_;
+    size_type after = size() - idx;
+    if (after > count) {
+        end_ = zephyr::uninitialized_move(old_end - count, old_end, old_end);
+        std::move_backward(pos, old_end - count, old_end);
+        std::fill(pos, pos + count, value);
+    }
+    else {
+        end_ = zephyr::uninitialized_fill_n(old_end, count - after, value);
+        end_ = zephyr::uninitialized_move(pos, old_end, end_);
+        std::fill(pos, old_end, value);
+    }
+}
+
+template <typename T, typename Alloc, size_t N>
+template <typename ForwardIter>
+typename vector<T, Alloc, N>::iterator
+vector<T, Alloc, N>::insert_cat(size_type idx, ForwardIter first, ForwardIter last, std::forward_iterator_tag) {
+    size_type count = static_cast<size_type>(std::distance(first, last));
+    if (count == 0)
+        return begin_ + idx;
+    if (count > static_cast<size_type>(cap_ - end_))
+        return reallocate_insert(idx, count, next_capacity(size() + count), [&](T* p) {
+            zephyr::uninitialized_copy(first, last, p);
+        });
+    copy_gap(idx, first, last, count, trivial_tag{});
+    return begin_ + idx;
+}
+
+// 单趟迭代器不能预先知道个数：先追加到末尾再旋转到位
+template <typename T, typename Alloc, size_t N>
+template <typename InputIter>
+typename vector<T, Alloc, N>::iterator
+vector<T, Alloc, N>::insert_cat(size_type idx, InputIter first, InputIter last, std::input_iterator_tag) {
+    size_type n = size();
+    for (; first != last; ++first)
+        emplace_back(*first);
+    std::rotate(begin_ + idx, begin_ + n, end_);
+    return begin_ + idx;
+}
+
+template <typename T, typename Alloc, size_t N>
+template <typename ForwardIter>
+void vector<T, Alloc, N>::copy_gap(size_type idx, ForwardIter first, ForwardIter last, size_type count,
+                                   std::true_type) {
+    move_tail(idx, idx + count);
+    try {
+        zephyr::uninitialized_copy(first, last, begin_ + idx);
+    }
+    catch (...) {
+        memmove(static_cast<void*>(begin_ + idx), static_cast<const void*>(begin_ + idx + count),
+                (size() - idx) * sizeof(T));
+        throw;
+    }
+    end_ += count;
+}
+
+template <typename T, typename Alloc, size_t N>
+template <typename ForwardIter>
+void vector<T, Alloc, N>::copy_gap(size_type idx, ForwardIter first, ForwardIter last, size_type count,
+                                   std::false_type) {
+    T* pos = begin_ + idx;
+    T* old_end = end_;
+    size_type after = size() - idx;
+    if (after > count) {
+        end_ = zephyr::uninitialized_move(old_end - count, old_end, old_end);
+        std::move_backward(pos, old_end - count, old_end);
+        std::copy(first, last, pos);
+    }
+    else {
+        ForwardIter mid = first;
+        std::advance(mid, after);
+        end_ = zephyr::uninitialized_copy(mid, last, old_end);
+        end_ = zephyr::uninitialized_move(pos, old_end, end_);
+        std::copy(first, mid, pos);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// erase / resize / swap
+// ---------------------------------------------------------------------------
+
+template <typename T, typename Alloc, size_t N>
+typename vector<T, Alloc, N>::iterator vector<T, Alloc, N>::erase(const_iterator first, const_iterator last) {
+    T* f = begin_ + (first - begin_);
+    T* l = begin_ + (last - begin_);
+    if (f != l)
+        erase_cat(f, l, trivial_tag{});
+    return f;
+}
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::erase_cat(T* first, T* last, std::true_type) noexcept {
+    zephyr::destroy(first, last);
+    memmove(static_cast<void*>(first), static_cast<const void*>(last),
+            static_cast<size_t>(end_ - last) * sizeof(T));
+    end_ -= last - first;
+}
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::erase_cat(T* first, T* last, std::false_type) {
+    T* new_end = std::move(last, end_, first);
+    zephyr::destroy(new_end, end_);
+    end_ = new_end;
+}
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::resize(size_type n) {
+    if (n <= size()) {
+        zephyr::destroy(begin_ + n, end_);
+        end_ = begin_ + n;
+        return ;
+    }
+    if (n > capacity())
+        reallocate_storage(next_capacity(n));
+    end_ = zephyr::uninitialized_value_construct_n(end_, n - size());
+}
+
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::resize(size_type n, const T& value) {
+    if (n <= size()) {
+        zephyr::destroy(begin_ + n, end_);
+        end_ = begin_ + n;
+        return ;
+    }
+    size_type count = n - size();
+    if (n > capacity())
+        reallocate_insert(size(), count, next_capacity(n), [&](T* p) {
+            zephyr::uninitialized_fill_n(p, count, value);
+        });
+    else
+        end_ = zephyr::uninitialized_fill_n(end_, count, value);
+}
+
+// 两边都在堆上时只交换指针；有一边在对象内部时经过一个临时对象移动
+template <typename T, typename Alloc, size_t N>
+void vector<T, Alloc, N>::swap(vector& other) noexcept(N == 0 || relocate_tag::value) {
+    if (this == &other)
+        return ;
+    if (N == 0 || (!is_inline() && !other.is_inline())) {
+        std::swap(begin_, other.begin_);
+        std::swap(end_, other.end_);
+        std::swap(cap_, other.cap_);
+        std::swap(alloc_, other.alloc_);
+        return ;
+    }
+    vector tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+}
+
+template <typename T, typename Alloc, size_t N>
+inline void swap(vector<T, Alloc, N>& lhs, vector<T, Alloc, N>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
+
+template <typename T, typename Alloc, size_t N>
+bool operator==(const vector<T, Alloc, N>& lhs, const vector<T, Alloc, N>& rhs) {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T, typename Alloc, size_t N>
+bool operator!=(const vector<T, Alloc, N>& lhs, const vector<T, Alloc, N>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename T, typename Alloc, size_t N>
+bool operator<(const vector<T, Alloc, N>& lhs, const vector<T, Alloc, N>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, typename Alloc, size_t N>
+bool operator>(const vector<T, Alloc, N>& lhs, const vector<T, Alloc, N>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename T, typename Alloc, size_t N>
+bool operator<=(const vector<T, Alloc, N>& lhs, const vector<T, Alloc, N>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename T, typename Alloc, size_t N>
+bool operator>=(const vector<T, Alloc, N>& lhs, const vector<T, Alloc, N>& rhs) {
+    return !(lhs < rhs);
+}
+
+}
+
+
+#endif //ZEPHYR_VECTOR_H
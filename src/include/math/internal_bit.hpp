@@ -16,12 +16,20 @@ namespace zephyr
  * @param n '0 <= n'
  * @return  minimum non-negative `x` s.t. `n <= 2 ** x`
  */
-int ceil_pow2(int n) {
-    int x;
+inline int ceil_pow2(int n) {
+    int x = 0;
     while ((1U << x) < (unsigned int)(n)) ++x;
     return x;
 }
 
+/**
+ * @param n '0 <= n'
+ * @return  minimum non-negative `x` s.t. `n <= 2 ** x`
+ */
+constexpr int ceil_pow2_constexpr(unsigned long long n, int x = 0) {
+    return (1ULL << x) >= n ? x : ceil_pow2_constexpr(n, x + 1);
+}
+
 /**
  * @param n `1 <= n`
  * @return minimum non-negative `x` s.t. `(n & (1 << x)) != 0`
@@ -37,7 +45,7 @@ constexpr int bsf_constexpr(unsigned int n) {
  * @param n `1 <= n`
  * @return minimum non-negative `x` s.t. `(n & (1 << x)) != 0`
  */
-int bsf(unsigned int n) {
+inline int bsf(unsigned int n) {
 #ifdef _MSC_VER
     unsigned long index;
     _BitScanForward(&index, n);
@@ -47,6 +55,29 @@ int bsf(unsigned int n) {
 #endif
 }
 
+/**
+ * @param n `1 <= n`
+ * @return maximum non-negative `x` s.t. `(n & (1 << x)) != 0`
+ */
+constexpr int bsr_constexpr(unsigned long long n) {
+    return n <= 1 ? 0 : 1 + bsr_constexpr(n >> 1);
+}
+
+/**
+ * The index of the highest 1 in binary, i.e. `floor(log2(n))`. When `n` is 0, the result is undefined.
+ * @param n `1 <= n`
+ * @return maximum non-negative `x` s.t. `(n & (1 << x)) != 0`
+ */
+inline int bsr(unsigned long long n) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, n);
+    return index;
+#else
+    return 63 - __builtin_clzll(n);
+#endif
+}
+
 /**
  * @tparam Integer
  * @param n `1 <= n`
@@ -55,7 +86,7 @@ int bsf(unsigned int n) {
 template <typename Integer>
 Integer lowbit(Integer n) { return n & (-n); }
 
-int lowbit(int n) { return n & (-n); }
+inline int lowbit(int n) { return n & (-n); }
 
 /**
  * @tparam Integer
@@ -65,9 +96,9 @@ int lowbit(int n) { return n & (-n); }
 template <typename Integer>
 bool is_power_of2(Integer n) { return n > 0 && (n & (n - 1)) == 0; }
 
-bool is_power_of2(int n) { return n > 0 && (n & (n - 1)) == 0; }
+inline bool is_power_of2(int n) { return n > 0 && (n & (n - 1)) == 0; }
 
-int abs(int n) {
+inline int abs(int n) {
     return (n ^ (n >> 31)) - (n >> 31);
     /* n>>31 取得 n 的符号，若 n 为正数，n>>31 等于 0，若 n 为负数，n>>31 等于 -1
      若 n 为正数 n^0=n, 数不变，若 n 为负数有 n^(-1)
@@ -76,11 +107,11 @@ int abs(int n) {
 }
 
 // if `a >= b`, `(a - b) >> 31 = 0`，else `(a - b) >> 31 = -1`
-int max(int a, int b) {
+inline int max(int a, int b) {
     return (b & ((a - b) >> 31)) | (a & (~(a - b) >> 31));
 }
 
-int min(int a, int b) {
+inline int min(int a, int b) {
     return (a & ((a - b) >> 31)) | (b & (~(a - b) >> 31));
 }
 
@@ -89,7 +120,7 @@ int min(int a, int b) {
  * @param n
  * @return number of one in `n`
  */
-int popcount(long long n) {
+inline int popcount(long long n) {
     int cnt = 0;
     while (n)
         ++cnt,
@@ -16,7 +16,7 @@ namespace zephyr
  * @param n `n >= 0`
  * @return `p ** n`
  */
-double pow(double p, int n) {
+inline double pow(double p, int n) {
     double result = 1.0;
     while (n) {
         if (n & 1)
@@ -28,9 +28,9 @@ double pow(double p, int n) {
 }
 
 
-long long pow_by_mod(long long p,
-                     unsigned long long n,
-                     unsigned long long mod) {
+inline long long pow_by_mod(long long p,
+                            unsigned long long n,
+                            unsigned long long mod) {
     long long result = 1;
     while (n) {
         if (n & 1)
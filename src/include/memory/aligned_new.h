@@ -0,0 +1,46 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_ALIGNED_NEW_H
+#define ZEPHYR_ALIGNED_NEW_H
+
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+
+// 这个头文件包含 aligned_new / aligned_delete：池放不下的带对齐要求的请求最终交给它们
+//
+// ::operator new 只保证 default_new_align 字节对齐，更大的对齐用 posix_memalign；
+// C++14 里没有带 std::align_val_t 的 operator new，所以不依赖它。align 必须是 2 的幂
+
+namespace zephyr
+{
+
+#ifdef __STDCPP_DEFAULT_NEW_ALIGNMENT__
+enum { default_new_align = __STDCPP_DEFAULT_NEW_ALIGNMENT__ };
+#else
+enum { default_new_align = alignof(max_align_t) };
+#endif
+
+inline void* aligned_new(size_t bytes, size_t align) {
+    if (align <= static_cast<size_t>(default_new_align))
+        return ::operator new(bytes);
+    void* p = nullptr;
+    if (posix_memalign(&p, align < sizeof(void*) ? sizeof(void*) : align, bytes == 0 ? 1 : bytes) != 0)
+        throw std::bad_alloc();
+    return p;
+}
+
+// align 必须与 aligned_new 时相同
+inline void aligned_delete(void* p, size_t align) {
+    if (align <= static_cast<size_t>(default_new_align))
+        ::operator delete(p);
+    else
+        free(p);
+}
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_ALIGNED_NEW_H
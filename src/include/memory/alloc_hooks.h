@@ -0,0 +1,58 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#ifndef ZEPHYR_ALLOC_HOOKS_H
+#define ZEPHYR_ALLOC_HOOKS_H
+
+#include <stddef.h>
+
+#include "alloc_trace.h"
+#ifdef ZEPHYR_HEAP_PROFILE
+#include "heap_profiler.h"
+#endif
+
+// 这个头文件包含分配器的记录点：每次分配之后调用 trace_allocate，每次释放之前调用 trace_deallocate
+//
+// 定义 ZEPHYR_ALLOCATOR_TRACE 时转给 alloc_trace，定义 ZEPHYR_HEAP_PROFILE 时转给 heap_profiler；
+// 都没有定义时是空函数，不产生任何代码
+
+namespace zephyr
+{
+
+inline void trace_allocate(trace_source source, const void* p, size_t n) {
+#ifdef ZEPHYR_ALLOCATOR_TRACE
+    alloc_trace::record(trace_op::allocate, source, p, n);
+#endif
+#ifdef ZEPHYR_HEAP_PROFILE
+    heap_profiler::on_allocate(p, n);
+#endif
+    (void)source, (void)p, (void)n;
+}
+
+inline void trace_deallocate(trace_source source, const void* p, size_t n) {
+#ifdef ZEPHYR_ALLOCATOR_TRACE
+    alloc_trace::record(trace_op::deallocate, source, p, n);
+#endif
+#ifdef ZEPHYR_HEAP_PROFILE
+    heap_profiler::on_deallocate(p);
+#endif
+    (void)source, (void)p, (void)n;
+}
+
+// 批量接口用：不需要时连逐个记录的循环都不走
+// heap_profiler 在 stop 之后仍要在释放时更新已有的样本，编译进来就一直需要
+inline bool hooks_active() {
+#if defined(ZEPHYR_HEAP_PROFILE)
+    return true;
+#elif defined(ZEPHYR_ALLOCATOR_TRACE)
+    return alloc_trace::active();
+#else
+    return false;
+#endif
+}
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_ALLOC_HOOKS_H
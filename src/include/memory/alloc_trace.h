@@ -0,0 +1,192 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#ifndef ZEPHYR_ALLOC_TRACE_H
+#define ZEPHYR_ALLOC_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// 这个头文件包含 alloc_trace：把分配、释放事件记录到一个二进制的环形缓冲文件，供 bench/trace_replay 离线重放
+//
+// 定义 ZEPHYR_ALLOCATOR_TRACE 时 pool_allocator、fixed_allocator、concurrent_fixed_allocator 与
+// global_allocator 的大块在每次分配之后、每次释放之前经 alloc_hooks.h 调用 record；
+// 编译进来以后，在 alloc_trace::start 与 stop 之间才真正记录
+//
+// 文件是 MAP_SHARED 映射：开头是 trace_header，之后是 capacity 个 trace_event 的环。
+// 每个事件用一次 fetch_add 取得序号，写入 序号 % capacity 的槽位，不加锁；写满以后覆盖最早的事件。
+// 分配在拿到地址之后取序号、释放在归还之前取序号，所以同一个地址的释放总排在它被再次分配之前，
+// 序号顺序就是一个合法的重放顺序
+
+namespace zephyr
+{
+
+enum class trace_op : uint8_t {
+    none = 0,           // 槽位从未写过
+    allocate = 1,
+    deallocate = 2
+};
+
+enum class trace_source : uint8_t {
+    pool = 0,           // pool_allocator
+    fixed = 1,          // fixed_allocator、concurrent_fixed_allocator
+    global = 2          // global_allocator 直接映射的大块
+};
+
+struct trace_event {
+    uint64_t time;          // 距 start 的纳秒数
+    uint64_t address;       // 块地址，只用来把释放与分配对应起来
+    uint32_t size;          // 请求的字节数，超过 UINT32_MAX 的记为 UINT32_MAX
+    uint16_t thread;        // 线程编号，从 1 开始按第一次记录的先后分配
+    trace_op op;
+    trace_source source;
+};
+
+static_assert(sizeof(trace_event) == 24, "trace_event must stay compact");
+
+struct trace_header {
+    char magic[8];                  // "ZPHTRACE"
+    uint32_t version;
+    uint32_t event_bytes;           // sizeof(trace_event)
+    uint64_t capacity;              // 环中的事件数
+    std::atomic<uint64_t> head;     // 累计取得的序号数，超过 capacity 时最早的 head - capacity 个已被覆盖
+    char pad[32];
+};
+
+static_assert(sizeof(trace_header) == 64, "trace_header must be one cache line");
+
+class alloc_trace {
+
+public:
+    enum { version = 1 };
+
+    // 创建（或截断）path，映射 capacity 个事件的环并开始记录；已经在记录或失败时返回 false
+    // 只使用 open / ftruncate / mmap，不会分配内存，替换了 malloc 时也可以调用
+    static bool start(const char* path, size_t capacity = size_t(1) << 20) {
+        if (capacity == 0 || active())
+            return false;
+        int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+        size_t bytes = sizeof(trace_header) + capacity * sizeof(trace_event);
+        void* p = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+            p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        trace_header* h = static_cast<trace_header*>(p);
+        memcpy(h->magic, "ZPHTRACE", 8);
+        h->version = version;
+        h->event_bytes = sizeof(trace_event);
+        h->capacity = capacity;
+        h->head.store(0, std::memory_order_relaxed);
+        epoch() = clock_type::now();
+        trace_header* expected = nullptr;
+        if (!current().compare_exchange_strong(expected, h, std::memory_order_acq_rel)) {
+            ::munmap(p, bytes);
+            return false;
+        }
+        return true;
+    }
+
+    // 停止记录并把映射写回文件。其他线程可能还在写最后几个事件，映射保留到进程退出
+    static void stop() {
+        trace_header* h = current().exchange(nullptr, std::memory_order_acq_rel);
+        if (h != nullptr)
+            ::msync(h, sizeof(trace_header) + h->capacity * sizeof(trace_event), MS_SYNC);
+    }
+
+    static bool active() {
+        return current().load(std::memory_order_relaxed) != nullptr;
+    }
+
+    static void record(trace_op op, trace_source source, const void* p, size_t n) {
+        trace_header* h = current().load(std::memory_order_acquire);
+        if (h == nullptr || p == nullptr)
+            return ;
+        uint64_t i = h->head.fetch_add(1, std::memory_order_relaxed);
+        trace_event& e = events(h)[i % h->capacity];
+        e.time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock_type::now() - epoch()).count());
+        e.address = reinterpret_cast<uintptr_t>(p);
+        e.size = n > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(n);
+        e.thread = thread_id();
+        e.source = source;
+        e.op = op;
+    }
+
+    // 按序号顺序读出环中的事件，跳过没有写完的槽位；dropped 为被覆盖的事件数
+    // 文件不存在或格式不对时返回 false
+    static bool read(const char* path, std::vector<trace_event>& out, uint64_t* dropped = nullptr) {
+        FILE* f = fopen(path, "rb");
+        if (f == nullptr)
+            return false;
+        trace_header h;
+        bool ok = fread(&h, sizeof(h), 1, f) == 1
+                  && memcmp(h.magic, "ZPHTRACE", 8) == 0
+                  && h.version == version
+                  && h.event_bytes == sizeof(trace_event)
+                  && h.capacity != 0;
+        std::vector<trace_event> ring;
+        if (ok) {
+            ring.resize(static_cast<size_t>(h.capacity));
+            ok = fread(ring.data(), sizeof(trace_event), ring.size(), f) == ring.size();
+        }
+        fclose(f);
+        if (!ok)
+            return false;
+        uint64_t head = h.head.load(std::memory_order_relaxed);
+        uint64_t first = head > h.capacity ? head - h.capacity : 0;
+        out.clear();
+        out.reserve(static_cast<size_t>(head - first));
+        for (uint64_t i = first; i < head; ++i) {
+            const trace_event& e = ring[static_cast<size_t>(i % h.capacity)];
+            if (e.op != trace_op::none)
+                out.push_back(e);
+        }
+        if (dropped != nullptr)
+            *dropped = first;
+        return true;
+    }
+
+private:
+    typedef std::chrono::steady_clock clock_type;
+
+    static std::atomic<trace_header*>& current() {
+        static std::atomic<trace_header*> h(nullptr);
+        return h;
+    }
+
+    static clock_type::time_point& epoch() {
+        static clock_type::time_point t;
+        return t;
+    }
+
+    static trace_event* events(trace_header* h) {
+        return reinterpret_cast<trace_event*>(h + 1);
+    }
+
+    static uint16_t thread_id() {
+        static std::atomic<uint16_t> next(0);
+        static thread_local uint16_t id = 0;
+        if (id == 0)
+            id = static_cast<uint16_t>(next.fetch_add(1, std::memory_order_relaxed) + 1);
+        return id;
+    }
+};
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_ALLOC_TRACE_H
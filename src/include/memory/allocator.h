@@ -5,14 +5,41 @@
 #ifndef ZEPHYR_ALLOCATOR_H
 #define ZEPHYR_ALLOCATOR_H
 
+#include <new>
+#include <limits>
+#include <type_traits>
+
 #include "pool_allocator.h"
+#include "loki_allocator.h"
+#include "arena.h"
 #include "construct.h"
 
 // 这个头文件包含一个模板类 allocator，用于管理内存的分配、释放，对象的构造、析构
+//
+// allocator 满足 C++11 Allocator 要求，可以用于 std::map、std::list、std::unordered_map 等容器
+// 每个 allocator 对象绑定一个内存来源：
+//   pool        : 全局的 pool_allocator（默认构造），线程安全
+//   thread_pool : 一个不加锁的 small_object_allocator，通常是当前线程独有的那个（per_thread()），
+//                 容器只能在该线程内使用和销毁
+//   arena       : 一个 arena，释放什么也不做
+// 两个 allocator 绑定同一个来源时相等；拷贝、移动、交换容器时 allocator 跟着一起传播
+// 三种来源分配的内存都按 alignof(T) 对齐
 
 namespace zephyr
 {
 
+enum class allocator_backend {
+    pool,
+    thread_pool,
+    arena
+};
+
+// 当前线程独有的 small_object_allocator，线程退出时销毁
+inline small_object_allocator& thread_small_object_allocator() {
+    static thread_local small_object_allocator allocator;
+    return allocator;
+}
+
 // 模板类：allocator
 // 模板函数代表数据类型
 template <typename T>
@@ -27,74 +54,153 @@ public:
     typedef size_t       size_type;
     typedef ptrdiff_t    difference_type;
 
+    typedef std::true_type  propagate_on_container_copy_assignment;
+    typedef std::true_type  propagate_on_container_move_assignment;
+    typedef std::true_type  propagate_on_container_swap;
+    typedef std::false_type is_always_equal;
+
+    template <typename U>
+    struct rebind {
+        typedef allocator<U> other;
+    };
+
 public:
-    static T*   allocate();
-    static T*   allocate(size_type n);
+    allocator() noexcept
+        : backend_(allocator_backend::pool), state_(nullptr) {}
+
+    explicit allocator(small_object_allocator& pool) noexcept
+        : backend_(allocator_backend::thread_pool), state_(&pool) {}
+
+    explicit allocator(zephyr::arena& a) noexcept
+        : backend_(allocator_backend::arena), state_(&a) {}
+
+    template <typename U>
+    allocator(const allocator<U>& other) noexcept
+        : backend_(other.backend_), state_(other.state_) {}
 
-    static void deallocate(T* ptr);
-    static void deallocate(T* ptr, size_type n);
+    // 绑定当前线程的 small_object_allocator
+    static allocator per_thread() {
+        return allocator(thread_small_object_allocator());
+    }
 
-    static void construct(T* ptr);
-    static void construct(T* ptr, const T& value);
-    static void construct(T* ptr, T&& value);
+    T*   allocate();
+    T*   allocate(size_type n);
 
-    template <typename ... Args>
-    static void construct(T* ptr, Args&& ...args);
+    void deallocate(T* ptr);
+    void deallocate(T* ptr, size_type n);
 
-    static void destroy(T* ptr);
-    static void destroy(T* first, T* last);
+    template <typename U, typename ... Args>
+    void construct(U* ptr, Args&& ...args);
 
+    template <typename U>
+    void destroy(U* ptr);
+    void destroy(T* first, T* last);
+
+    size_type max_size() const noexcept {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    allocator select_on_container_copy_construction() const { return *this; }
+
+    allocator_backend backend() const noexcept { return backend_; }
+
+    template <typename U>
+    bool operator==(const allocator<U>& rhs) const noexcept {
+        return backend_ == rhs.backend_ && state_ == rhs.state_;
+    }
+
+    template <typename U>
+    bool operator!=(const allocator<U>& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+    template <typename U>
+    friend class allocator;
+
+private:
+    void* allocate_bytes(size_type bytes);
+    void  deallocate_bytes(void* p, size_type bytes);
+
+    allocator_backend backend_;
+    void* state_;
 };
 
+template <typename T>
+void* allocator<T>::allocate_bytes(size_type bytes) {
+    switch (backend_) {
+        case allocator_backend::thread_pool:
+            return static_cast<small_object_allocator*>(state_)->allocate(bytes, alignof(T));
+        case allocator_backend::arena:
+            return static_cast<zephyr::arena*>(state_)->allocate(bytes, alignof(T));
+        default:
+            return pool_allocator::allocate(bytes, alignof(T));
+    }
+}
+
+template <typename T>
+void allocator<T>::deallocate_bytes(void* p, size_type bytes) {
+    switch (backend_) {
+        case allocator_backend::thread_pool:
+            static_cast<small_object_allocator*>(state_)->deallocate(p, bytes, alignof(T));
+            break;
+        case allocator_backend::arena:
+            break;
+        default:
+            pool_allocator::deallocate(p, bytes, alignof(T));
+            break;
+    }
+}
+
 template <typename T>
 T* allocator<T>::allocate() {
-    return static_cast<T*>(pool_allocator::allocate(sizeof(T)));
+    // 单个对象最常见，全局 pool 的尺寸分级在编译期确定
+    if (backend_ == allocator_backend::pool)
+        return static_cast<T*>(pool_allocator::allocate<sizeof(T), alignof(T)>());
+    return static_cast<T*>(allocate_bytes(sizeof(T)));
 }
 
 template <typename T>
 T* allocator<T>::allocate(size_type n) {
     if (n == 0)
         return nullptr;
-    return static_cast<T*>(pool_allocator::allocate(n * sizeof(T)));
+    if (n > max_size())
+        throw std::bad_alloc();
+    if (n == 1)
+        return allocate();
+    return static_cast<T*>(allocate_bytes(n * sizeof(T)));
 }
 
 template <typename T>
 void allocator<T>::deallocate(T* ptr) {
     if (ptr == nullptr)
         return ;
-    pool_allocator::deallocate(p, sizeof(T));
+    if (backend_ == allocator_backend::pool) {
+        pool_allocator::deallocate<sizeof(T), alignof(T)>(ptr);
+        return ;
+    }
+    deallocate_bytes(ptr, sizeof(T));
 }
 
 template <typename T>
 void allocator<T>::deallocate(T* ptr, size_type n) {
     if (ptr == nullptr || n == 0)
         return ;
-    pool_allocator::deallocate(p, n * sizeof(T));
-}
-
-template <typename T>
-void allocator<T>::construct(T* ptr) {
-    zephyr::construct(ptr);
-}
-
-template <typename T>
-void allocator<T>::construct(T* ptr, const T& value) {
-    zephyr::construct(ptr, value);
-}
-
-template <typename T>
-void allocator<T>::construct(T* ptr, T&& value) {
-    zephyr::construct(ptr, std::move(value));
+    if (n == 1) {
+        deallocate(ptr);
+        return ;
+    }
+    deallocate_bytes(ptr, n * sizeof(T));
 }
 
 template <typename T>
-template <typename ...Args>
-void allocator<T>::construct(T* ptr, Args&& ...args) {
-    zephyr::construct(ptr, std::forward<Args>(args)...)
+template <typename U, typename ...Args>
+void allocator<T>::construct(U* ptr, Args&& ...args) {
+    zephyr::construct(ptr, std::forward<Args>(args)...);
 }
 
 template <typename T>
-void allocator<T>::destroy(T* ptr) {
+template <typename U>
+void allocator<T>::destroy(U* ptr) {
     zephyr::destroy(ptr);
 }
 
@@ -103,11 +209,6 @@ void allocator<T>::destroy(T* first, T* last) {
     zephyr::destroy(first, last);
 }
 
-
-
-
-
-
 }
 
 
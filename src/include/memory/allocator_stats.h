@@ -0,0 +1,175 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_ALLOCATOR_STATS_H
+#define ZEPHYR_ALLOCATOR_STATS_H
+
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "pool_allocator.h"
+#include "loki_allocator.h"
+
+// 这个头文件把 pool_stats、fixed_allocator_stats 导出为 JSON 或 Prometheus 文本格式
+// 各尺寸分级的指标在 Prometheus 中以 size 标签区分
+// fixed_allocator_stats 也是 concurrent_fixed_allocator::stats() 与 loki_alloc<T>::stats() 的结果
+
+namespace zephyr
+{
+
+namespace stats_detail
+{
+
+inline void metric(std::ostringstream& out, const std::string& name, const char* type) {
+    out << "# TYPE " << name << ' ' << type << '\n';
+}
+
+inline void sample(std::ostringstream& out, const std::string& name, double value) {
+    out << name << ' ' << value << '\n';
+}
+
+template <typename T>
+inline void sample(std::ostringstream& out, const std::string& name, size_t size, T value) {
+    out << name << "{size=\"" << size << "\"} " << value << '\n';
+}
+
+} // namespace zephyr::stats_detail
+
+inline std::string to_json(const pool_stats& s) {
+    std::ostringstream out;
+    out << "{\"reserved_bytes\":" << s.reserved_bytes
+        << ",\"in_use_bytes\":" << s.in_use_bytes
+        << ",\"free_bytes\":" << s.free_bytes
+        << ",\"released_bytes\":" << s.released_bytes
+        << ",\"live_bytes\":" << s.live_bytes
+        << ",\"reserved_high_water\":" << s.reserved_high_water
+        << ",\"in_use_high_water\":" << s.in_use_high_water
+        << ",\"span_allocations\":" << s.span_allocations
+        << ",\"refills\":" << s.refills
+        << ",\"fragmentation\":" << s.fragmentation
+        << ",\"classes\":[";
+    for (size_t i = 0; i < Z_free_list_size; ++i) {
+        const pool_class_stats& c = s.classes[i];
+        out << (i == 0 ? "" : ",")
+            << "{\"size\":" << c.size
+            << ",\"allocations\":" << c.allocations
+            << ",\"deallocations\":" << c.deallocations
+            << ",\"live\":" << c.live
+            << ",\"refills\":" << c.refills
+            << ",\"cached\":" << c.cached
+            << ",\"cached_high_water\":" << c.cached_high_water << '}';
+    }
+    out << "]}";
+    return out.str();
+}
+
+inline std::string to_prometheus(const pool_stats& s, const std::string& prefix = "zephyr_pool") {
+    using namespace stats_detail;
+    std::ostringstream out;
+    out.precision(17);
+    const char* gauges[] = { "reserved_bytes", "in_use_bytes", "free_bytes", "live_bytes",
+                             "reserved_high_water_bytes", "in_use_high_water_bytes", "fragmentation_ratio" };
+    double gauge_values[] = { double(s.reserved_bytes), double(s.in_use_bytes), double(s.free_bytes),
+                              double(s.live_bytes), double(s.reserved_high_water),
+                              double(s.in_use_high_water), s.fragmentation };
+    for (size_t i = 0; i < sizeof(gauges) / sizeof(gauges[0]); ++i) {
+        metric(out, prefix + "_" + gauges[i], "gauge");
+        sample(out, prefix + "_" + gauges[i], gauge_values[i]);
+    }
+    metric(out, prefix + "_released_bytes_total", "counter");
+    sample(out, prefix + "_released_bytes_total", double(s.released_bytes));
+    metric(out, prefix + "_span_allocations_total", "counter");
+    sample(out, prefix + "_span_allocations_total", double(s.span_allocations));
+
+    metric(out, prefix + "_allocations_total", "counter");
+    for (size_t i = 0; i < Z_free_list_size; ++i)
+        sample(out, prefix + "_allocations_total", s.classes[i].size, s.classes[i].allocations);
+    metric(out, prefix + "_deallocations_total", "counter");
+    for (size_t i = 0; i < Z_free_list_size; ++i)
+        sample(out, prefix + "_deallocations_total", s.classes[i].size, s.classes[i].deallocations);
+    metric(out, prefix + "_refills_total", "counter");
+    for (size_t i = 0; i < Z_free_list_size; ++i)
+        sample(out, prefix + "_refills_total", s.classes[i].size, s.classes[i].refills);
+    metric(out, prefix + "_live_objects", "gauge");
+    for (size_t i = 0; i < Z_free_list_size; ++i)
+        sample(out, prefix + "_live_objects", s.classes[i].size, s.classes[i].live);
+    metric(out, prefix + "_cached_high_water_objects", "gauge");
+    for (size_t i = 0; i < Z_free_list_size; ++i)
+        sample(out, prefix + "_cached_high_water_objects", s.classes[i].size, s.classes[i].cached_high_water);
+    return out.str();
+}
+
+inline std::string to_json(const fixed_allocator_stats& s) {
+    std::ostringstream out;
+    out << "{\"block_size\":" << s.block_size
+        << ",\"chunks\":" << s.chunks
+        << ",\"reserved_bytes\":" << s.reserved_bytes
+        << ",\"in_use_bytes\":" << s.in_use_bytes
+        << ",\"live\":" << s.live
+        << ",\"fragmentation\":" << s.fragmentation
+        << ",\"allocations\":" << s.allocations
+        << ",\"deallocations\":" << s.deallocations
+        << ",\"chunk_allocations\":" << s.chunk_allocations
+        << ",\"high_water\":" << s.high_water << '}';
+    return out.str();
+}
+
+inline std::string to_json(const std::vector<fixed_allocator_stats>& classes) {
+    std::string out = "[";
+    for (size_t i = 0; i < classes.size(); ++i)
+        out += (i == 0 ? "" : ",") + to_json(classes[i]);
+    return out + "]";
+}
+
+// 一组 fixed_allocator（例如 small_object_allocator::stats() 的结果），以 size 标签区分
+inline std::string to_prometheus(const std::vector<fixed_allocator_stats>& classes,
+                                 const std::string& prefix = "zephyr_fixed") {
+    using namespace stats_detail;
+    std::ostringstream out;
+    out.precision(17);
+    struct field {
+        const char* name;
+        const char* type;
+        double (*get)(const fixed_allocator_stats&);
+    };
+    static const field fields[] = {
+        { "chunks", "gauge", [](const fixed_allocator_stats& s) { return double(s.chunks); } },
+        { "reserved_bytes", "gauge", [](const fixed_allocator_stats& s) { return double(s.reserved_bytes); } },
+        { "in_use_bytes", "gauge", [](const fixed_allocator_stats& s) { return double(s.in_use_bytes); } },
+        { "live_objects", "gauge", [](const fixed_allocator_stats& s) { return double(s.live); } },
+        { "high_water_objects", "gauge", [](const fixed_allocator_stats& s) { return double(s.high_water); } },
+        { "fragmentation_ratio", "gauge", [](const fixed_allocator_stats& s) { return s.fragmentation; } },
+        { "allocations_total", "counter", [](const fixed_allocator_stats& s) { return double(s.allocations); } },
+        { "deallocations_total", "counter", [](const fixed_allocator_stats& s) { return double(s.deallocations); } },
+        { "chunk_allocations_total", "counter", [](const fixed_allocator_stats& s) { return double(s.chunk_allocations); } },
+    };
+    for (const field& f : fields) {
+        metric(out, prefix + "_" + f.name, f.type);
+        for (const fixed_allocator_stats& s : classes)
+            sample(out, prefix + "_" + f.name, s.block_size, f.get(s));
+    }
+    return out.str();
+}
+
+inline std::string to_prometheus(const fixed_allocator_stats& s, const std::string& prefix = "zephyr_fixed") {
+    return to_prometheus(std::vector<fixed_allocator_stats>(1, s), prefix);
+}
+
+// 默认的 loki_alloc 路径：所有 concurrent_fixed_allocator 实例的 heap 汇总，前缀与 fixed_allocator 区分
+template <size_t Block_size, size_t Chunk_bytes>
+inline std::string to_prometheus(const concurrent_fixed_allocator<Block_size, Chunk_bytes>&,
+                                 const std::string& prefix = "zephyr_loki") {
+    return to_prometheus(concurrent_fixed_allocator<Block_size, Chunk_bytes>::stats(), prefix);
+}
+
+template <size_t Block_size, size_t Chunk_bytes>
+inline std::string to_json(const concurrent_fixed_allocator<Block_size, Chunk_bytes>&) {
+    return to_json(concurrent_fixed_allocator<Block_size, Chunk_bytes>::stats());
+}
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_ALLOCATOR_STATS_H
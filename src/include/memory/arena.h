@@ -0,0 +1,238 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_ARENA_H
+#define ZEPHYR_ARENA_H
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pool_allocator.h"
+#include "page_source.h"
+
+// 这个头文件包含单调分配的 arena 以及配套的 arena_scope、arena_alloc<T>
+//
+// arena 只移动指针来分配，单个对象不能释放，所有对象一起被 rewind / reset / release 回收
+// 内存块是从 pool_allocator 取得的整个 span，超过一个 span 的请求直接向 page_source 申请
+// 可以给 arena 一块初始缓冲区（例如栈上的数组），用完之后才会去申请 span
+
+namespace zephyr
+{
+
+class arena {
+
+    // 每个内存块开头的信息，块之间用 prev 串成链表，最新的块在链表头
+    struct block {
+        block* prev;
+        char* end;
+        size_t bytes;
+    };
+
+    enum { block_header = (sizeof(block) + 15) & ~15 };
+
+public:
+    // 回到 mark 时的状态，只能按后进先出的顺序 rewind
+    struct checkpoint {
+        block* current;
+        char* cursor;
+    };
+
+    arena()
+        : buffer_(nullptr), buffer_end_(nullptr),
+          current_(nullptr), first_(nullptr), spare_(nullptr),
+          cursor_(nullptr), limit_(nullptr)
+    {}
+
+    arena(void* buffer, size_t size)
+        : buffer_(static_cast<char*>(buffer)), buffer_end_(static_cast<char*>(buffer) + size),
+          current_(nullptr), first_(nullptr), spare_(nullptr),
+          cursor_(buffer_), limit_(buffer_end_)
+    {}
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    ~arena() { release(); }
+
+    void* allocate(size_t bytes, size_t align = alignof(max_align_t)) {
+        char* p = align_up(cursor_, align);
+        if (p == nullptr || p > limit_ || static_cast<size_t>(limit_ - p) < bytes)
+            return allocate_slow(bytes, align);
+        cursor_ = p + bytes;
+        return p;
+    }
+
+    // 单个对象不回收
+    void deallocate(void*, size_t) {}
+
+    checkpoint mark() const {
+        checkpoint cp = { current_, cursor_ };
+        return cp;
+    }
+
+    // mark 之后取得的块放到备用链表上留给后面复用
+    void rewind(const checkpoint& cp) {
+        while (current_ != cp.current) {
+            block* b = current_;
+            current_ = b->prev;
+            b->prev = spare_;
+            spare_ = b;
+        }
+        if (current_ == nullptr) {
+            first_ = nullptr;
+            limit_ = buffer_end_;
+        }
+        else {
+            limit_ = current_->end;
+        }
+        cursor_ = cp.cursor;
+    }
+
+    // O(1)：整条块链表接到备用链表上，不逐个访问对象，也不逐个访问块
+    void reset() {
+        if (current_ != nullptr) {
+            first_->prev = spare_;
+            spare_ = current_;
+            current_ = first_ = nullptr;
+        }
+        cursor_ = buffer_;
+        limit_ = buffer_end_;
+    }
+
+    // 所有块还给 pool_allocator / page_source，初始缓冲区除外
+    void release() {
+        reset();
+        while (spare_ != nullptr) {
+            block* b = spare_;
+            spare_ = b->prev;
+            free_block(b);
+        }
+    }
+
+    // 初始缓冲区与正在使用的块的总字节数，不含备用链表上的块
+    size_t bytes_reserved() const {
+        size_t n = static_cast<size_t>(buffer_end_ - buffer_);
+        for (block* b = current_; b != nullptr; b = b->prev)
+            n += b->bytes;
+        return n;
+    }
+
+private:
+    static char* align_up(char* p, size_t align) {
+        return reinterpret_cast<char*>(
+                (reinterpret_cast<uintptr_t>(p) + align - 1) & ~(uintptr_t)(align - 1));
+    }
+
+    void* allocate_slow(size_t bytes, size_t align) {
+        size_t need = block_header + bytes + align;
+        block* b = nullptr;
+        if (spare_ != nullptr && spare_->bytes >= need) {
+            b = spare_;
+            spare_ = b->prev;
+        }
+        else {
+            b = new_block(need);
+        }
+        b->prev = current_;
+        if (current_ == nullptr)
+            first_ = b;
+        current_ = b;
+        limit_ = b->end;
+        char* p = align_up(reinterpret_cast<char*>(b) + block_header, align);
+        cursor_ = p + bytes;
+        return p;
+    }
+
+    static block* new_block(size_t need) {
+        void* mem = nullptr;
+        size_t bytes = Z_span_bytes;
+        if (need <= bytes) {
+            mem = pool_allocator::allocate_span();
+        }
+        else {
+            bytes = (need + Z_page_bytes - 1) & ~(size_t)(Z_page_bytes - 1);
+            mem = current_page_source().map(bytes, Z_page_bytes);
+        }
+        block* b = static_cast<block*>(mem);
+        b->bytes = bytes;
+        b->end = static_cast<char*>(mem) + bytes;
+        return b;
+    }
+
+    static void free_block(block* b) {
+        if (b->bytes == static_cast<size_t>(Z_span_bytes))
+            pool_allocator::deallocate_span(b);
+        else
+            current_page_source().unmap(b, b->bytes);
+    }
+
+    char* buffer_;
+    char* buffer_end_;
+    block* current_;
+    block* first_;
+    block* spare_;
+    char* cursor_;
+    char* limit_;
+};
+
+// 作用域结束时 arena 回到构造时的状态
+class arena_scope {
+
+public:
+    explicit arena_scope(arena& a) : arena_(a), checkpoint_(a.mark()) {}
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+
+    ~arena_scope() { arena_.rewind(checkpoint_); }
+
+private:
+    arena& arena_;
+    arena::checkpoint checkpoint_;
+};
+
+// 满足 C++11 Allocator 要求的适配器，可以直接用于标准容器
+// deallocate 什么也不做，内存随 arena 一起回收
+template <typename T>
+class arena_alloc {
+
+public:
+    typedef T value_type;
+
+    explicit arena_alloc(arena& a) noexcept : arena_(&a) {}
+
+    template <typename U>
+    arena_alloc(const arena_alloc<U>& other) noexcept : arena_(other.arena_) {}
+
+    template <typename U>
+    struct rebind {
+        typedef arena_alloc<U> other;
+    };
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    arena& resource() const noexcept { return *arena_; }
+
+    template <typename U>
+    friend class arena_alloc;
+
+    template <typename U>
+    bool operator==(const arena_alloc<U>& rhs) const noexcept { return arena_ == rhs.arena_; }
+
+    template <typename U>
+    bool operator!=(const arena_alloc<U>& rhs) const noexcept { return arena_ != rhs.arena_; }
+
+private:
+    arena* arena_;
+};
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_ARENA_H
@@ -8,9 +8,17 @@
 // 该头文件包含两个函数 construct, destroy
 // construct: 负责对象的构造
 // destroy: 负责对象的析构
+//
+// 以及未初始化内存上的区间算法 uninitialized_copy / move / fill / value_construct 与 relocate：
+// 源、目标都是指针并且元素可以按字节复制时，在编译期选择 memcpy / memset；
+// 其余情况逐个构造，某个构造抛出异常时析构已经构造好的元素再重新抛出，目标区间回到未初始化的状态
 
+#include <new>
 #include <utility>      // std::forward
 #include <iterator>
+#include <memory>       // std::addressof
+#include <type_traits>
+#include <string.h>
 
 namespace zephyr
 {
@@ -60,6 +68,264 @@ void destroy(ForwardIter first, ForwardIter last) {
             typename std::iterator_traits<ForwardIter>::value_type>{});
 }
 
+// 把对象的字节搬到别处、不调用移动构造与析构，仍然得到一个等价的对象
+// 可以按字节复制的类型都满足；内部只有指向堆的指针、没有指向自身的指针的类型
+// （例如持有 std::unique_ptr 的类）也满足，可以特化为 std::true_type
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// std::pair 的赋值运算符不是平凡的，但两个成员都可以平凡重定位时整个 pair 也可以
+template <typename T1, typename T2>
+struct is_trivially_relocatable<std::pair<T1, T2>>
+    : std::integral_constant<bool, is_trivially_relocatable<typename std::remove_const<T1>::type>::value
+                                   && is_trivially_relocatable<typename std::remove_const<T2>::type>::value> {};
+
+namespace construct_detail
+{
+
+// 源与目标都是指向同一种类型的指针（源可以带 const），并且 Trait 对这个类型成立
+template <typename InputIter, typename ForwardIter, template <typename> class Trait>
+struct pointer_fast_path : std::false_type {};
+
+template <typename T, typename U, template <typename> class Trait>
+struct pointer_fast_path<T*, U*, Trait>
+    : std::integral_constant<bool, std::is_same<typename std::remove_const<T>::type, U>::value
+                                   && std::is_trivially_copyable<U>::value
+                                   && Trait<U>::value> {};
+
+template <typename T>
+struct copy_trait : std::is_trivially_copy_constructible<T> {};
+
+template <typename T>
+struct move_trait : std::is_trivially_move_constructible<T> {};
+
+template <typename T>
+struct relocate_trait : is_trivially_relocatable<T> {};
+
+// 值初始化等于全零字节的类型；成员指针的空值不是全零，不在其中
+template <typename T>
+struct zero_value : std::integral_constant<bool, std::is_arithmetic<T>::value
+                                                 || std::is_pointer<T>::value
+                                                 || std::is_enum<T>::value> {};
+
+template <typename T>
+T* copy_bytes(const T* first, const T* last, T* result) {
+    size_t n = static_cast<size_t>(last - first);
+    if (n != 0)
+        memcpy(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+    return result + n;
+}
+
+// value 的每个字节都相同时（例如 0、-1、单字节类型）可以用 memset 填充
+template <typename T>
+bool same_bytes(const T& value, unsigned char& byte) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(std::addressof(value));
+    byte = p[0];
+    for (size_t i = 1; i < sizeof(T); ++i)
+        if (p[i] != byte)
+            return false;
+    return true;
+}
+
+} // namespace zephyr::construct_detail
+
+// ---------------------------------------------------------------------------
+// uninitialized_copy
+// ---------------------------------------------------------------------------
+
+template <typename InputIter, typename ForwardIter>
+ForwardIter uninitialized_copy_cat(InputIter first, InputIter last, ForwardIter result, std::true_type) {
+    return construct_detail::copy_bytes(first, last, result);
+}
+
+template <typename InputIter, typename ForwardIter>
+ForwardIter uninitialized_copy_cat(InputIter first, InputIter last, ForwardIter result, std::false_type) {
+    typedef typename std::iterator_traits<ForwardIter>::value_type value_type;
+    ForwardIter cur = result;
+    try {
+        for (; first != last; ++first, ++cur)
+            ::new (static_cast<void*>(std::addressof(*cur))) value_type(*first);
+    }
+    catch (...) {
+        zephyr::destroy(result, cur);
+        throw;
+    }
+    return cur;
+}
+
+// 把 [first, last) 复制构造到从 result 开始的未初始化内存，返回目标区间的末尾
+template <typename InputIter, typename ForwardIter>
+ForwardIter uninitialized_copy(InputIter first, InputIter last, ForwardIter result) {
+    return uninitialized_copy_cat(first, last, result,
+            construct_detail::pointer_fast_path<InputIter, ForwardIter, construct_detail::copy_trait>{});
+}
+
+// ---------------------------------------------------------------------------
+// uninitialized_move
+// ---------------------------------------------------------------------------
+
+template <typename InputIter, typename ForwardIter>
+ForwardIter uninitialized_move_cat(InputIter first, InputIter last, ForwardIter result, std::true_type) {
+    return construct_detail::copy_bytes(first, last, result);
+}
+
+template <typename InputIter, typename ForwardIter>
+ForwardIter uninitialized_move_cat(InputIter first, InputIter last, ForwardIter result, std::false_type) {
+    typedef typename std::iterator_traits<ForwardIter>::value_type value_type;
+    ForwardIter cur = result;
+    try {
+        for (; first != last; ++first, ++cur)
+            ::new (static_cast<void*>(std::addressof(*cur))) value_type(std::move(*first));
+    }
+    catch (...) {
+        zephyr::destroy(result, cur);
+        throw;
+    }
+    return cur;
+}
+
+// 把 [first, last) 移动构造到从 result 开始的未初始化内存；源区间中的对象仍然存在，处于被移动后的状态
+// 移动构造抛出异常时已经被移走的源对象不会复原，需要强异常保证时使用 relocate
+template <typename InputIter, typename ForwardIter>
+ForwardIter uninitialized_move(InputIter first, InputIter last, ForwardIter result) {
+    return uninitialized_move_cat(first, last, result,
+            construct_detail::pointer_fast_path<InputIter, ForwardIter, construct_detail::move_trait>{});
+}
+
+// ---------------------------------------------------------------------------
+// uninitialized_fill
+// ---------------------------------------------------------------------------
+
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter uninitialized_fill_n_cat(ForwardIter first, Size n, const T& value, std::false_type) {
+    typedef typename std::iterator_traits<ForwardIter>::value_type value_type;
+    ForwardIter cur = first;
+    try {
+        for (; n > 0; --n, ++cur)
+            ::new (static_cast<void*>(std::addressof(*cur))) value_type(value);
+    }
+    catch (...) {
+        zephyr::destroy(first, cur);
+        throw;
+    }
+    return cur;
+}
+
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter uninitialized_fill_n_cat(ForwardIter first, Size n, const T& value, std::true_type) {
+    unsigned char byte;
+    if (n <= 0)
+        return first;
+    if (construct_detail::same_bytes(value, byte)) {
+        memset(static_cast<void*>(first), byte, static_cast<size_t>(n) * sizeof(T));
+        return first + n;
+    }
+    // 可以按字节复制的对象直接逐个写入，不需要回滚，循环可以被向量化
+    ForwardIter last = first + n;
+    for (ForwardIter cur = first; cur != last; ++cur)
+        memcpy(static_cast<void*>(cur), std::addressof(value), sizeof(T));
+    return last;
+}
+
+// 在从 first 开始的 n 个未初始化的位置上复制构造 value，返回末尾
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter uninitialized_fill_n(ForwardIter first, Size n, const T& value) {
+    typedef typename std::iterator_traits<ForwardIter>::value_type value_type;
+    return uninitialized_fill_n_cat(first, n, value, std::integral_constant<bool,
+            std::is_pointer<ForwardIter>::value && std::is_same<T, value_type>::value
+            && std::is_trivially_copyable<value_type>::value
+            && std::is_trivially_copy_constructible<value_type>::value>{});
+}
+
+template <typename ForwardIter, typename T>
+void uninitialized_fill(ForwardIter first, ForwardIter last, const T& value) {
+    zephyr::uninitialized_fill_n(first, std::distance(first, last), value);
+}
+
+// ---------------------------------------------------------------------------
+// uninitialized_value_construct
+// ---------------------------------------------------------------------------
+
+template <typename ForwardIter, typename Size>
+ForwardIter uninitialized_value_construct_n_cat(ForwardIter first, Size n, std::true_type) {
+    typedef typename std::iterator_traits<ForwardIter>::value_type value_type;
+    if (n > 0)
+        memset(static_cast<void*>(first), 0, static_cast<size_t>(n) * sizeof(value_type));
+    return first + (n > 0 ? n : 0);
+}
+
+template <typename ForwardIter, typename Size>
+ForwardIter uninitialized_value_construct_n_cat(ForwardIter first, Size n, std::false_type) {
+    typedef typename std::iterator_traits<ForwardIter>::value_type value_type;
+    ForwardIter cur = first;
+    try {
+        for (; n > 0; --n, ++cur)
+            ::new (static_cast<void*>(std::addressof(*cur))) value_type();
+    }
+    catch (...) {
+        zephyr::destroy(first, cur);
+        throw;
+    }
+    return cur;
+}
+
+// 在从 first 开始的 n 个未初始化的位置上值初始化（T()），返回末尾
+template <typename ForwardIter, typename Size>
+ForwardIter uninitialized_value_construct_n(ForwardIter first, Size n) {
+    typedef typename std::iterator_traits<ForwardIter>::value_type value_type;
+    return uninitialized_value_construct_n_cat(first, n, std::integral_constant<bool,
+            std::is_pointer<ForwardIter>::value && construct_detail::zero_value<value_type>::value>{});
+}
+
+template <typename ForwardIter>
+void uninitialized_value_construct(ForwardIter first, ForwardIter last) {
+    zephyr::uninitialized_value_construct_n(first, std::distance(first, last));
+}
+
+// ---------------------------------------------------------------------------
+// relocate
+// ---------------------------------------------------------------------------
+
+template <typename T>
+T* relocate_cat(T* first, T* last, T* result, std::true_type) {
+    size_t n = static_cast<size_t>(last - first);
+    if (n != 0)
+        memmove(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+    return result + n;
+}
+
+// 移动不会抛出（或者只能移动）：一趟完成，每个元素移动以后立刻析构
+template <typename T>
+T* relocate_move(T* first, T* last, T* result, std::true_type) {
+    T* cur = result;
+    for (; first != last; ++first, ++cur) {
+        ::new (static_cast<void*>(cur)) T(std::move(*first));
+        first->~T();
+    }
+    return cur;
+}
+
+// 移动可能抛出：先复制，全部成功以后才析构源区间，失败时源区间保持原样
+template <typename T>
+T* relocate_move(T* first, T* last, T* result, std::false_type) {
+    T* end = zephyr::uninitialized_copy(const_cast<const T*>(first), const_cast<const T*>(last), result);
+    zephyr::destroy(first, last);
+    return end;
+}
+
+template <typename T>
+T* relocate_cat(T* first, T* last, T* result, std::false_type) {
+    return relocate_move(first, last, result, std::integral_constant<bool,
+            std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value>{});
+}
+
+// 把 [first, last) 中的对象搬到从 result 开始的未初始化内存，源区间变为未初始化，返回目标区间的末尾
+// 可以平凡重定位的类型整段 memmove，区间可以重叠；其余类型逐个移动并析构，区间重叠时要求 result <= first
+// 移动构造可能抛出、又可以复制的类型先复制再析构源区间，提供强异常保证，此时区间不能重叠
+template <typename T>
+T* relocate(T* first, T* last, T* result) {
+    return relocate_cat(first, last, result, std::integral_constant<bool, is_trivially_relocatable<T>::value>{});
+}
 
 }
 
@@ -0,0 +1,437 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_GLOBAL_ALLOCATOR_H
+#define ZEPHYR_GLOBAL_ALLOCATOR_H
+
+#include <new>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+
+#include <sys/mman.h>
+
+#include "pool_allocator.h"
+#include "page_source.h"
+#include "span_map.h"
+#include "alloc_hooks.h"
+
+// 这个头文件包含 global_allocator：malloc / free 语义的分配器，src/malloc/zephyr_malloc.cpp 用它替换
+// 全局的 operator new / delete 与 malloc 一族
+//
+// 不超过 Z_max_bytes 的请求交给 pool_allocator 的尺寸分级，按 16 字节对齐（8 字节以内按 8 字节）；
+// 更大的请求直接 mmap，映射起点按 Z_span_bytes 对齐，头部记录映射的范围，realloc 时用 mremap 扩张
+// 不超过 large_cache_max 的大块映射按分级取整，释放后留在缓存中给同一分级的下一次请求，
+// 32 KiB ~ 1 MiB 的 malloc / free 在稳定状态下不进入内核；缓存总量不超过 large_cache_bytes，trim 可以全部归还
+// 释放时不需要大小：由 span_map 判断指针属于 pool 的 span、某个大块，还是都不是。都不是的指针
+// （例如替换生效之前由 libc 分配的）交还 libc
+//
+// 线程安全性与 pool_allocator 相同。失败时返回 nullptr 并设置 errno，不抛出异常
+
+#if defined(__GLIBC__)
+extern "C" {
+void  __libc_free(void* p);
+void* __libc_realloc(void* p, size_t n);
+}
+#endif
+
+namespace zephyr
+{
+
+class global_allocator {
+
+public:
+    // malloc 保证的对齐
+    enum { min_align = 16 };
+
+    static void* allocate(size_t n) noexcept;
+    static void* allocate_zeroed(size_t count, size_t size) noexcept;
+    // align 必须是 2 的幂
+    static void* allocate_aligned(size_t align, size_t n) noexcept;
+    static void* reallocate(void* p, size_t n) noexcept;
+    static void  deallocate(void* p) noexcept;
+
+    // p 实际可用的字节数；不是 global_allocator 分配的指针返回 0
+    static size_t usable_size(const void* p) noexcept;
+
+    static bool owns(const void* p) noexcept {
+        return p != nullptr && kind_of(p) != span_kind::none;
+    }
+
+    // 把缓存的大块映射全部解除，返回解除映射的字节数
+    static size_t trim() noexcept;
+
+    // 映射不超过 large_cache_max 字节的大块释放后缓存起来；缓存的总字节数不超过 large_cache_bytes
+    enum { large_cache_max = 1 << 20 };
+    enum { large_cache_bytes = 32 << 20 };
+
+private:
+    // 大块的头部，位于 p - 1 所在的 span_map 单元的起点
+    struct large_block {
+        char*  base;        // 映射的起点
+        size_t mapped;      // 映射的字节数
+        char*  user;        // 交给用户的地址；单元中未被映射的部分可能被别人映射，以此区分
+        large_block* next;  // 在缓存中时指向同一分级的下一个
+    };
+
+    enum { large_header = 64 };
+
+    // 可缓存的映射按每个 2 的幂 4 个分级取整，第一组是 (32 KiB, 64 KiB]，最后一个分级是 1 MiB
+    enum { large_class_per_pow2 = 4 };
+    enum { large_min_shift = 15 };
+    enum { large_classes = (20 - large_min_shift) * large_class_per_pow2 };
+
+    static_assert((1 << (large_min_shift + 1)) >= Z_max_bytes + Z_page_bytes, "first large class too small");
+    static_assert(large_cache_max == 1 << (large_min_shift + large_classes / large_class_per_pow2),
+                  "large classes must end at large_cache_max");
+
+    // 释放后缓存的大块，每个分级一个链表；映射保留，span_map 中仍标记为 large，头部的 user 为 nullptr
+    struct large_cache {
+        spin_lock lock;
+        large_block* lists[large_classes] = {};
+        size_t bytes = 0;
+    };
+
+    static large_cache& cache() {
+        static large_cache c;
+        return c;
+    }
+
+    // pool 的块至少在 span 起点之后 Z_span_header 字节，大块也在头部之后，所以看 p - 1 所在的单元
+    static span_kind kind_of(const void* p) {
+        span_kind kind = span_map::get(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(p) - 1));
+        if (kind == span_kind::large && header_of(p)->user != p)
+            return span_kind::none;
+        return kind;
+    }
+
+    static large_block* header_of(const void* p) {
+        return reinterpret_cast<large_block*>(
+                (reinterpret_cast<uintptr_t>(p) - 1) & ~(uintptr_t)(Z_span_bytes - 1));
+    }
+
+    static size_t page_round(size_t bytes) {
+        return (bytes + Z_page_bytes - 1) & ~(size_t)(Z_page_bytes - 1);
+    }
+
+    // mapped 是大于 32 KiB 的页整数倍，返回能容纳它的第一个分级
+    static size_t large_class(size_t mapped) {
+        int shift = bsr(mapped - 1);
+        return static_cast<size_t>(shift - large_min_shift) * large_class_per_pow2
+               + (((mapped - 1) >> (shift - 2)) & (large_class_per_pow2 - 1));
+    }
+
+    static size_t large_class_size(size_t index) {
+        size_t pow2 = size_t(1) << (large_min_shift + index / large_class_per_pow2);
+        return pow2 + (index % large_class_per_pow2 + 1) * (pow2 / large_class_per_pow2);
+    }
+
+    // 默认对齐的大块映射的字节数：不超过 large_cache_max 时取整到分级，否则按页取整
+    static size_t large_mapping(size_t bytes) {
+        size_t mapped = page_round(bytes);
+        return mapped > static_cast<size_t>(large_cache_max) ? mapped : large_class_size(large_class(mapped));
+    }
+
+    static void* pool_allocate(size_t n, size_t align) noexcept;
+    static void* large_allocate(size_t n, size_t align, bool zero = false) noexcept;
+    static char* large_cache_take(size_t mapped) noexcept;
+    static bool  large_cache_put(large_block* h) noexcept;
+    static void* large_reallocate(void* p, size_t n) noexcept;
+    static void  large_deallocate(void* p) noexcept;
+    static void  foreign_deallocate(void* p) noexcept;
+    static void  prepare() noexcept;
+};
+
+// heap 来源用 posix_memalign 取 span，malloc 被替换后会递归回到这里，换成 mmap
+inline void global_allocator::prepare() noexcept {
+    static std::atomic<bool> ready(false);
+    if (ready.load(std::memory_order_acquire))
+        return ;
+    if (page_sources::slot::instance().source.load(std::memory_order_acquire) == &page_sources::heap)
+        set_page_source(page_sources::mmap);
+    ready.store(true, std::memory_order_release);
+}
+
+inline void* global_allocator::pool_allocate(size_t n, size_t align) noexcept {
+    prepare();
+    try {
+        return pool_allocator::allocate(n, align);
+    }
+    catch (const std::bad_alloc&) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+}
+
+inline void* global_allocator::allocate(size_t n) noexcept {
+    if (n <= static_cast<size_t>(Z_max_bytes))
+        return pool_allocate(n, n <= static_cast<size_t>(Z_align) ? static_cast<size_t>(Z_align) : static_cast<size_t>(min_align));
+    return large_allocate(n, min_align);
+}
+
+inline void* global_allocator::allocate_zeroed(size_t count, size_t size) noexcept {
+    if (size != 0 && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    size_t n = count * size;
+    // 新映射的大块本来就是 0，只有从缓存取出的大块需要清零
+    if (n > static_cast<size_t>(Z_max_bytes))
+        return large_allocate(n, min_align, true);
+    void* p = allocate(n);
+    if (p != nullptr)
+        memset(p, 0, n);
+    return p;
+}
+
+inline void* global_allocator::allocate_aligned(size_t align, size_t n) noexcept {
+    if (align <= static_cast<size_t>(min_align))
+        return allocate(n);
+    if (pool_allocator::Z_pooled(n, align))
+        return pool_allocate(n, align);
+    return large_allocate(n, align);
+}
+
+inline void global_allocator::deallocate(void* p) noexcept {
+    if (p == nullptr)
+        return ;
+    switch (kind_of(p)) {
+        case span_kind::pool:
+            pool_allocator::deallocate(p, pool_allocator::block_size(p));
+            break;
+        case span_kind::large:
+            large_deallocate(p);
+            break;
+        default:
+            foreign_deallocate(p);
+            break;
+    }
+}
+
+inline size_t global_allocator::usable_size(const void* p) noexcept {
+    if (p == nullptr)
+        return 0;
+    switch (kind_of(p)) {
+        case span_kind::pool:
+            return pool_allocator::block_size(p);
+        case span_kind::large: {
+            large_block* h = header_of(p);
+            return static_cast<size_t>(h->base + h->mapped - static_cast<const char*>(p));
+        }
+        default:
+            return 0;
+    }
+}
+
+// 与 glibc 相同：n 为 0 时释放 p 并返回 nullptr
+inline void* global_allocator::reallocate(void* p, size_t n) noexcept {
+    if (p == nullptr)
+        return allocate(n);
+    if (n == 0) {
+        deallocate(p);
+        return nullptr;
+    }
+    size_t old = 0;
+    switch (kind_of(p)) {
+        case span_kind::pool:
+            old = pool_allocator::block_size(p);
+            // 缩小不到一半时留在原来的块里
+            if (n <= old && n > old / 2) {
+                trace_deallocate(trace_source::pool, p, old);
+                trace_allocate(trace_source::pool, p, n);
+                return p;
+            }
+            break;
+        case span_kind::large:
+            if (n > static_cast<size_t>(Z_max_bytes)) {
+                trace_deallocate(trace_source::global, p, usable_size(p));
+                void* q = large_reallocate(p, n);
+                trace_allocate(trace_source::global, q != nullptr ? q : p, q != nullptr ? n : usable_size(p));
+                if (q != nullptr)
+                    return q;
+            }
+            old = usable_size(p);
+            break;
+        default:
+#if defined(__GLIBC__)
+            return __libc_realloc(p, n);
+#else
+            errno = ENOMEM;
+            return nullptr;
+#endif
+    }
+    void* q = allocate(n);
+    if (q == nullptr)
+        return nullptr;
+    memcpy(q, p, old < n ? old : n);
+    deallocate(p);
+    return q;
+}
+
+// 映射起点按 max(Z_span_bytes, align) 对齐。align 不超过 Z_span_bytes 时头部在映射起点，
+// p 在其后 max(large_header, align) 字节；否则 p 在映射起点之后 align 字节，头部在 p 之前的那个单元
+// 默认对齐（p 紧跟在头部之后）的大块先从缓存中找同一分级的映射
+inline void* global_allocator::large_allocate(size_t n, size_t align, bool zero) noexcept {
+    const size_t span_bytes = static_cast<size_t>(Z_span_bytes);
+    size_t head = align > static_cast<size_t>(large_header) ? align : static_cast<size_t>(large_header);
+    if (n > SIZE_MAX - head - Z_page_bytes) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    bool cacheable = head == static_cast<size_t>(large_header);
+    size_t mapped = cacheable ? large_mapping(head + n) : page_round(head + n);
+    char* base = cacheable ? large_cache_take(mapped) : nullptr;
+    if (base != nullptr) {
+        if (zero)
+            memset(base + head, 0, n);
+        char* p = base + head;
+        header_of(p)->user = p;
+        trace_allocate(trace_source::global, p, n);
+        return p;
+    }
+    try {
+        base = static_cast<char*>(page_sources::mmap_aligned(mapped, align > span_bytes ? align : span_bytes));
+    }
+    catch (const std::bad_alloc&) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    char* p = base + head;
+    large_block* h = header_of(p);
+    h->base = base;
+    h->mapped = mapped;
+    h->user = p;
+    h->next = nullptr;
+    span_map::set(h, span_kind::large);
+    trace_allocate(trace_source::global, p, n);
+    return p;
+}
+
+inline void global_allocator::large_deallocate(void* p) noexcept {
+    trace_deallocate(trace_source::global, p, usable_size(p));
+    large_block* h = header_of(p);
+    h->user = nullptr;
+    if (large_cache_put(h))
+        return ;
+    char* base = h->base;
+    size_t mapped = h->mapped;
+    span_map::set(h, span_kind::none);
+    ::munmap(base, mapped);
+}
+
+// 取出一个映射字节数恰好为 mapped 的缓存大块，没有时返回 nullptr
+inline char* global_allocator::large_cache_take(size_t mapped) noexcept {
+    if (mapped > static_cast<size_t>(large_cache_max))
+        return nullptr;
+    large_cache& c = cache();
+    size_t index = large_class(mapped);
+    std::lock_guard<spin_lock> guard(c.lock);
+    large_block* h = c.lists[index];
+    if (h == nullptr)
+        return nullptr;
+    c.lists[index] = h->next;
+    c.bytes -= h->mapped;
+    return h->base;
+}
+
+// 只缓存映射起点就是头部、映射字节数恰好是某个分级的大块；缓存已满时返回 false，由调用者解除映射
+inline bool global_allocator::large_cache_put(large_block* h) noexcept {
+    size_t mapped = h->mapped;
+    if (h->base != reinterpret_cast<char*>(h) || mapped <= (size_t(1) << large_min_shift)
+        || mapped > static_cast<size_t>(large_cache_max) || large_class_size(large_class(mapped)) != mapped)
+        return false;
+    large_cache& c = cache();
+    std::lock_guard<spin_lock> guard(c.lock);
+    if (c.bytes + mapped > static_cast<size_t>(large_cache_bytes))
+        return false;
+    size_t index = large_class(mapped);
+    h->next = c.lists[index];
+    c.lists[index] = h;
+    c.bytes += mapped;
+    return true;
+}
+
+inline size_t global_allocator::trim() noexcept {
+    large_block* lists[large_classes];
+    large_cache& c = cache();
+    {
+        std::lock_guard<spin_lock> guard(c.lock);
+        for (size_t i = 0; i < static_cast<size_t>(large_classes); i++) {
+            lists[i] = c.lists[i];
+            c.lists[i] = nullptr;
+        }
+        c.bytes = 0;
+    }
+    size_t released = 0;
+    for (size_t i = 0; i < static_cast<size_t>(large_classes); i++) {
+        for (large_block* h = lists[i]; h != nullptr; ) {
+            large_block* next = h->next;
+            char* base = h->base;
+            size_t mapped = h->mapped;
+            span_map::set(h, span_kind::none);
+            ::munmap(base, mapped);
+            released += mapped;
+            h = next;
+        }
+    }
+    return released;
+}
+
+// 只处理默认对齐的大块：先原地扩张或收缩；原地不够时先预留一段对齐的地址，
+// 再用 MREMAP_FIXED 把页表搬过去，数据不复制。失败时返回 nullptr，由调用者复制
+inline void* global_allocator::large_reallocate(void* p, size_t n) noexcept {
+#if defined(MREMAP_MAYMOVE) && defined(MREMAP_FIXED)
+    large_block* h = header_of(p);
+    if (h->base != reinterpret_cast<char*>(h) || static_cast<char*>(p) != h->base + large_header)
+        return nullptr;
+    size_t mapped = large_mapping(static_cast<size_t>(large_header) + n);
+    if (mapped == h->mapped)
+        return p;
+    if (::mremap(h->base, h->mapped, mapped, 0) != MAP_FAILED) {
+        h->mapped = mapped;
+        return p;
+    }
+    char* target = nullptr;
+    try {
+        target = static_cast<char*>(page_sources::mmap_aligned(mapped, Z_span_bytes));
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+    // 旧地址一旦解除映射就可能被其他线程拿去做 span，必须在搬移之前清除标记
+    span_map::set(h, span_kind::none);
+    void* moved = ::mremap(h->base, h->mapped, mapped, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (moved == MAP_FAILED) {
+        span_map::set(h, span_kind::large);
+        ::munmap(target, mapped);
+        return nullptr;
+    }
+    large_block* moved_header = reinterpret_cast<large_block*>(target);
+    moved_header->base = target;
+    moved_header->mapped = mapped;
+    moved_header->user = target + large_header;
+    moved_header->next = nullptr;
+    span_map::set(target, span_kind::large);
+    return moved_header->user;
+#else
+    (void)p, (void)n;
+    return nullptr;
+#endif
+}
+
+inline void global_allocator::foreign_deallocate(void* p) noexcept {
+#if defined(__GLIBC__)
+    __libc_free(p);
+#else
+    (void)p;
+#endif
+}
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_GLOBAL_ALLOCATOR_H
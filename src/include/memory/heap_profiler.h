@@ -0,0 +1,455 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#ifndef ZEPHYR_HEAP_PROFILER_H
+#define ZEPHYR_HEAP_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <cxxabi.h>
+#include <sys/mman.h>
+
+#include "../util/spin_lock.h"
+
+// 这个头文件包含 heap_profiler：按字节采样的堆分析器，回答“常驻的内存是哪条调用路径分配的”
+//
+// 每个线程维护一个字节倒计数，分配时减去请求的大小，减到负数才进入慢路径：抓取调用栈，
+// 在存活样本表中记下 (地址, 大小, 栈)，再按均值为 sample_bytes 的指数分布重新取一个间隔。
+// 平均每分配 sample_bytes 字节采一次，大块几乎必定被采到，与 tcmalloc 的做法相同
+// 释放时先查一个按地址散列的计数过滤器，只有可能是样本的地址才加锁查表，所以未被采样的释放只多一次加载
+//
+// 定义 ZEPHYR_HEAP_PROFILE 时各分配器通过 alloc_hooks.h 调用 on_allocate / on_deallocate；
+// 未定义时这些记录点不存在。编译进来但没有 start 时，每个线程每分配 1 MiB 检查一次是否开始
+//
+// dump_pprof 输出 gperftools 的堆文本格式（heap_v2），pprof 会按采样间隔还原估计值；
+// dump_folded 输出 flamegraph.pl 使用的折叠栈，数值是还原后的估计常驻字节数。
+// 符号由 dladdr 解析，可执行文件本身的函数需要以 -rdynamic 链接才有名字，否则输出 模块+偏移
+
+namespace zephyr
+{
+
+struct heap_profile_summary {
+    size_t sample_bytes;        // 采样间隔
+    uint64_t live_samples;      // 还没有释放的样本数
+    uint64_t live_bytes;        // 这些样本的请求字节数之和
+    uint64_t estimated_bytes;   // 按采样间隔还原的常驻字节数
+    uint64_t total_samples;     // start 以来的样本数
+    uint64_t dropped;           // 表满而丢弃的样本数
+    size_t stacks;              // 不同调用栈的个数
+};
+
+class heap_profiler {
+
+public:
+    enum { default_sample_bytes = 512 * 1024 };
+    enum { max_depth = 32 };
+
+    // 开始采样，平均每 sample_bytes 字节采一次。样本表用 mmap 建立，只建一次；
+    // 再次 start 时沿用已有的样本，只改变间隔
+    static bool start(size_t sample_bytes = default_sample_bytes) {
+        if (sample_bytes == 0)
+            return false;
+        // 先走一遍 backtrace：第一次调用会加载 libgcc_s，其中的分配、释放不进入分析器
+        bool was_busy = busy();
+        busy() = true;
+        void* frames[4];
+        backtrace(frames, 4);
+        busy() = was_busy;
+        std::lock_guard<spin_lock> guard(lock());
+        if (tables().samples == nullptr && !create_tables())
+            return false;
+        period().store(sample_bytes, std::memory_order_relaxed);
+        active_flag().store(true, std::memory_order_release);
+        countdown() = 0;
+        return true;
+    }
+
+    // 停止采样新的分配；已有的样本仍然在释放时更新，仍然可以 dump
+    static void stop() {
+        active_flag().store(false, std::memory_order_release);
+    }
+
+    static bool active() {
+        return active_flag().load(std::memory_order_relaxed);
+    }
+
+    static void on_allocate(const void* p, size_t n) {
+        int64_t& left = countdown();
+        left -= static_cast<int64_t>(n);
+        if (left < 0)
+            sample(p, n);
+    }
+
+    static void on_deallocate(const void* p) {
+        if (p != nullptr && filter()[filter_index(p)].load(std::memory_order_relaxed) != 0)
+            forget(p);
+    }
+
+    static heap_profile_summary summary() {
+        heap_profile_summary s = heap_profile_summary();
+        s.sample_bytes = period().load(std::memory_order_relaxed);
+        std::vector<stack_entry> stacks;
+        snapshot(stacks, s);
+        for (const stack_entry& e : stacks)
+            s.estimated_bytes += estimate(e.live_count, e.live_bytes, s.sample_bytes);
+        return s;
+    }
+
+    // pprof 可以直接读取：pprof -top 程序 文件
+    static bool dump_pprof(FILE* out) {
+        heap_profile_summary s = heap_profile_summary();
+        std::vector<stack_entry> stacks;
+        snapshot(stacks, s);
+        uint64_t live_count = 0, live_bytes = 0, total_count = 0, total_bytes = 0;
+        for (const stack_entry& e : stacks) {
+            live_count += e.live_count;
+            live_bytes += e.live_bytes;
+            total_count += e.total_count;
+            total_bytes += e.total_bytes;
+        }
+        fprintf(out, "heap profile: %6llu: %8llu [%6llu: %8llu] @ heap_v2/%zu\n",
+                (unsigned long long)live_count, (unsigned long long)live_bytes,
+                (unsigned long long)total_count, (unsigned long long)total_bytes,
+                period().load(std::memory_order_relaxed));
+        for (const stack_entry& e : stacks) {
+            fprintf(out, "%6llu: %8llu [%6llu: %8llu] @",
+                    (unsigned long long)e.live_count, (unsigned long long)e.live_bytes,
+                    (unsigned long long)e.total_count, (unsigned long long)e.total_bytes);
+            for (uint32_t i = 0; i < e.depth; ++i)
+                fprintf(out, " %p", e.frames[i]);
+            fputc('\n', out);
+        }
+        fputs("\nMAPPED_LIBRARIES:\n", out);
+        FILE* maps = fopen("/proc/self/maps", "r");
+        if (maps != nullptr) {
+            char buffer[4096];
+            size_t got;
+            while ((got = fread(buffer, 1, sizeof(buffer), maps)) > 0)
+                fwrite(buffer, 1, got, out);
+            fclose(maps);
+        }
+        return ferror(out) == 0;
+    }
+
+    // 每行 调用者;...;分配点 估计常驻字节数，只输出还有存活样本的栈
+    static bool dump_folded(FILE* out) {
+        heap_profile_summary s = heap_profile_summary();
+        std::vector<stack_entry> stacks;
+        snapshot(stacks, s);
+        size_t rate = period().load(std::memory_order_relaxed);
+        std::string name;
+        for (const stack_entry& e : stacks) {
+            if (e.live_count == 0)
+                continue;
+            for (uint32_t i = e.depth; i > 0; --i) {
+                symbolize(e.frames[i - 1], name);
+                fputs(name.c_str(), out);
+                if (i > 1)
+                    fputc(';', out);
+            }
+            fprintf(out, " %llu\n", (unsigned long long)estimate(e.live_count, e.live_bytes, rate));
+        }
+        return ferror(out) == 0;
+    }
+
+    static bool dump_pprof(const char* path) { return dump_to(path, false); }
+    static bool dump_folded(const char* path) { return dump_to(path, true); }
+
+private:
+    struct sample_entry {
+        uintptr_t address;      // 0 表示空槽
+        uint64_t size;
+        uint32_t stack;
+    };
+
+    struct stack_entry {
+        uint64_t hash;
+        uint32_t depth;         // 0 表示空槽
+        void* frames[max_depth];
+        uint64_t live_count;
+        uint64_t live_bytes;
+        uint64_t total_count;
+        uint64_t total_bytes;
+    };
+
+    // 以下在持有 lock() 时访问
+    struct table_set {
+        sample_entry* samples;
+        stack_entry* stacks;
+        uint64_t live_samples;
+        uint64_t total_samples;
+        uint64_t dropped;
+        size_t stack_count;
+    };
+
+    enum { sample_capacity = 1 << 17 };
+    enum { stack_capacity = 1 << 13 };
+    enum { filter_bits = 16 };
+    // 没有在采样时，每分配这么多字节检查一次是否开始
+    enum { idle_recheck_bytes = 1 << 20 };
+    // 抓栈时跳过 sample 自己
+    enum { skip_frames = 1 };
+
+    static spin_lock& lock() {
+        static spin_lock l;
+        return l;
+    }
+
+    static table_set& tables() {
+        static table_set t;
+        return t;
+    }
+
+    static std::atomic<bool>& active_flag() {
+        static std::atomic<bool> a(false);
+        return a;
+    }
+
+    static std::atomic<size_t>& period() {
+        static std::atomic<size_t> p(default_sample_bytes);
+        return p;
+    }
+
+    // 平凡类型的 thread_local，访问不经过初始化检查
+    static int64_t& countdown() {
+        static thread_local int64_t left = 0;
+        return left;
+    }
+
+    // 当前线程正在采样或 dump，期间的分配、释放不再进入分析器
+    static bool& busy() {
+        static thread_local bool b = false;
+        return b;
+    }
+
+    static std::atomic<uint16_t>* filter() {
+        static std::atomic<uint16_t> f[1 << filter_bits];
+        return f;
+    }
+
+    static size_t mix(uintptr_t p) {
+        return static_cast<size_t>((static_cast<uint64_t>(p) >> 4) * 0x9e3779b97f4a7c15ull >> 20);
+    }
+
+    static size_t filter_index(const void* p) {
+        return mix(reinterpret_cast<uintptr_t>(p)) & ((1 << filter_bits) - 1);
+    }
+
+    static bool create_tables() {
+        size_t bytes = sample_capacity * sizeof(sample_entry) + stack_capacity * sizeof(stack_entry);
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            return false;
+        tables().samples = static_cast<sample_entry*>(p);
+        tables().stacks = reinterpret_cast<stack_entry*>(tables().samples + sample_capacity);
+        return true;
+    }
+
+    // 均值为 mean 的指数分布，xorshift 取随机数
+    static int64_t next_interval(size_t mean) {
+        static thread_local uint64_t state = 0;
+        if (state == 0)
+            state = reinterpret_cast<uintptr_t>(&state) * 0x9e3779b97f4a7c15ull | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double u = (static_cast<double>(state >> 11) + 1.0) / 9007199254740993.0;
+        double interval = -log(u) * static_cast<double>(mean);
+        return interval > 1e15 ? static_cast<int64_t>(1e15) : static_cast<int64_t>(interval) + 1;
+    }
+
+    // 每个样本代表的分配数是 1 / (1 - exp(-大小 / 间隔))，用平均大小还原，与 pprof 一致
+    static uint64_t estimate(uint64_t count, uint64_t bytes, size_t rate) {
+        if (count == 0)
+            return 0;
+        double average = static_cast<double>(bytes) / count;
+        double probability = 1.0 - exp(-average / static_cast<double>(rate));
+        return static_cast<uint64_t>(static_cast<double>(bytes) / (probability > 0 ? probability : 1.0));
+    }
+
+    __attribute__((noinline)) static void sample(const void* p, size_t n) {
+        if (!active()) {
+            countdown() = idle_recheck_bytes;
+            return ;
+        }
+        countdown() = next_interval(period().load(std::memory_order_relaxed));
+        if (p == nullptr || busy())
+            return ;
+        busy() = true;
+        void* frames[max_depth + skip_frames];
+        int depth = backtrace(frames, max_depth + skip_frames) - skip_frames;
+        if (depth > 0)
+            record(p, n, frames + skip_frames, static_cast<uint32_t>(depth));
+        busy() = false;
+    }
+
+    static uint64_t hash_frames(void* const* frames, uint32_t depth) {
+        uint64_t h = 1469598103934665603ull;
+        for (uint32_t i = 0; i < depth; ++i)
+            h = (h ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+        return h;
+    }
+
+    static void record(const void* p, size_t n, void* const* frames, uint32_t depth) {
+        uint64_t h = hash_frames(frames, depth);
+        uintptr_t address = reinterpret_cast<uintptr_t>(p);
+        std::lock_guard<spin_lock> guard(lock());
+        table_set& t = tables();
+        ++t.total_samples;
+        // 样本表最多填到一半，线性探测的链保持很短
+        if (t.live_samples >= sample_capacity / 2) {
+            ++t.dropped;
+            return ;
+        }
+        size_t s = h & (stack_capacity - 1);
+        for (;; s = (s + 1) & (stack_capacity - 1)) {
+            stack_entry& e = t.stacks[s];
+            if (e.depth == 0) {
+                if (t.stack_count >= stack_capacity / 2) {
+                    ++t.dropped;
+                    return ;
+                }
+                e.hash = h;
+                e.depth = depth;
+                memcpy(e.frames, frames, depth * sizeof(void*));
+                ++t.stack_count;
+                break;
+            }
+            if (e.hash == h && e.depth == depth && memcmp(e.frames, frames, depth * sizeof(void*)) == 0)
+                break;
+        }
+        // 同一个地址还有旧样本，说明它的释放没有经过记录点，先把旧样本去掉
+        erase(address);
+        stack_entry& e = t.stacks[s];
+        ++e.live_count;
+        e.live_bytes += n;
+        ++e.total_count;
+        e.total_bytes += n;
+        size_t i = mix(address) & (sample_capacity - 1);
+        while (t.samples[i].address != 0)
+            i = (i + 1) & (sample_capacity - 1);
+        t.samples[i].address = address;
+        t.samples[i].size = n;
+        t.samples[i].stack = static_cast<uint32_t>(s);
+        ++t.live_samples;
+        filter()[filter_index(p)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void forget(const void* p) {
+        // dump 的线程只会释放它自己的临时内存，那些分配不会被采样
+        if (busy())
+            return ;
+        std::lock_guard<spin_lock> guard(lock());
+        erase(reinterpret_cast<uintptr_t>(p));
+    }
+
+    // 持有 lock() 时调用；线性探测，删除时把后面的元素往前挪，不留墓碑
+    static void erase(uintptr_t address) {
+        table_set& t = tables();
+        if (t.samples == nullptr)
+            return ;
+        const size_t mask = sample_capacity - 1;
+        size_t i = mix(address) & mask;
+        while (t.samples[i].address != address) {
+            if (t.samples[i].address == 0)
+                return ;
+            i = (i + 1) & mask;
+        }
+        stack_entry& e = t.stacks[t.samples[i].stack];
+        --e.live_count;
+        e.live_bytes -= t.samples[i].size;
+        --t.live_samples;
+        filter()[filter_index(reinterpret_cast<const void*>(address))].fetch_sub(1, std::memory_order_relaxed);
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask; t.samples[j].address != 0; j = (j + 1) & mask) {
+            size_t home = mix(t.samples[j].address) & mask;
+            // home 在环上不落在 (hole, j] 之间时，j 可以挪到 hole
+            bool between = hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+            if (!between) {
+                t.samples[hole] = t.samples[j];
+                hole = j;
+            }
+        }
+        t.samples[hole].address = 0;
+    }
+
+    // 复制出有样本的栈，之后在锁外格式化
+    static void snapshot(std::vector<stack_entry>& out, heap_profile_summary& s) {
+        bool was_busy = busy();
+        busy() = true;
+        out.clear();
+        out.reserve(stack_capacity / 2);
+        {
+            std::lock_guard<spin_lock> guard(lock());
+            table_set& t = tables();
+            if (t.stacks != nullptr)
+                for (size_t i = 0; i < stack_capacity; ++i)
+                    if (t.stacks[i].depth != 0 && t.stacks[i].total_count != 0)
+                        out.push_back(t.stacks[i]);
+            s.live_samples = t.live_samples;
+            s.total_samples = t.total_samples;
+            s.dropped = t.dropped;
+            s.stacks = t.stack_count;
+        }
+        for (const stack_entry& e : out)
+            s.live_bytes += e.live_bytes;
+        busy() = was_busy;
+    }
+
+    static void symbolize(void* frame, std::string& name) {
+        Dl_info info = Dl_info();
+        char buffer[64];
+        bool found = dladdr(frame, &info) != 0;
+        if (found && info.dli_sname != nullptr) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            name = status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+            free(demangled);
+        }
+        else if (found && info.dli_fname != nullptr && info.dli_fbase != nullptr) {
+            const char* base = strrchr(info.dli_fname, '/');
+            snprintf(buffer, sizeof(buffer), "+0x%llx",
+                     (unsigned long long)(static_cast<char*>(frame) - static_cast<char*>(info.dli_fbase)));
+            name = base != nullptr ? base + 1 : info.dli_fname;
+            name += buffer;
+        }
+        else {
+            snprintf(buffer, sizeof(buffer), "%p", frame);
+            name = buffer;
+        }
+        // 折叠栈以 ; 分隔帧、以最后一个空格分隔数值
+        for (char& c : name)
+            if (c == ';')
+                c = ',';
+    }
+
+    static bool dump_to(const char* path, bool folded) {
+        bool was_busy = busy();
+        busy() = true;
+        FILE* out = fopen(path, "w");
+        bool ok = out != nullptr;
+        if (ok) {
+            ok = folded ? dump_folded(out) : dump_pprof(out);
+            ok = fclose(out) == 0 && ok;
+        }
+        busy() = was_busy;
+        return ok;
+    }
+};
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_HEAP_PROFILER_H
@@ -10,37 +10,92 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <limits>
+#include <type_traits>
+
+#include "../math/internal_bit.hpp"
+#include "../util/spin_lock.h"
+#include "page_source.h"
+#include "aligned_new.h"
+#include "alloc_hooks.h"
+#include "../util/stat_counter.h"
 
 namespace zephyr
 {
 
-struct chunk {
+// chunk 的数据区放在一段从 page_source 取得、按 2 的幂对齐的内存（span）中，span 开头的 chunk_header_size 字节
+// 记录该 chunk 在 fixed_allocator::chunks_ 中的下标和 span 的大小，块地址按位与掩码即可找到所属 chunk
+enum { chunk_header_size = 16 };
+
+#ifndef ZEPHYR_CHUNK_BYTES
+#define ZEPHYR_CHUNK_BYTES 65536
+#endif
+
+// 空闲块的下标存放在块内，下标类型 Index 决定一个 chunk 最多能放多少个块
+// 块比 Index 窄时无法放下下标，所以块大小必须不小于 sizeof(Index)
+//
+// 块是惰性切分的：[0, carved_) 是用过的块，其中被释放的块串成以 first_available_block_ 开头的链表，
+// 链表的末尾指向 carved_；[carved_, blocks) 从未被写过。链表为空时 first_available_block_ == carved_，
+// 此时直接切出下一个新块。这样新 chunk 的内存只有真正被使用时才会被访问
+template <typename Index>
+struct basic_chunk {
 
 public:
+    typedef Index index_type;
 
     unsigned char* p_data_;
     size_t block_available_;
-    unsigned char first_available_block_;
+    Index first_available_block_;
+    Index carved_;
 
 public:
 
-    void reset(size_t block_size_, unsigned char blocks_) {
+    // 块不一定按 Index 对齐，通过 memcpy 读写块内的下标
+    static Index load_index(const unsigned char* p) {
+        Index i;
+        memcpy(&i, p, sizeof(Index));
+        return i;
+    }
+
+    static void store_index(unsigned char* p, Index i) {
+        memcpy(p, &i, sizeof(Index));
+    }
+
+    void reset(size_t block_size_, size_t blocks_) {
         block_available_ = blocks_;
         first_available_block_ = 0;
-        unsigned char i = 0;
-        unsigned char* p = p_data_;
-        for (; i != blocks_; p += block_size_) {
-            *p = ++i;
-            //std::cout << "p = " << (void*)p << " i = " << (int)i << std::endl;
-        }
+        carved_ = 0;
 //        std::cout << "reset(size_t block_size_, size_t blocks_)::p_data_ = " << (void*)p_data_ << std::endl;
-//        std::cout << "reset(size_t block_size_, size_t blocks_)::*p_data_ = " << (int)*p_data_ << std::endl;
     }
 
-    void init(size_t block_size_, unsigned char blocks_) {
+    static size_t span_size(size_t block_size_, size_t blocks_) {
+        return size_t(1) << ceil_pow2(static_cast<int>(chunk_header_size + block_size_ * blocks_));
+    }
+
+    static unsigned char* span_of(const void* p, size_t span_size_) {
+        return reinterpret_cast<unsigned char*>(
+                reinterpret_cast<uintptr_t>(p) & ~(uintptr_t)(span_size_ - 1));
+    }
+
+    size_t& span_index() {
+        return *reinterpret_cast<size_t*>(p_data_ - chunk_header_size);
+    }
+
+    size_t& span_bytes() {
+        return *reinterpret_cast<size_t*>(p_data_ - chunk_header_size + sizeof(size_t));
+    }
+
+    void init(size_t block_size_, size_t blocks_) {
         //DEBUG
 //        std::cout << "init(size_t block_size_, size_t blocks_)::block_size_ = " << block_size_ << " blocks_ = " << (unsigned int)blocks_ << std::endl;
-        p_data_ = static_cast<unsigned char*>(::operator new(block_size_ * blocks_)) ;
+        size_t span_size_ = span_size(block_size_, blocks_);
+        void* span = current_page_source().map(span_size_, span_size_);
+        p_data_ = static_cast<unsigned char*>(span) + chunk_header_size;
+        span_bytes() = span_size_;
         // DEBUG
 //        std::cout << "init(size_t block_size_, size_t blocks_):: chunk: init = " << block_size_ * blocks_ << std::endl;
 //        std::cout << "init(size_t block_size_, size_t blocks_):: p_data_ = " << (void*)p_data_ << std::endl;
@@ -49,40 +104,45 @@ public:
 
     void release() {
         if (p_data_) {
-            delete p_data_;
+            current_page_source().unmap(p_data_ - chunk_header_size, span_bytes());
             p_data_ = nullptr,
             block_available_ = 0,
-            first_available_block_ = 0;
+            first_available_block_ = 0,
+            carved_ = 0;
         }
     }
 
 
 public:
 
-    chunk() = default;
+    basic_chunk() = default;
 
-    chunk(size_t block_size_,  unsigned char blocks_) {
+    basic_chunk(size_t block_size_, size_t blocks_) {
         init(block_size_, blocks_);
     }
 
-    chunk(chunk&& other)
+    basic_chunk(basic_chunk&& other)
         : p_data_(other.p_data_),
         block_available_(other.block_available_),
-        first_available_block_(other.first_available_block_)
+        first_available_block_(other.first_available_block_),
+        carved_(other.carved_)
     {
         other.p_data_ = nullptr,
         other.block_available_ = 0,
-        other.first_available_block_ = 0;
+        other.first_available_block_ = 0,
+        other.carved_ = 0;
     }
 
-    chunk& operator=(chunk&& rhs) {
+    basic_chunk& operator=(basic_chunk&& rhs) {
         p_data_ = rhs.p_data_,
         block_available_ = rhs.block_available_,
-        first_available_block_ = rhs.first_available_block_;
+        first_available_block_ = rhs.first_available_block_,
+        carved_ = rhs.carved_;
 
         rhs.p_data_ = nullptr,
         rhs.block_available_ = 0,
-        rhs.first_available_block_ = 0;
+        rhs.first_available_block_ = 0,
+        rhs.carved_ = 0;
         return *this;
     }
 
@@ -110,7 +170,10 @@ public:
 //        std::cout << "allocate(size_t block_size_)::*p_result_ = " << (unsigned int)*p_result_ << std::endl;
 
 
-        first_available_block_ = *p_result_;
+        if (first_available_block_ == carved_)
+            first_available_block_ = ++carved_;
+        else
+            first_available_block_ = load_index(p_result_);
         --block_available_;
 
 //        // DEBUG
@@ -120,27 +183,128 @@ public:
         return p_result_;
     }
 
+    // 取出至多 n 个块，返回取出的个数：先取空闲链表，链表取完后从未切分区域连续切出剩下的块
+    template <typename T>
+    size_t allocate_bulk(size_t block_size_, T** out, size_t n) {
+        if (n > block_available_)
+            n = block_available_;
+        size_t i = 0;
+        for (; i < n && first_available_block_ != carved_; ++i) {
+            unsigned char* p = p_data_ + block_size_ * first_available_block_;
+            first_available_block_ = load_index(p);
+            out[i] = static_cast<T*>(static_cast<void*>(p));
+        }
+        unsigned char* p = p_data_ + block_size_ * carved_;
+        for (size_t k = i; k < n; ++k, p += block_size_)
+            out[k] = static_cast<T*>(static_cast<void*>(p));
+        if (i < n)
+            first_available_block_ = carved_ = static_cast<Index>(carved_ + (n - i));
+        block_available_ -= n;
+        return n;
+    }
+
     void deallocate(void* p, size_t block_size_) {
         unsigned char* to_release_ = static_cast<unsigned char*>(p);
-        *to_release_ = first_available_block_;
+        store_index(to_release_, first_available_block_);
         first_available_block_ =
-                static_cast<unsigned char>((to_release_ - p_data_) / block_size_);
+                static_cast<Index>((to_release_ - p_data_) / block_size_);
         ++block_available_;
     }
 
-    ~chunk() { release(); }
+    // 把 n 个属于本 chunk 的块一次串到空闲链表头部，链表头只在最后写回一次
+    template <typename T>
+    void deallocate_bulk(T** in, size_t n, size_t block_size_) {
+        Index head = first_available_block_;
+        for (size_t i = 0; i < n; ++i) {
+            unsigned char* to_release_ = static_cast<unsigned char*>(static_cast<void*>(in[i]));
+            store_index(to_release_, head);
+            head = static_cast<Index>((to_release_ - p_data_) / block_size_);
+        }
+        first_available_block_ = head;
+        block_available_ += n;
+    }
+
+    ~basic_chunk() { release(); }
+
+};
+
+typedef basic_chunk<unsigned char> chunk;
+
+/**
+ * 根据块大小和目标 chunk 字节数选择块下标的位宽
+ * @tparam Block_size 块大小
+ * @tparam Chunk_bytes 一个 chunk（含头部）的目标字节数
+ * @tparam Header_size chunk 头部占用的字节数
+ */
+template <size_t Block_size,
+          size_t Chunk_bytes = ZEPHYR_CHUNK_BYTES,
+          size_t Header_size = chunk_header_size>
+struct chunk_traits {
+    static_assert(Block_size > 0, "block size must be positive");
+
+    static constexpr size_t fit_blocks =
+            Chunk_bytes > Header_size + Block_size ? (Chunk_bytes - Header_size) / Block_size : 1;
+
+    typedef typename std::conditional<
+            Block_size < sizeof(uint16_t) || fit_blocks <= UINT8_MAX, uint8_t,
+            typename std::conditional<
+                    Block_size < sizeof(uint32_t) || fit_blocks <= UINT16_MAX, uint16_t,
+                    uint32_t>::type>::type index_type;
+
+    static constexpr size_t max_blocks = std::numeric_limits<index_type>::max();
+
+    static constexpr size_t num_blocks = fit_blocks < max_blocks ? fit_blocks : max_blocks;
+};
 
+template <size_t Block_size, size_t Chunk_bytes, size_t Header_size>
+constexpr size_t chunk_traits<Block_size, Chunk_bytes, Header_size>::fit_blocks;
+
+template <size_t Block_size, size_t Chunk_bytes, size_t Header_size>
+constexpr size_t chunk_traits<Block_size, Chunk_bytes, Header_size>::max_blocks;
+
+template <size_t Block_size, size_t Chunk_bytes, size_t Header_size>
+constexpr size_t chunk_traits<Block_size, Chunk_bytes, Header_size>::num_blocks;
+
+// fixed_allocator 的统计；fixed_allocator 不是线程安全的，计数就是其所属线程的计数
+// concurrent_fixed_allocator::stats() 用同一结构汇总各线程的 heap
+struct fixed_allocator_stats {
+    size_t block_size;
+    size_t chunks;
+    size_t reserved_bytes;      // 所有 chunk 的 span 字节数
+    size_t in_use_bytes;        // 用户持有的块的字节数
+    uint64_t live;              // 用户持有的块数
+    double fragmentation;       // 1 - in_use_bytes / reserved_bytes
+
+    // 以下在定义 ZEPHYR_NO_ALLOCATOR_STATS 时为 0
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t chunk_allocations; // 申请 chunk 的次数
+    uint64_t high_water;        // live 的峰值
 };
 
-template <size_t Block_size, unsigned char Num_blocks = 255>
+template <size_t Block_size,
+          size_t Chunk_bytes = ZEPHYR_CHUNK_BYTES,
+          typename Index = typename chunk_traits<Block_size, Chunk_bytes>::index_type>
 class fixed_allocator {
 
+public:
+    typedef basic_chunk<Index> chunk;
+
 private:
     chunk* alloc_chunk_;
     chunk* dealloc_chunk_;
     std::vector<chunk>  chunks_;
     size_t block_size_;
-    unsigned char num_blocks_;
+    size_t num_blocks_;
+    size_t span_size_;
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    uint64_t allocations_ = 0;
+    uint64_t deallocations_ = 0;
+    uint64_t chunk_allocations_ = 0;
+    uint64_t live_ = 0;
+    uint64_t high_water_ = 0;
+#endif
 
 public:
 
@@ -149,78 +313,187 @@ public:
            dealloc_chunk_(nullptr),
            chunks_(),
            block_size_(Block_size),
-           num_blocks_(Num_blocks)
-    { }
+           num_blocks_(chunk_traits<Block_size, Chunk_bytes>::num_blocks),
+           span_size_(chunk::span_size(block_size_, num_blocks_))
+    {
+        static_assert(Block_size >= sizeof(Index), "a block must be able to hold its index");
+    }
+
+    // 运行期指定块大小，块数由 Chunk_bytes 推出；块大小至少为 sizeof(Index)
+    explicit fixed_allocator(size_t block_size)
+        : alloc_chunk_(nullptr),
+          dealloc_chunk_(nullptr),
+          chunks_(),
+          block_size_(block_size < sizeof(Index) ? sizeof(Index) : block_size),
+          num_blocks_(blocks_for(block_size_)),
+          span_size_(chunk::span_size(block_size_, num_blocks_))
+    {}
 
-    fixed_allocator(size_t block_size, unsigned char num_blocks)
+    fixed_allocator(size_t block_size, size_t num_blocks)
         : alloc_chunk_(nullptr),
           dealloc_chunk_(nullptr),
           chunks_(),
-          block_size_(block_size),
-          num_blocks_(num_blocks)
+          block_size_(block_size < sizeof(Index) ? sizeof(Index) : block_size),
+          num_blocks_(num_blocks < std::numeric_limits<Index>::max()
+                      ? num_blocks : std::numeric_limits<Index>::max()),
+          span_size_(chunk::span_size(block_size_, num_blocks_))
     {}
 
     void* allocate() {
-        if (alloc_chunk_ == nullptr || alloc_chunk_->block_available_ == 0) {
-            auto i = chunks_.begin();
-            for (;; ++i) {
-                if (i == chunks_.end()) {
-                    chunks_.push_back(chunk(block_size_, num_blocks_));
-                    alloc_chunk_ = &chunks_.back();
-                    dealloc_chunk_ = &chunks_.front();
+        if (alloc_chunk_ == nullptr || alloc_chunk_->block_available_ == 0)
+            find_alloc_chunk();
+#ifdef ZEPHYR_ALLOCATOR_STATS
+        ++allocations_;
+        if (++live_ > high_water_)
+            high_water_ = live_;
+#endif
+        void* p = alloc_chunk_->allocate(block_size_);
+        trace_allocate(trace_source::fixed, p, block_size_);
+        return p;
+    }
+
+    // 一个 chunk 一个 chunk 地整段取出
+    template <typename T>
+    void allocate_bulk(T** out, size_t n) {
+        size_t i = 0;
+        while (i < n) {
+            if (alloc_chunk_ == nullptr || alloc_chunk_->block_available_ == 0)
+                find_alloc_chunk();
+            i += alloc_chunk_->allocate_bulk(block_size_, out + i, n - i);
+        }
+#ifdef ZEPHYR_ALLOCATOR_STATS
+        allocations_ += n;
+        live_ += n;
+        if (live_ > high_water_)
+            high_water_ = live_;
+#endif
+        if (hooks_active())
+            for (size_t k = 0; k < n; ++k)
+                trace_allocate(trace_source::fixed, out[k], block_size_);
+    }
+
+    // 落在同一个 chunk 的连续一段只查找一次 chunk，一次串进该 chunk 的空闲链表，计数也按段更新
+    template <typename T>
+    void deallocate_bulk(T** in, size_t n) {
+        size_t i = 0;
+        while (i < n) {
+            void* p = static_cast<void*>(in[i]);
+            chunk* c = p != nullptr ? deallocate_chunk_find(p) : nullptr;
+            if (c == nullptr) {
+                ++i;
+                continue;
+            }
+            unsigned char* span = chunk::span_of(p, span_size_);
+            size_t j = i + 1;
+            while (j < n && in[j] != nullptr && chunk::span_of(in[j], span_size_) == span)
+                ++j;
+            if (hooks_active())
+                for (size_t k = i; k < j; ++k)
+                    trace_deallocate(trace_source::fixed, in[k], block_size_);
+#ifdef ZEPHYR_ALLOCATOR_STATS
+            deallocations_ += j - i;
+            live_ -= j - i;
+#endif
+            dealloc_chunk_ = c;
+            c->deallocate_bulk(in + i, j - i, block_size_);
+            reclaim_chunk();
+            i = j;
+        }
+    }
+
+private:
+    // 找一个还有空闲块的 chunk 作为 alloc_chunk_，都满了就新建一个
+    void find_alloc_chunk() {
+        auto i = chunks_.begin();
+        for (;; ++i) {
+            if (i == chunks_.end()) {
+                chunks_.push_back(chunk(block_size_, num_blocks_));
+                chunks_.back().span_index() = chunks_.size() - 1;
+                ZEPHYR_STAT(++chunk_allocations_);
+                alloc_chunk_ = &chunks_.back();
+                dealloc_chunk_ = &chunks_.front();
 
 //                    //DEBUG
 //                    std::cout << "allocate()::alloc_chunk_ = " << alloc_chunk_ << " " << dealloc_chunk_ << std::endl;
 
-                    break;
-                }
-                if (i->block_available_ > 0) {
-                    alloc_chunk_ = &*i;
-                    break;
-                }
+                break;
+            }
+            if (i->block_available_ > 0) {
+                alloc_chunk_ = &*i;
+                break;
             }
         }
-        return alloc_chunk_->allocate(block_size_);
     }
 
+public:
+    // p 必须是 nullptr 或本分配器分配的块，见 deallocate_chunk_find
     void deallocate(void* p) {
+        if (p == nullptr) return ;
         dealloc_chunk_ = deallocate_chunk_find(p);
+        if (dealloc_chunk_ == nullptr) return ;
+        trace_deallocate(trace_source::fixed, p, block_size_);
+#ifdef ZEPHYR_ALLOCATOR_STATS
+        ++deallocations_,
+        --live_;
+#endif
         do_deallocate(p);
     }
 
+    // O(chunk 个数)：live 由各 chunk 的空闲块数推出，不依赖统计开关
+    fixed_allocator_stats stats() const {
+        fixed_allocator_stats result = fixed_allocator_stats();
+        result.block_size = block_size_;
+        result.chunks = chunks_.size();
+        result.reserved_bytes = chunks_.size() * span_size_;
+        for (size_t i = 0; i < chunks_.size(); ++i)
+            result.live += num_blocks_ - chunks_[i].block_available_;
+        result.in_use_bytes = result.live * block_size_;
+        if (result.reserved_bytes > 0)
+            result.fragmentation = 1.0 - static_cast<double>(result.in_use_bytes) / result.reserved_bytes;
+#ifdef ZEPHYR_ALLOCATOR_STATS
+        result.allocations = allocations_;
+        result.deallocations = deallocations_;
+        result.chunk_allocations = chunk_allocations_;
+        result.high_water = high_water_;
+#endif
+        return result;
+    }
+
+    size_t block_size() const { return block_size_; }
+
+    size_t chunk_count() const { return chunks_.size(); }
+
+    size_t num_blocks() const { return num_blocks_; }
+
+private:
+    static size_t blocks_for(size_t block_size) {
+        size_t n = Chunk_bytes > chunk_header_size + block_size
+                   ? (Chunk_bytes - chunk_header_size) / block_size : 1;
+        return n < std::numeric_limits<Index>::max() ? n : std::numeric_limits<Index>::max();
+    }
+
+public:
+
 private:
+    // O(1)：由块地址找到 span，再由 span 头部记录的下标找到 chunk，与 chunk 个数无关
+    // 下标校验只能识别 span 大小相同的其他 fixed_allocator 分配的块（返回 nullptr）；
+    // 其他来源的指针取整后的地址可能没有映射，读取头部是未定义行为。chunk 的 span 比 span_map 的单元小，
+    // 无法像 global_allocator 那样先查表再读头部
     chunk* deallocate_chunk_find(void* p) {
-        const size_t chunk_length = num_blocks_ * block_size_;
-        chunk* lo = dealloc_chunk_;
-        chunk* hi = dealloc_chunk_;
-        chunk* lo_bound = &chunks_.front();
-        chunk* hi_bound = &chunks_.back() + 1;
-
-        for (;;) {
-            if (lo == nullptr && hi == nullptr)
-                break;
-            if (lo) {
-                if (p >= lo->p_data_ && p < lo->p_data_ + chunk_length)
-                    return lo;
-                if (lo == lo_bound)
-                    lo = nullptr;
-                else
-                    --lo;
-            }
-
-            if (hi) {
-                if (p >= hi->p_data_ && p < hi->p_data_ + chunk_length)
-                    return hi;
-                if (++hi == hi_bound)
-                    hi = nullptr;
-            }
-        }
-        return nullptr;
+        unsigned char* span = chunk::span_of(p, span_size_);
+        size_t index = *reinterpret_cast<size_t*>(span);
+        if (index >= chunks_.size() || chunks_[index].p_data_ != span + chunk_header_size)
+            return nullptr;
+        return &chunks_[index];
     }
 
     void do_deallocate(void* p) {
-        if (dealloc_chunk_ == nullptr) return ;
         dealloc_chunk_->deallocate(p, block_size_);
+        reclaim_chunk();
+    }
+
+    // dealloc_chunk_ 完全空闲时，归还或移到末尾
+    void reclaim_chunk() {
 
 //        // DEBUG
 //        std::cout << "num_blocks_ = " << (unsigned int)num_blocks_ << std::endl;
@@ -283,6 +556,7 @@ private:
 //                std::cout << "&last_chunk = " << &last_chunk << " dealloc_chunk_ = " << dealloc_chunk_ << std::endl;
 
                 std::swap(*dealloc_chunk_, last_chunk);
+                std::swap(dealloc_chunk_->span_index(), last_chunk.span_index());
 
 //                // DEBUG
 //                std::cout << "*dealloc_chunk_.block_available_ = " << (*dealloc_chunk_).block_available_
@@ -305,11 +579,581 @@ private:
     }
 };
 
+#ifndef ZEPHYR_SMALL_OBJECT_MAX_SIZE
+#define ZEPHYR_SMALL_OBJECT_MAX_SIZE 256
+#endif
+
+// 按大小分级的小对象分配器：每一级持有一个 fixed_allocator，不同类型只要大小落在同一级就共用 chunk
+// 超过 max_object_size 的请求直接交给 ::operator new
+//
+// chunk 的数据区从 span 起点偏移 chunk_header_size，块大小是 2^k 的倍数时块按 min(2^k, chunk_header_size) 对齐；
+// 带对齐要求的请求把大小取整到 align 的倍数，align 超过 chunk_header_size 时交给 aligned_new
+class small_object_allocator {
+
+public:
+    enum { object_align = 8 };
+
+    typedef fixed_allocator<object_align> allocator_type;
+
+    explicit small_object_allocator(size_t max_object_size = ZEPHYR_SMALL_OBJECT_MAX_SIZE)
+        : max_object_size_(max_object_size),
+          pool_()
+    {
+        size_t n = class_index(max_object_size) + 1;
+        pool_.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            pool_.emplace_back((i + 1) * object_align);
+    }
+
+    small_object_allocator(const small_object_allocator&) = delete;
+    small_object_allocator& operator=(const small_object_allocator&) = delete;
+
+    void* allocate(size_t n) {
+        if (n > max_object_size_)
+            return ::operator new(n);
+        return pool_[class_index(n)].allocate();
+    }
+
+    void deallocate(void* p, size_t n) {
+        if (p == nullptr) return ;
+        if (n > max_object_size_) {
+            ::operator delete(p);
+            return ;
+        }
+        pool_[class_index(n)].deallocate(p);
+    }
+
+    void* allocate(size_t n, size_t align) {
+        if (align <= static_cast<size_t>(object_align))
+            return allocate(n);
+        if (!pooled(n, align))
+            return aligned_new(n, align);
+        return pool_[class_index(class_size(n, align))].allocate();
+    }
+
+    // 必须传入与分配时相同的 n 与 align
+    void deallocate(void* p, size_t n, size_t align) {
+        if (align <= static_cast<size_t>(object_align)) {
+            deallocate(p, n);
+            return ;
+        }
+        if (p == nullptr) return ;
+        if (!pooled(n, align)) {
+            aligned_delete(p, align);
+            return ;
+        }
+        pool_[class_index(class_size(n, align))].deallocate(p);
+    }
+
+    template <typename T>
+    void allocate_bulk(size_t n, T** out, size_t count) {
+        if (n > max_object_size_) {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = static_cast<T*>(::operator new(n));
+            return ;
+        }
+        pool_[class_index(n)].allocate_bulk(out, count);
+    }
+
+    template <typename T>
+    void deallocate_bulk(size_t n, T** in, size_t count) {
+        if (n > max_object_size_) {
+            for (size_t i = 0; i < count; ++i)
+                ::operator delete(static_cast<void*>(in[i]));
+            return ;
+        }
+        pool_[class_index(n)].deallocate_bulk(in, count);
+    }
+
+    size_t max_object_size() const { return max_object_size_; }
+
+    size_t chunk_count() const {
+        size_t n = 0;
+        for (size_t i = 0; i < pool_.size(); ++i)
+            n += pool_[i].chunk_count();
+        return n;
+    }
+
+    // 每个尺寸分级一项
+    std::vector<fixed_allocator_stats> stats() const {
+        std::vector<fixed_allocator_stats> result;
+        result.reserve(pool_.size());
+        for (size_t i = 0; i < pool_.size(); ++i)
+            result.push_back(pool_[i].stats());
+        return result;
+    }
+
+    static constexpr size_t class_index(size_t n) {
+        return n == 0 ? 0 : (n + object_align - 1) / object_align - 1;
+    }
+
+    static constexpr size_t class_size(size_t n) {
+        return (class_index(n) + 1) * object_align;
+    }
+
+    // n 取整到 align 与 object_align 中较大者的倍数
+    static constexpr size_t class_size(size_t n, size_t align) {
+        return align <= static_cast<size_t>(object_align)
+               ? class_size(n)
+               : (n == 0 ? align : (n + align - 1) / align * align);
+    }
+
+    // 进程内共享的实例，loki_alloc<T> 在单线程模式下使用
+    static small_object_allocator& instance() {
+        static small_object_allocator allocator;
+        return allocator;
+    }
+
+private:
+    bool pooled(size_t n, size_t align) const {
+        return align <= static_cast<size_t>(chunk_header_size) && class_size(n, align) <= max_object_size_;
+    }
+
+    size_t max_object_size_;
+    std::vector<allocator_type> pool_;
+};
+
+// ---------------------------------------------------------------------------
+// 多线程模式：每个线程拥有自己的 chunk（owner heap）
+// chunk 按自身大小对齐，块地址按位与掩码即可找到所属 chunk 的头部
+// 本线程释放直接还给 chunk 内部的空闲链表；其他线程释放则压入该 chunk 的无锁 remote 链表，
+// 由拥有者在下次分配时一次性收回。分配、释放路径都不加锁
+// ---------------------------------------------------------------------------
+
+enum { owned_chunk_header_size = 128 };
+
+template <size_t Block_size, size_t Chunk_bytes = ZEPHYR_CHUNK_BYTES>
+class owner_heap;
+
+template <size_t Block_size, size_t Chunk_bytes>
+struct owned_chunk {
+
+public:
+    // remote 链表把 next 指针存放在块内，块至少要能放下一个指针
+    enum { block_size = Block_size < sizeof(void*) ? sizeof(void*) : Block_size };
+
+    typedef chunk_traits<block_size, Chunk_bytes, owned_chunk_header_size> traits;
+
+    // 拥有者才会读写的部分
+    owner_heap<Block_size, Chunk_bytes>* owner_;
+    size_t index_;
+    basic_chunk<typename traits::index_type> local_;
+
+    // 其他线程释放的块组成的链表，单独占一条 cache line
+    alignas(64) std::atomic<void*> remote_free_;
+
+public:
+    // 把 remote 链表中的块全部收回到 local_，返回收回的个数
+    size_t collect(size_t block_size_) {
+        if (remote_free_.load(std::memory_order_relaxed) == nullptr)
+            return 0;
+        void* p = remote_free_.exchange(nullptr, std::memory_order_acquire);
+        size_t n = 0;
+        while (p != nullptr) {
+            void* next = *static_cast<void**>(p);
+            local_.deallocate(p, block_size_);
+            p = next, ++n;
+        }
+        return n;
+    }
+
+    void remote_deallocate(void* p) {
+        remote_deallocate(p, p);
+    }
+
+    // 把已经串好的一段块 [first, last] 一次 CAS 压入 remote 链表
+    void remote_deallocate(void* first, void* last) {
+        void* head = remote_free_.load(std::memory_order_relaxed);
+        do {
+            *static_cast<void**>(last) = head;
+        } while (!remote_free_.compare_exchange_weak(head, first,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed));
+    }
+};
+
+template <size_t Block_size, size_t Chunk_bytes>
+class owner_heap {
+
+public:
+    typedef owned_chunk<Block_size, Chunk_bytes> chunk_type;
+
+    enum { block_size = chunk_type::block_size };
+    enum { header_size = owned_chunk_header_size };
+
+    static constexpr size_t num_blocks = chunk_type::traits::num_blocks;
+
+    // chunk 按 2 的幂对齐，头部和数据区都在其中
+    static constexpr size_t chunk_size =
+            size_t(1) << ceil_pow2_constexpr(header_size + block_size * num_blocks);
+
+    static chunk_type* chunk_of(void* p) {
+        return reinterpret_cast<chunk_type*>(
+                reinterpret_cast<uintptr_t>(p) & ~(uintptr_t)(chunk_size - 1));
+    }
+
+public:
+    // 所在线程退出后，heap 通过它串在 abandoned 链表上
+    owner_heap* next_abandoned_;
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    // 只有当前持有该 heap 的线程写；其他线程的释放在拥有者收回 remote 链表时才计入 deallocations_
+    stat_counter allocations_;
+    stat_counter deallocations_;
+    stat_counter chunk_allocations_;
+    stat_counter chunk_releases_;
+    stat_counter high_water_;
+
+    // 所有 heap 串成的链表，concurrent_fixed_allocator::stats() 遍历它汇总
+    owner_heap* next_heap_ = nullptr;
+#endif
+
+public:
+
+    owner_heap()
+        : next_abandoned_(nullptr),
+          alloc_chunk_(nullptr),
+          chunks_()
+    {}
+
+    ~owner_heap() {
+        for (size_t i = 0; i < chunks_.size(); ++i)
+            release_chunk(chunks_[i]);
+    }
+
+    void* allocate() {
+        if (alloc_chunk_ == nullptr || alloc_chunk_->local_.block_available_ == 0)
+            find_alloc_chunk();
+        ZEPHYR_STAT(note_allocations(1));
+        return alloc_chunk_->local_.allocate(block_size);
+    }
+
+    template <typename T>
+    void allocate_bulk(T** out, size_t n) {
+        size_t i = 0;
+        while (i < n) {
+            if (alloc_chunk_ == nullptr || alloc_chunk_->local_.block_available_ == 0)
+                find_alloc_chunk();
+            i += alloc_chunk_->local_.allocate_bulk(block_size, out + i, n - i);
+        }
+        ZEPHYR_STAT(note_allocations(n));
+    }
+
+    void deallocate(chunk_type* c, void* p) {
+        ZEPHYR_STAT(deallocations_.add());
+        c->local_.deallocate(p, block_size);
+        if (c->local_.block_available_ == num_blocks && c != alloc_chunk_) {
+            // 保留当前分配用的 chunk，其余完全空闲的 chunk 直接归还
+            remove_chunk(c);
+        }
+    }
+
+    // 线程退出时调用：收回 remote 块并释放完全空闲的 chunk
+    void trim() {
+        alloc_chunk_ = nullptr;
+        for (size_t i = chunks_.size(); i > 0; --i) {
+            chunk_type* c = chunks_[i - 1];
+            collect(c);
+            if (c->local_.block_available_ == num_blocks)
+                remove_chunk(c);
+        }
+    }
+
+private:
+    // 先收回各 chunk 的 remote 块，找一个有空闲块的 chunk，都满了就新建一个
+    void find_alloc_chunk() {
+        alloc_chunk_ = nullptr;
+        for (size_t i = 0; i < chunks_.size(); ++i) {
+            collect(chunks_[i]);
+            if (chunks_[i]->local_.block_available_ > 0) {
+                alloc_chunk_ = chunks_[i];
+                break;
+            }
+        }
+        if (alloc_chunk_ == nullptr)
+            alloc_chunk_ = new_chunk();
+    }
+
+    void collect(chunk_type* c) {
+        size_t n = c->collect(block_size);
+        ZEPHYR_STAT(deallocations_.add(n));
+        (void)n;
+    }
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    void note_allocations(size_t n) {
+        allocations_.add(n);
+        uint64_t live = allocations_.get() - deallocations_.get();
+        if (live > high_water_.get())
+            high_water_.add(live - high_water_.get());
+    }
+#endif
+
+    chunk_type* new_chunk() {
+        void* mem = current_page_source().map(chunk_size, chunk_size);
+        static_assert(sizeof(chunk_type) <= header_size, "owned chunk header too large");
+        chunk_type* c = ::new(mem) chunk_type();
+        c->owner_ = this;
+        c->index_ = chunks_.size();
+        c->local_.p_data_ = static_cast<unsigned char*>(mem) + header_size;
+        c->local_.reset(block_size, num_blocks);
+        c->remote_free_.store(nullptr, std::memory_order_relaxed);
+        chunks_.push_back(c);
+        ZEPHYR_STAT(chunk_allocations_.add());
+        return c;
+    }
+
+    void remove_chunk(chunk_type* c) {
+        ZEPHYR_STAT(chunk_releases_.add());
+        chunk_type* last = chunks_.back();
+        last->index_ = c->index_;
+        chunks_[c->index_] = last;
+        chunks_.pop_back();
+        release_chunk(c);
+    }
+
+    static void release_chunk(chunk_type* c) {
+        // 数据区不是 chunk 自己申请的，析构前先解除关联
+        c->local_.p_data_ = nullptr;
+        c->~chunk_type();
+        current_page_source().unmap(c, chunk_size);
+    }
+
+    chunk_type* alloc_chunk_;
+    std::vector<chunk_type*> chunks_;
+};
+
+template <size_t Block_size, size_t Chunk_bytes>
+constexpr size_t owner_heap<Block_size, Chunk_bytes>::num_blocks;
+
+template <size_t Block_size, size_t Chunk_bytes>
+constexpr size_t owner_heap<Block_size, Chunk_bytes>::chunk_size;
+
+template <size_t Block_size, size_t Chunk_bytes = ZEPHYR_CHUNK_BYTES>
+class concurrent_fixed_allocator {
+
+public:
+    typedef owner_heap<Block_size, Chunk_bytes> heap_type;
+    typedef typename heap_type::chunk_type chunk_type;
+
+    static void* allocate() {
+        heap_type* heap = heap_;
+        if (heap == nullptr)
+            heap = attach();
+        void* p;
+        if (heap == dead_heap()) {
+            heap = adopt();
+            p = heap->allocate();
+            abandon(heap);
+        }
+        else
+            p = heap->allocate();
+        trace_allocate(trace_source::fixed, p, Block_size);
+        return p;
+    }
+
+    static void deallocate(void* p) {
+        if (p == nullptr) return ;
+        trace_deallocate(trace_source::fixed, p, Block_size);
+        chunk_type* c = heap_type::chunk_of(p);
+        if (c->owner_ == heap_)
+            c->owner_->deallocate(c, p);
+        else
+            c->remote_deallocate(p);
+    }
+
+    template <typename T>
+    static void allocate_bulk(T** out, size_t n) {
+        heap_type* heap = heap_;
+        if (heap == nullptr)
+            heap = attach();
+        if (heap == dead_heap()) {
+            heap = adopt();
+            heap->allocate_bulk(out, n);
+            abandon(heap);
+        }
+        else
+            heap->allocate_bulk(out, n);
+        if (hooks_active())
+            for (size_t i = 0; i < n; ++i)
+                trace_allocate(trace_source::fixed, out[i], Block_size);
+    }
+
+    // 属于其他线程的块中，落在同一个 chunk 的连续一段先串起来，再一次 CAS 交给该 chunk
+    template <typename T>
+    static void deallocate_bulk(T** in, size_t n) {
+        if (hooks_active())
+            for (size_t k = 0; k < n; ++k)
+                trace_deallocate(trace_source::fixed, in[k], Block_size);
+        size_t i = 0;
+        while (i < n) {
+            void* p = static_cast<void*>(in[i]);
+            chunk_type* c = heap_type::chunk_of(p);
+            if (c->owner_ == heap_) {
+                c->owner_->deallocate(c, p);
+                ++i;
+                continue;
+            }
+            void* last = p;
+            for (++i; i < n && heap_type::chunk_of(in[i]) == c; ++i) {
+                *static_cast<void**>(last) = static_cast<void*>(in[i]);
+                last = static_cast<void*>(in[i]);
+            }
+            c->remote_deallocate(p, last);
+        }
+    }
+
+    // 汇总所有 heap（包括所在线程已退出、等待接管的 heap）的计数；定义 ZEPHYR_NO_ALLOCATOR_STATS 时只有 block_size
+    // 其他线程释放、还没被拥有者收回的块仍算作 live；high_water 是各 heap 峰值之和，是整体峰值的上界
+    static fixed_allocator_stats stats() {
+        fixed_allocator_stats result = fixed_allocator_stats();
+        result.block_size = heap_type::block_size;
+#ifdef ZEPHYR_ALLOCATOR_STATS
+        uint64_t chunk_releases = 0;
+        {
+            std::lock_guard<spin_lock> guard(abandoned_lock_);
+            for (heap_type* h = heaps_; h != nullptr; h = h->next_heap_) {
+                result.allocations += h->allocations_.get();
+                result.deallocations += h->deallocations_.get();
+                result.chunk_allocations += h->chunk_allocations_.get();
+                result.high_water += h->high_water_.get();
+                chunk_releases += h->chunk_releases_.get();
+            }
+        }
+        // 计数由各线程分别写入，两次读取之间可能不一致，差值不会为负
+        result.live = result.allocations > result.deallocations ? result.allocations - result.deallocations : 0;
+        result.chunks = result.chunk_allocations > chunk_releases ? result.chunk_allocations - chunk_releases : 0;
+        result.reserved_bytes = result.chunks * heap_type::chunk_size;
+        result.in_use_bytes = result.live * heap_type::block_size;
+        if (result.reserved_bytes > 0)
+            result.fragmentation = 1.0 - static_cast<double>(result.in_use_bytes) / result.reserved_bytes;
+#endif
+        return result;
+    }
+
+private:
+    // 线程退出时把 heap 挂到 abandoned 链表上，由之后新建的线程接管
+    // 交出后 heap_ 置为 dead_heap()：其他 thread_local 对象的析构函数此后再分配、释放时，
+    // 释放一律走 remote 链表，分配临时接管一个 heap 用完立即交还，不会再碰已被其他线程接管的 heap
+    // heap_ 不放在 holder_ 里：析构函数中对自身成员的写入会被编译器当作死存储删掉
+    struct heap_holder {
+        void attach() {}
+        ~heap_holder() {
+            if (heap_ != nullptr && heap_ != dead_heap())
+                abandon(heap_);
+            heap_ = dead_heap();
+        }
+    };
+
+    // 不会与任何 chunk 的 owner_ 相等
+    static heap_type* dead_heap() {
+        return reinterpret_cast<heap_type*>(uintptr_t(1));
+    }
+
+    // 首次使用时接管一个 heap，并通过访问 holder_ 登记线程退出时的析构
+    static heap_type* attach() {
+        holder_.attach();
+        return heap_ = adopt();
+    }
+
+    static heap_type* adopt() {
+        {
+            std::lock_guard<spin_lock> guard(abandoned_lock_);
+            if (abandoned_ != nullptr) {
+                heap_type* heap = abandoned_;
+                abandoned_ = heap->next_abandoned_;
+                return heap;
+            }
+        }
+        heap_type* heap = new heap_type();
+#ifdef ZEPHYR_ALLOCATOR_STATS
+        std::lock_guard<spin_lock> guard(abandoned_lock_);
+        heap->next_heap_ = heaps_;
+        heaps_ = heap;
+#endif
+        return heap;
+    }
+
+    static void abandon(heap_type* heap) {
+        heap->trim();
+        std::lock_guard<spin_lock> guard(abandoned_lock_);
+        heap->next_abandoned_ = abandoned_;
+        abandoned_ = heap;
+    }
+
+    static thread_local heap_type* heap_;
+    static thread_local heap_holder holder_;
+    static spin_lock abandoned_lock_;
+    static heap_type* abandoned_;
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    static heap_type* heaps_;
+#endif
+};
+
+template <size_t Block_size, size_t Chunk_bytes>
+thread_local typename concurrent_fixed_allocator<Block_size, Chunk_bytes>::heap_type*
+        concurrent_fixed_allocator<Block_size, Chunk_bytes>::heap_ = nullptr;
+
+template <size_t Block_size, size_t Chunk_bytes>
+thread_local typename concurrent_fixed_allocator<Block_size, Chunk_bytes>::heap_holder
+        concurrent_fixed_allocator<Block_size, Chunk_bytes>::holder_;
+
+template <size_t Block_size, size_t Chunk_bytes>
+spin_lock concurrent_fixed_allocator<Block_size, Chunk_bytes>::abandoned_lock_;
+
+template <size_t Block_size, size_t Chunk_bytes>
+typename concurrent_fixed_allocator<Block_size, Chunk_bytes>::heap_type*
+        concurrent_fixed_allocator<Block_size, Chunk_bytes>::abandoned_ = nullptr;
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+template <size_t Block_size, size_t Chunk_bytes>
+typename concurrent_fixed_allocator<Block_size, Chunk_bytes>::heap_type*
+        concurrent_fixed_allocator<Block_size, Chunk_bytes>::heaps_ = nullptr;
+#endif
+
+// 默认使用多线程模式；定义 ZEPHYR_LOKI_SINGLE_THREAD 时退回单线程的 small_object_allocator
+// 两种模式都按 small_object_allocator 的分级取整，大小相近的类型共用同一组 chunk
+// 块按 alignof(T) 对齐：多线程模式下 owned chunk 的数据区偏移 owned_chunk_header_size，块大小取整到 alignof(T)
+// 的倍数即可；单线程模式下超过 chunk_header_size 的对齐交给 aligned_new
 template<typename T>
 class loki_alloc {
 
 public:
 
+#ifdef ZEPHYR_LOKI_SINGLE_THREAD
+    static T* allocate() {
+        return static_cast<T*>(small_object_allocator::instance().allocate(sizeof(T), alignof(T)));
+    }
+
+    static void deallocate(T* p) {
+        small_object_allocator::instance().deallocate(static_cast<void*>(p), sizeof(T), alignof(T));
+    }
+
+    static void allocate_bulk(T** out, size_t n) {
+        if (alignof(T) > static_cast<size_t>(small_object_allocator::object_align)) {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = allocate();
+            return ;
+        }
+        small_object_allocator::instance().allocate_bulk(sizeof(T), out, n);
+    }
+
+    static void deallocate_bulk(T** in, size_t n) {
+        if (alignof(T) > static_cast<size_t>(small_object_allocator::object_align)) {
+            for (size_t i = 0; i < n; ++i)
+                deallocate(in[i]);
+            return ;
+        }
+        small_object_allocator::instance().deallocate_bulk(sizeof(T), in, n);
+    }
+
+    // T 所在尺寸分级的统计，与大小相近的其他类型共享；不经过分级的 T 返回全 0
+    static fixed_allocator_stats stats() {
+        std::vector<fixed_allocator_stats> classes = small_object_allocator::instance().stats();
+        size_t i = small_object_allocator::class_index(small_object_allocator::class_size(sizeof(T), alignof(T)));
+        return i < classes.size() ? classes[i] : fixed_allocator_stats();
+    }
+#else
     static T* allocate() {
         return static_cast<T*>(allocator.allocate());
     }
@@ -318,13 +1162,31 @@ public:
         allocator.deallocate(static_cast<void*>(p));
     }
 
+    static void allocate_bulk(T** out, size_t n) {
+        allocator.allocate_bulk(out, n);
+    }
+
+    static void deallocate_bulk(T** in, size_t n) {
+        allocator.deallocate_bulk(in, n);
+    }
+
+    // T 所在尺寸分级的统计，与大小相近的其他类型共享
+    static fixed_allocator_stats stats() {
+        return allocator_type::stats();
+    }
+
 private:
-    static fixed_allocator<sizeof(T)> allocator;
+    static_assert(alignof(T) <= owned_chunk_header_size, "loki_alloc does not support this alignment");
+    typedef concurrent_fixed_allocator<small_object_allocator::class_size(sizeof(T), alignof(T))> allocator_type;
+    static allocator_type allocator;
+#endif
 };
 
 
+#ifndef ZEPHYR_LOKI_SINGLE_THREAD
 template <typename T>
-fixed_allocator<sizeof(T)> loki_alloc<T>::allocator;
+typename loki_alloc<T>::allocator_type loki_alloc<T>::allocator;
+#endif
 
 } // namespace zephyr
 
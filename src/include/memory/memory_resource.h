@@ -0,0 +1,136 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_MEMORY_RESOURCE_H
+#define ZEPHYR_MEMORY_RESOURCE_H
+
+// 这个头文件包含三种 std::pmr::memory_resource 实现，需要 C++17
+//
+// pool_resource         : 使用全局的 pool_allocator，线程安全，所有实例互相等价
+// small_object_resource : 拥有一组按 8 字节分级的 fixed_allocator（small_object_allocator），不加锁，只能单线程使用
+// arena_resource        : 拥有一个 arena，释放什么也不做，内存随 release() 或析构一起回收
+//
+// 无法满足的对齐或大小交给 upstream（默认为 std::pmr::get_default_resource()）或带对齐的 operator new
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+
+#define ZEPHYR_HAS_MEMORY_RESOURCE 1
+
+#include <new>
+#include <stddef.h>
+#include <memory_resource>
+
+#include "pool_allocator.h"
+#include "loki_allocator.h"
+#include "arena.h"
+
+namespace zephyr
+{
+
+class pool_resource : public std::pmr::memory_resource {
+
+public:
+    // 不超过 max_align 的对齐由 pool 满足，见 pool_allocator::allocate(bytes, align)
+    enum { max_align = Z_span_header };
+
+    static pool_resource& instance() {
+        static pool_resource resource;
+        return resource;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        return pool_allocator::allocate(bytes, align);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        pool_allocator::deallocate(p, bytes, align);
+    }
+
+    // 所有 pool_resource 都在同一个 pool_allocator 上分配，一个分配的内存可以由另一个释放
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other || dynamic_cast<const pool_resource*>(&other) != nullptr;
+    }
+};
+
+class small_object_resource : public std::pmr::memory_resource {
+
+public:
+    // chunk 的数据区从 span 起点偏移 chunk_header_size，块大小是 16 的倍数时块按 16 字节对齐
+    enum { max_align = chunk_header_size };
+
+    explicit small_object_resource(size_t max_object_size = ZEPHYR_SMALL_OBJECT_MAX_SIZE,
+                                   std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : allocator_(max_object_size),
+          upstream_(upstream)
+    {}
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        if (!fits(bytes, align))
+            return upstream_->allocate(bytes, align);
+        return allocator_.allocate(round(bytes, align));
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        if (!fits(bytes, align)) {
+            upstream_->deallocate(p, bytes, align);
+            return ;
+        }
+        allocator_.deallocate(p, round(bytes, align));
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    bool fits(size_t bytes, size_t align) const {
+        return align <= static_cast<size_t>(max_align) && round(bytes, align) <= allocator_.max_object_size();
+    }
+
+    static size_t round(size_t bytes, size_t align) {
+        return (bytes + align - 1) & ~(align - 1);
+    }
+
+    small_object_allocator allocator_;
+    std::pmr::memory_resource* upstream_;
+};
+
+class arena_resource : public std::pmr::memory_resource {
+
+public:
+    arena_resource() = default;
+
+    arena_resource(void* buffer, size_t size) : arena_(buffer, size) {}
+
+    zephyr::arena& arena() { return arena_; }
+
+    void release() { arena_.release(); }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        return arena_.allocate(bytes, align);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    zephyr::arena arena_;
+};
+
+} // namespace zephyr
+
+#endif // __has_include(<memory_resource>)
+#endif // __cplusplus >= 201703L
+
+
+#endif //ZEPHYR_MEMORY_RESOURCE_H
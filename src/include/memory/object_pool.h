@@ -0,0 +1,181 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_OBJECT_POOL_H
+#define ZEPHYR_OBJECT_POOL_H
+
+#include <new>
+#include <vector>
+#include <functional>
+#include <utility>
+
+#include "loki_allocator.h"
+#include "construct.h"
+
+// 这个头文件包含对象池 object_pool<T> 与归还对象用的 RAII 句柄 object_pool<T>::handle
+//
+// 对象的内存来自 object_pool 自己持有的 fixed_allocator<sizeof(T)>
+// 给出 reset 钩子时，归还的对象先由钩子恢复到可复用的状态，然后保持构造好的状态留在池中，
+// 下次 acquire 直接交出，不再析构、构造；池中最多保留 max_retained 个，多出来的照常析构
+// 没有 reset 钩子时，归还的对象总是被析构，只有内存被复用
+//
+// object_pool 不是线程安全的；句柄必须在对象池销毁之前归还
+
+namespace zephyr
+{
+
+template <typename T>
+class object_pool {
+
+public:
+    typedef T value_type;
+    typedef std::function<void(T&)> reset_type;
+
+    // 独占一个对象，析构时把对象还给对象池，只能移动
+    class handle {
+
+    public:
+        handle() noexcept : pool_(nullptr), ptr_(nullptr) {}
+
+        handle(handle&& other) noexcept : pool_(other.pool_), ptr_(other.ptr_) {
+            other.pool_ = nullptr;
+            other.ptr_ = nullptr;
+        }
+
+        handle& operator=(handle&& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                pool_ = rhs.pool_;
+                ptr_ = rhs.ptr_;
+                rhs.pool_ = nullptr;
+                rhs.ptr_ = nullptr;
+            }
+            return *this;
+        }
+
+        handle(const handle&) = delete;
+        handle& operator=(const handle&) = delete;
+
+        ~handle() { reset(); }
+
+        T* get() const noexcept { return ptr_; }
+        T& operator*() const noexcept { return *ptr_; }
+        T* operator->() const noexcept { return ptr_; }
+        explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+        // 提前归还
+        void reset() {
+            if (ptr_ != nullptr) {
+                pool_->release(ptr_);
+                ptr_ = nullptr;
+            }
+        }
+
+        // 放弃所有权，之后需要调用者自己 object_pool::release
+        T* detach() noexcept {
+            T* p = ptr_;
+            ptr_ = nullptr;
+            return p;
+        }
+
+    private:
+        friend class object_pool;
+
+        handle(object_pool* pool, T* ptr) noexcept : pool_(pool), ptr_(ptr) {}
+
+        object_pool* pool_;
+        T* ptr_;
+    };
+
+public:
+    explicit object_pool(size_t max_retained = 64, reset_type reset = reset_type())
+        : max_retained_(max_retained),
+          reset_(std::move(reset)),
+          retained_(),
+          allocator_(),
+          live_(0)
+    {
+        static_assert(alignof(T) <= chunk_header_size, "object_pool does not support over-aligned types");
+        retained_.reserve(max_retained_);
+    }
+
+    object_pool(const object_pool&) = delete;
+    object_pool& operator=(const object_pool&) = delete;
+
+    ~object_pool() { trim(); }
+
+    // 有保留的对象时直接交出，args 被忽略；否则用 args 构造一个新对象
+    template <typename ... Args>
+    handle acquire(Args&& ...args) {
+        return handle(this, acquire_raw(std::forward<Args>(args)...));
+    }
+
+    template <typename ... Args>
+    T* acquire_raw(Args&& ...args) {
+        T* p = nullptr;
+        if (!retained_.empty()) {
+            p = retained_.back();
+            retained_.pop_back();
+        }
+        else {
+            void* mem = allocator_.allocate();
+            try {
+                p = ::new(mem) T(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                allocator_.deallocate(mem);
+                throw;
+            }
+        }
+        ++live_;
+        return p;
+    }
+
+    // reset 钩子抛出异常时对象被析构而不是保留
+    void release(T* p) {
+        if (p == nullptr) return ;
+        --live_;
+        if (reset_ && retained_.size() < max_retained_) {
+            try {
+                reset_(*p);
+                retained_.push_back(p);
+                return ;
+            }
+            catch (...) {
+            }
+        }
+        destroy_one(p);
+    }
+
+    // 析构所有保留的对象
+    void trim() {
+        while (!retained_.empty()) {
+            destroy_one(retained_.back());
+            retained_.pop_back();
+        }
+    }
+
+    size_t retained() const { return retained_.size(); }
+
+    size_t live() const { return live_; }
+
+    size_t max_retained() const { return max_retained_; }
+
+private:
+    void destroy_one(T* p) {
+        zephyr::destroy(p);
+        allocator_.deallocate(p);
+    }
+
+    size_t max_retained_;
+    reset_type reset_;
+    std::vector<T*> retained_;
+    fixed_allocator<sizeof(T)> allocator_;
+    size_t live_;
+};
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_OBJECT_POOL_H
@@ -0,0 +1,199 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_PAGE_SOURCE_H
+#define ZEPHYR_PAGE_SOURCE_H
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+
+#include <sys/mman.h>
+
+#include "../util/spin_lock.h"
+
+// 这个头文件包含分配器向系统申请大块内存的来源 page_source，pool_allocator 的 span 与 loki 的 chunk 都从这里取内存
+//
+// heap : posix_memalign / free，即原来的行为，页大小由 libc 决定
+// mmap : 直接 mmap 匿名内存，多映射一段再裁掉两端得到对齐的地址
+// huge : 预留 2 MiB 对齐的大区域并设置 MADV_HUGEPAGE，再从中切出对齐的小段，
+//        内核开启透明大页时用 2 MiB 页映射，大量小对象分散访问时 TLB 缺失更少
+//
+// 编译期用 -DZEPHYR_PAGE_SOURCE=heap|mmap|huge 选择默认来源（默认 mmap），
+// 启动时可以用环境变量 ZEPHYR_PAGE_SOURCE 或 set_page_source() 覆盖，但必须在第一次分配之前
+
+#ifndef ZEPHYR_PAGE_SOURCE
+#define ZEPHYR_PAGE_SOURCE mmap
+#endif
+
+#ifndef ZEPHYR_HUGE_REGION_BYTES
+#define ZEPHYR_HUGE_REGION_BYTES (32u << 20)
+#endif
+
+namespace zephyr
+{
+
+// map 返回按 align 对齐的 bytes 字节，align 是 2 的幂；失败时抛出 std::bad_alloc
+// unmap 的 bytes 必须与 map 时相同
+struct page_source {
+    const char* name;
+    void* (*map)(size_t bytes, size_t align);
+    void  (*unmap)(void* p, size_t bytes);
+};
+
+namespace page_sources
+{
+
+enum { huge_page_bytes = 2 << 20 };
+
+inline void* heap_map(size_t bytes, size_t align) {
+    void* p = nullptr;
+    if (posix_memalign(&p, align, bytes) != 0)
+        throw std::bad_alloc();
+    return p;
+}
+
+inline void heap_unmap(void* p, size_t) {
+    free(p);
+}
+
+// 多映射 align 字节，再把对齐地址两端多余的部分解除映射
+inline void* mmap_aligned(size_t bytes, size_t align) {
+    size_t size = bytes + align;
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        throw std::bad_alloc();
+    uintptr_t start = reinterpret_cast<uintptr_t>(p);
+    uintptr_t aligned = (start + align - 1) & ~(uintptr_t)(align - 1);
+    if (aligned > start)
+        ::munmap(p, aligned - start);
+    if (aligned + bytes < start + size)
+        ::munmap(reinterpret_cast<void*>(aligned + bytes), start + size - aligned - bytes);
+    return reinterpret_cast<void*>(aligned);
+}
+
+inline void* mmap_map(size_t bytes, size_t align) {
+    return mmap_aligned(bytes, align);
+}
+
+inline void mmap_unmap(void* p, size_t bytes) {
+    ::munmap(p, bytes);
+}
+
+// 当前正在切分的大页区域 [cursor, end)
+struct huge_region {
+    spin_lock lock;
+    uintptr_t cursor;
+    uintptr_t end;
+};
+
+inline huge_region& current_huge_region() {
+    static huge_region region;
+    return region;
+}
+
+inline void* huge_map_region(size_t bytes, size_t align) {
+    void* p = mmap_aligned(bytes, align < huge_page_bytes ? static_cast<size_t>(huge_page_bytes) : align);
+#ifdef MADV_HUGEPAGE
+    ::madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+
+inline void* huge_map(size_t bytes, size_t align) {
+    const size_t region_bytes = ZEPHYR_HUGE_REGION_BYTES;
+    if (bytes > region_bytes / 4 || align > huge_page_bytes)
+        return huge_map_region((bytes + huge_page_bytes - 1) & ~(size_t)(huge_page_bytes - 1), align);
+
+    huge_region& region = current_huge_region();
+    std::lock_guard<spin_lock> guard(region.lock);
+    uintptr_t p = (region.cursor + align - 1) & ~(uintptr_t)(align - 1);
+    if (region.cursor == 0 || p + bytes > region.end) {
+        // 旧区域剩下的尾巴不足一段，直接丢弃（不会被访问，也就不占物理内存）
+        region.cursor = reinterpret_cast<uintptr_t>(huge_map_region(region_bytes, huge_page_bytes));
+        region.end = region.cursor + region_bytes;
+        p = region.cursor;
+    }
+    region.cursor = p + bytes;
+    return reinterpret_cast<void*>(p);
+}
+
+// 区域中的一段可以单独解除映射，内核会把所在的大页拆开
+inline void huge_unmap(void* p, size_t bytes) {
+    ::munmap(p, bytes);
+}
+
+// 三个内置来源定义为类模板的静态成员，整个程序只有一份；命名空间作用域的 const 对象在每个翻译单元各有一份，
+// 比较地址（例如 global_allocator::prepare() 判断当前来源是不是 heap）会因翻译单元不同而失败
+template <typename = void>
+struct builtin {
+    static const page_source heap;
+    static const page_source mmap;
+    static const page_source huge;
+};
+
+template <typename T>
+const page_source builtin<T>::heap = { "heap", heap_map, heap_unmap };
+
+template <typename T>
+const page_source builtin<T>::mmap = { "mmap", mmap_map, mmap_unmap };
+
+template <typename T>
+const page_source builtin<T>::huge = { "huge", huge_map, huge_unmap };
+
+// 每个翻译单元中的引用都绑定到同一个对象
+static const page_source& heap = builtin<>::heap;
+static const page_source& mmap = builtin<>::mmap;
+static const page_source& huge = builtin<>::huge;
+
+inline const page_source* from_name(const char* name) {
+    if (name == nullptr) return nullptr;
+    if (strcmp(name, "heap") == 0) return &heap;
+    if (strcmp(name, "mmap") == 0) return &mmap;
+    if (strcmp(name, "huge") == 0) return &huge;
+    return nullptr;
+}
+
+struct slot {
+    std::atomic<const page_source*> source;
+    std::atomic<bool> used;
+
+    slot() : used(false) {
+        const page_source* s = from_name(getenv("ZEPHYR_PAGE_SOURCE"));
+        source.store(s != nullptr ? s : &ZEPHYR_PAGE_SOURCE, std::memory_order_relaxed);
+    }
+
+    static slot& instance() {
+        static slot s;
+        return s;
+    }
+};
+
+} // namespace zephyr::page_sources
+
+// 分配器取内存时使用的来源；第一次调用之后来源就固定下来
+inline const page_source& current_page_source() {
+    page_sources::slot& s = page_sources::slot::instance();
+    if (!s.used.load(std::memory_order_relaxed))
+        s.used.store(true, std::memory_order_relaxed);
+    return *s.source.load(std::memory_order_acquire);
+}
+
+// 已经有内存从旧来源取出时不能再切换，返回 false
+inline bool set_page_source(const page_source& source) {
+    page_sources::slot& s = page_sources::slot::instance();
+    if (s.used.load(std::memory_order_relaxed))
+        return false;
+    s.source.store(&source, std::memory_order_release);
+    return true;
+}
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_PAGE_SOURCE_H
@@ -9,6 +9,23 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <type_traits>
+
+#include <sys/mman.h>
+
+#include "../math/internal_bit.hpp"
+#include "../util/spin_lock.h"
+#include "../util/stat_counter.h"
+#include "page_source.h"
+#include "aligned_new.h"
+#include "span_map.h"
+#include "alloc_hooks.h"
 
 namespace zephyr
 {
@@ -17,174 +34,1173 @@ struct Obj {
     Obj* free_list_next;
 };
 
+// 尺寸分级：128 字节以内按 8 字节等距分为 16 级；
+// 128 字节以上每个 2 的幂区间 (2^k, 2^(k+1)] 再等分为 4 级，直到 32 KiB，共 48 级
 enum { Z_align = 8 };
-enum { Z_max_bytes = 128 };
-enum { Z_free_list_size = Z_max_bytes / Z_align };
+enum { Z_small_bytes = 128 };
+enum { Z_max_bytes = 32768 };
+enum { Z_class_per_pow2 = 4 };
+enum { Z_small_list_size = Z_small_bytes / Z_align };
+enum { Z_free_list_size = Z_small_list_size + Z_class_per_pow2 * 8 };
+
+// 堆内存以 span 为单位从 page_source 申请，span 按自身大小对齐，块地址按位与掩码即可找到所属 span
+enum { Z_span_bytes = 256 * 1024 };
+enum { Z_span_header = 64 };
+enum { Z_page_bytes = 4096 };
+
+// 超过 Z_max_bytes 的块交给 ::operator new；不小于 Z_mmap_bytes 的块直接 mmap，按页取整，
+// 这样 reallocate 可以用 mremap 扩张或搬移而不复制数据
+enum { Z_mmap_bytes = 128 * 1024 };
+
+// 块地址是 span 起点加 Z_span_header 再加整数个块大小，所以块按 min(块大小的最低位, Z_span_header) 对齐：
+// 128 字节以上的分级都是 32 的倍数，其中 64 的倍数的分级（64、128、192、256、384 ...）按缓存行对齐，
+// 块占满整数条缓存行，既不跨行也不与其他块共享一行
+enum { Z_cache_line = 64 };
+
+// 每个 span 只服务一个尺寸分级，并记录交出去的块数；块全部归还后 span 完全空闲，可以还给操作系统
+struct span {
+    span* prev;
+    span* next;
+    size_t index;       // 服务的尺寸分级
+    size_t live;        // 交给线程缓存或用户、尚未归还的块数
+    Obj* free_list;     // 归还回来的块
+    char* carve;        // [carve, carve_end) 是从未切分过的区域
+    char* carve_end;
+    bool partial;       // 是否挂在 Z_partial[index] 上
+};
+
+static_assert(sizeof(span) <= Z_span_header, "span header too large");
+static_assert((1 << span_map_shift) == Z_span_bytes, "span_map units must be spans");
+
+// 单个尺寸分级的统计；定义 ZEPHYR_NO_ALLOCATOR_STATS 时除 size 外都为 0
+struct pool_class_stats {
+    size_t size;                // 块大小
+    uint64_t allocations;       // 所有线程 allocate 次数之和，包括已经退出的线程
+    uint64_t deallocations;
+    uint64_t live;              // 用户持有的块数，即 allocations - deallocations
+    uint64_t refills;           // 线程缓存向中心链表取块的次数
+    uint64_t cached;            // 交给线程缓存或用户的块数
+    uint64_t cached_high_water; // cached 的峰值
+};
+
+struct pool_stats {
+    size_t reserved_bytes;  // 当前向操作系统映射的 span 字节数
+    size_t in_use_bytes;    // 交给线程缓存或用户的块的字节数
+    size_t free_bytes;      // 完全空闲但仍常驻内存的 span 字节数
+    size_t released_bytes;  // 累计还给操作系统的字节数
+
+    // 以下在定义 ZEPHYR_NO_ALLOCATOR_STATS 时为 0
+    size_t live_bytes;              // 用户持有的块的字节数（按块大小计）
+    size_t reserved_high_water;
+    size_t in_use_high_water;
+    uint64_t span_allocations;      // 向 page_source 申请 span 的次数
+    uint64_t refills;
+    // 常驻 span 中没有被用户持有的比例，即 1 - live_bytes / 常驻 span 字节数
+    // 尺寸分级取整的浪费不计在内；线程缓存、中心链表上的空闲块与完全空闲的 span 都计在内
+    double fragmentation;
+    pool_class_stats classes[Z_free_list_size];
+};
+
+// 后台 trim 策略：空闲 span 超过 trigger_bytes 才动手，并且只回收到 retain_bytes 为止，
+// 两者之间的差值就是回差，避免流量尖峰带来反复的映射、解除映射
+struct trim_policy {
+    size_t trigger_bytes;
+    size_t retain_bytes;
+    unsigned interval_ms;
+    bool unmap;             // true 用 munmap 归还地址空间；false 用 madvise(MADV_DONTNEED) 只归还物理页
+
+    explicit trim_policy(size_t trigger = 64 * Z_span_bytes,
+                         size_t retain = 16 * Z_span_bytes,
+                         unsigned interval = 1000,
+                         bool use_unmap = false)
+        : trigger_bytes(trigger),
+          retain_bytes(retain),
+          interval_ms(interval),
+          unmap(use_unmap)
+    {}
+};
+
+// 每个线程持有的缓存：线程内的分配、释放只操作自己的空闲链表，不加锁
+// 链表为空或过长时，才以批量的方式与 pool_allocator 的中心空闲链表交换对象
+// 从堆上新取得的一段块不串成链表，而是用 [carve, carve_end) 惰性切分，块在第一次被分配时才会被访问
+class thread_cache {
+
+    friend class pool_allocator;
+
+public:
+    void* allocate(size_t index);
+    void deallocate(void* p, size_t index);
+
+    template <typename T>
+    void allocate_bulk(size_t index, T** out, size_t n);
+    template <typename T>
+    void deallocate_bulk(size_t index, T** in, size_t n);
+
+    // 把缓存的块全部交还中心链表
+    void flush();
+
+    thread_cache();
+    ~thread_cache();
+
+    static thread_cache& current();
 
-class pool_allocator {
 private:
+    // 本线程的 thread_cache 析构后置位：其他 thread_local 对象的析构函数此后再分配、释放时不经过缓存，
+    // 直接与中心链表交换，否则放进已析构的缓存的块再也不会被归还
+    // 放在缓存之外：析构函数中对自身成员的写入会被编译器当作死存储删掉
+    static bool& destroyed();
+
+    struct free_list {
+        Obj* head;
+        size_t length;
+        char* carve;
+        char* carve_end;
+    };
+
+    free_list lists_[Z_free_list_size] = {};
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    // 只有所属线程写，pool_allocator::stats() 在 Z_stats_lock 下遍历所有线程读取
+    stat_counter allocations_[Z_free_list_size];
+    stat_counter deallocations_[Z_free_list_size];
+    thread_cache* prev_;
+    thread_cache* next_;
+
+    // 缓存析构后的分配、释放直接计入 Z_retired_*
+    static void retire(size_t index, uint64_t allocations, uint64_t deallocations);
+#endif
+
+    void* fetch_from_central(size_t index);
+    void release_to_central(size_t index, size_t n);
+};
+
+// pool_allocator 的静态状态放在类模板里：类模板的静态成员可以在头文件中定义，
+// 多个翻译单元包含本头文件时链接器只保留一份
+template <typename = void>
+class pool_state {
+
+protected:
 
-    static char* Z_heap_start;
-    static char* Z_heap_end;
-    static size_t Z_heap_size;
+    // 以下状态只有在持有 Z_lock 时才能访问
+    static span* Z_partial[Z_free_list_size];   // 还有可分配块的 span
+    static span* Z_empty;                        // 完全空闲、仍常驻内存的 span
+    static span* Z_released;                     // 物理页已经还给操作系统的 span
 
-    static Obj* Z_free_list[Z_free_list_size];
+    static size_t Z_reserved_bytes;
+    static size_t Z_in_use_bytes;
+    static size_t Z_empty_bytes;
+    static size_t Z_released_bytes;
+
+    static size_t Z_released_count;
 
     static size_t Z_align_size_list[Z_free_list_size];
 
+    static spin_lock Z_lock;
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    // 以下在持有 Z_lock 时访问
+    static uint64_t Z_span_allocations;
+    static uint64_t Z_refills[Z_free_list_size];
+    static uint64_t Z_cached[Z_free_list_size];
+    static uint64_t Z_cached_high_water[Z_free_list_size];
+    static size_t Z_reserved_high_water;
+    static size_t Z_in_use_high_water;
+
+    // 以下在持有 Z_stats_lock 时访问：所有活着的线程缓存，以及已退出线程留下的计数
+    static thread_cache* Z_caches;
+    static uint64_t Z_retired_allocations[Z_free_list_size];
+    static uint64_t Z_retired_deallocations[Z_free_list_size];
+    static spin_lock Z_stats_lock;
+#endif
+};
+
+class pool_allocator : private pool_state<> {
+
+    friend class thread_cache;
+
 public:
     static void* allocate(size_t n);
     static void deallocate(void* p, size_t n);
+    // 调整 p 的大小并保留前 min(old_size, new_size) 个字节：两个大小落在同一分级时原样返回 p，
+    // 两个大小都不小于 Z_mmap_bytes 时用 mremap，其余情况分配新块、复制、释放旧块
+    // p 为 nullptr 时等同于 allocate(new_size)
     static void* reallocate(void* p, size_t old_size, size_t new_size);
+
+    // 带对齐要求的分配：从 bytes 所在的分级往上找第一个大小是 align 整数倍的分级
+    // align 必须是 2 的幂；超过 Z_span_header 或大小超过 Z_max_bytes 时交给 aligned_new
+    // 释放时必须传入相同的 bytes 与 align
+    static void* allocate(size_t n, size_t align);
+    static void deallocate(void* p, size_t n, size_t align);
+
+    // 大小在编译期已知时使用，尺寸分级在编译期就已确定
+    template <size_t Bytes, size_t Align = Z_align>
+    static void* allocate();
+    template <size_t Bytes, size_t Align = Z_align>
+    static void deallocate(void* p);
+
+    // 按缓存行填充的块：独占整数条缓存行，用于多个线程各自频繁写、会发生伪共享的对象
+    static void* allocate_padded(size_t n) { return allocate(n, Z_cache_line); }
+    static void deallocate_padded(void* p, size_t n) { deallocate(p, n, Z_cache_line); }
+
+    // 一次分配、释放 n 个 bytes 大小的块：整段地从线程缓存、中心链表取出或归还，
+    // 每个 span 只加一次锁，而不是每个对象走一遍 allocate / deallocate
+    template <typename T>
+    static void allocate_bulk(size_t bytes, T** out, size_t n);
+    template <typename T>
+    static void deallocate_bulk(size_t bytes, T** in, size_t n);
+
+    // 把完全空闲的 span 还给操作系统，直到空闲 span 不超过 retain_bytes，返回本次归还的字节数
+    // unmap 为 true 时，之前只归还了物理页的 span 也一并解除映射
+    // 调用线程的缓存会先被清空；其他线程缓存中的块不受影响
+    static size_t trim(size_t retain_bytes = 0, bool unmap = false);
+
+    static pool_stats stats();
+
+    // 完全空闲、仍常驻内存的 span 字节数，即 stats().free_bytes，只加一次锁
+    static size_t free_bytes();
+
+    // 整个 span（Z_span_bytes 字节，按自身大小对齐）交给调用者自行管理，例如 arena；
+    // 归还后与其他空闲 span 一样可以被复用或 trim
+    static void* allocate_span();
+    static void deallocate_span(void* p);
+
+    static void flush_thread_cache();
+
+    // 启动、停止按 policy 周期性 trim 的后台线程
+    static void start_background_trim(const trim_policy& policy = trim_policy());
+    static void stop_background_trim();
+
+    // 第 index 个尺寸分级的块大小
+    static size_t class_size(size_t index) { return Z_align_size_list[index]; }
+
+    // 不超过 Z_max_bytes 的块 p 所在分级的块大小，由 span 头部得到，不需要分配时的大小
+    static size_t block_size(const void* p) {
+        return Z_align_size_list[Z_span_of(const_cast<void*>(p))->index];
+    }
+
+    // 申请 bytes 字节时实际可用的字节数：池内是所在分级的块大小，直接 mmap 的大块按页取整，其余原样返回
+    // 容器可以据此把容量取满整个块；之后按返回值释放、reallocate 与按 bytes 等价
+    static size_t good_size(size_t bytes) {
+        if (bytes <= static_cast<size_t>(Z_max_bytes))
+            return Z_round_up(bytes);
+        if (bytes >= static_cast<size_t>(Z_mmap_bytes))
+            return Z_page_round(bytes);
+        return bytes;
+    }
+
+    // 与 Z_freelist_index 结果相同，但可以在编译期求值
+    static constexpr size_t Z_class_index(size_t bytes) {
+        return bytes <= Z_small_bytes
+               ? (bytes == 0 ? 0 : (bytes + Z_align - 1) / Z_align - 1)
+               : Z_small_list_size
+                 + (bsr_constexpr(bytes - 1) - 7) * Z_class_per_pow2
+                 + (((bytes - 1) >> (bsr_constexpr(bytes - 1) - 2)) & (Z_class_per_pow2 - 1));
+    }
+
+    // 与 Z_align_size_list[index] 相同，但可以在编译期求值
+    static constexpr size_t Z_class_size(size_t index) {
+        return index < Z_small_list_size
+               ? (index + 1) * Z_align
+               : (size_t(Z_small_bytes / Z_class_per_pow2) << ((index - Z_small_list_size) / Z_class_per_pow2))
+                 * (Z_class_per_pow2 + 1 + (index - Z_small_list_size) % Z_class_per_pow2);
+    }
+
+    // bytes、align 能否由 pool 分配
+    static constexpr bool Z_pooled(size_t bytes, size_t align) {
+        return bytes <= static_cast<size_t>(Z_max_bytes) && align <= static_cast<size_t>(Z_span_header);
+    }
+
+    // 能容纳 bytes 且块按 align 对齐的第一个分级；pool 放不下时返回 Z_free_list_size
+    static constexpr size_t Z_aligned_index(size_t bytes, size_t align) {
+        if (!Z_pooled(bytes, align))
+            return Z_free_list_size;
+        size_t index = Z_class_index(bytes);
+        while (Z_class_size(index) % align != 0)
+            ++index;
+        return index;
+    }
 private:
     static size_t Z_round_up(size_t bytes);
-    static void*  Z_refill(size_t n);
+    static void   Z_note_in_use();
     static size_t Z_freelist_index(size_t bytes);
-    static char*  Z_chunk_alloc(size_t size, size_t& nblock);
-};
+    static span*  Z_refill(size_t index);
+    static span*  Z_span_alloc();
+    static span*  Z_chunk_alloc();
+    static void   Z_chunk_free(span* s);
 
-char* pool_allocator::Z_heap_start = nullptr;
-char* pool_allocator::Z_heap_end = nullptr;
-size_t pool_allocator::Z_heap_size = 0;
+    static void*  Z_large_alloc(size_t bytes);
+    static void   Z_large_free(void* p, size_t bytes);
+    static size_t Z_page_round(size_t bytes);
+    static void   Z_span_free(span* s);
 
-Obj* pool_allocator::Z_free_list[Z_free_list_size] = {
-    nullptr, nullptr, nullptr, nullptr,
-    nullptr, nullptr, nullptr, nullptr,
-    nullptr, nullptr, nullptr, nullptr,
-    nullptr, nullptr, nullptr, nullptr,
+    static span*  Z_span_of(void* p);
+    static void   Z_list_push(span*& list, span* s);
+    static void   Z_list_remove(span*& list, span* s);
+
+    static size_t Z_batch_size(size_t bytes);
+    static size_t Z_fetch(size_t index, size_t nblock, Obj*& head, Obj*& tail, char*& region);
+    static void   Z_release(size_t index, Obj* head);
 };
 
-size_t pool_allocator::Z_align_size_list[Z_free_list_size] = {
+template <typename T>
+span* pool_state<T>::Z_partial[Z_free_list_size] = {};
+template <typename T>
+span* pool_state<T>::Z_empty = nullptr;
+template <typename T>
+span* pool_state<T>::Z_released = nullptr;
+
+template <typename T>
+size_t pool_state<T>::Z_reserved_bytes = 0;
+template <typename T>
+size_t pool_state<T>::Z_in_use_bytes = 0;
+template <typename T>
+size_t pool_state<T>::Z_empty_bytes = 0;
+template <typename T>
+size_t pool_state<T>::Z_released_bytes = 0;
+template <typename T>
+size_t pool_state<T>::Z_released_count = 0;
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+template <typename T>
+uint64_t pool_state<T>::Z_span_allocations = 0;
+template <typename T>
+uint64_t pool_state<T>::Z_refills[Z_free_list_size] = {};
+template <typename T>
+uint64_t pool_state<T>::Z_cached[Z_free_list_size] = {};
+template <typename T>
+uint64_t pool_state<T>::Z_cached_high_water[Z_free_list_size] = {};
+template <typename T>
+size_t pool_state<T>::Z_reserved_high_water = 0;
+template <typename T>
+size_t pool_state<T>::Z_in_use_high_water = 0;
+
+template <typename T>
+thread_cache* pool_state<T>::Z_caches = nullptr;
+template <typename T>
+uint64_t pool_state<T>::Z_retired_allocations[Z_free_list_size] = {};
+template <typename T>
+uint64_t pool_state<T>::Z_retired_deallocations[Z_free_list_size] = {};
+template <typename T>
+spin_lock pool_state<T>::Z_stats_lock;
+#endif
+
+template <typename T>
+size_t pool_state<T>::Z_align_size_list[Z_free_list_size] = {
         8, 16, 24, 32, 40, 48, 56, 64,
         72, 80, 88, 96, 104, 112, 120, 128,
+        160, 192, 224, 256,
+        320, 384, 448, 512,
+        640, 768, 896, 1024,
+        1280, 1536, 1792, 2048,
+        2560, 3072, 3584, 4096,
+        5120, 6144, 7168, 8192,
+        10240, 12288, 14336, 16384,
+        20480, 24576, 28672, 32768,
 };
 
+template <typename T>
+spin_lock pool_state<T>::Z_lock;
+
 inline void* pool_allocator::allocate(size_t _size) {
-    if (_size > static_cast<size_t>(Z_max_bytes))
-        return ::operator new(Z_max_bytes);
-    Obj*& free_list_index = Z_free_list[Z_freelist_index(_size)];
-    Obj* result = free_list_index;
-    if (result == nullptr) {
-        void* r = Z_refill(Z_round_up(_size));
-        return r;
-    }
-    free_list_index = result->free_list_next;
-    return result;
+    void* p = _size > static_cast<size_t>(Z_max_bytes)
+              ? Z_large_alloc(_size)
+              : thread_cache::current().allocate(Z_freelist_index(_size));
+    trace_allocate(trace_source::pool, p, _size);
+    return p;
 }
 
 inline void pool_allocator::deallocate(void* p, size_t _size) {
+    trace_deallocate(trace_source::pool, p, _size);
     if (_size > static_cast<size_t>(Z_max_bytes)) {
-        ::operator delete(p);
+        Z_large_free(p, _size);
         return;
     }
-    Obj* q = (Obj*)p;
-    q->free_list_next = Z_free_list[Z_freelist_index(_size)];
-    Z_free_list[Z_freelist_index(_size)] = q;
+    thread_cache::current().deallocate(p, Z_freelist_index(_size));
+}
+
+inline void* pool_allocator::allocate(size_t _size, size_t align) {
+    if (align <= static_cast<size_t>(Z_align))
+        return allocate(_size);
+    void* p = Z_pooled(_size, align)
+              ? thread_cache::current().allocate(Z_aligned_index(_size, align))
+              : aligned_new(_size, align);
+    trace_allocate(trace_source::pool, p, _size);
+    return p;
+}
+
+inline void pool_allocator::deallocate(void* p, size_t _size, size_t align) {
+    if (align <= static_cast<size_t>(Z_align)) {
+        deallocate(p, _size);
+        return;
+    }
+    trace_deallocate(trace_source::pool, p, _size);
+    if (!Z_pooled(_size, align)) {
+        aligned_delete(p, align);
+        return;
+    }
+    thread_cache::current().deallocate(p, Z_aligned_index(_size, align));
+}
+
+template <size_t Bytes, size_t Align>
+inline void* pool_allocator::allocate() {
+    if (!Z_pooled(Bytes, Align))
+        return allocate(Bytes, Align);
+    typedef std::integral_constant<size_t, Z_aligned_index(Bytes, Align)> index;
+    void* p = thread_cache::current().allocate(index::value);
+    trace_allocate(trace_source::pool, p, Bytes);
+    return p;
+}
+
+template <size_t Bytes, size_t Align>
+inline void pool_allocator::deallocate(void* p) {
+    if (!Z_pooled(Bytes, Align)) {
+        deallocate(p, Bytes, Align);
+        return;
+    }
+    trace_deallocate(trace_source::pool, p, Bytes);
+    typedef std::integral_constant<size_t, Z_aligned_index(Bytes, Align)> index;
+    thread_cache::current().deallocate(p, index::value);
+}
+
+template <typename T>
+inline void pool_allocator::allocate_bulk(size_t bytes, T** out, size_t n) {
+    if (bytes > static_cast<size_t>(Z_max_bytes)) {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = static_cast<T*>(Z_large_alloc(bytes));
+    }
+    else
+        thread_cache::current().allocate_bulk(Z_freelist_index(bytes), out, n);
+    if (hooks_active())
+        for (size_t i = 0; i < n; ++i)
+            trace_allocate(trace_source::pool, out[i], bytes);
+}
+
+template <typename T>
+inline void pool_allocator::deallocate_bulk(size_t bytes, T** in, size_t n) {
+    if (hooks_active())
+        for (size_t i = 0; i < n; ++i)
+            trace_deallocate(trace_source::pool, in[i], bytes);
+    if (bytes > static_cast<size_t>(Z_max_bytes)) {
+        for (size_t i = 0; i < n; ++i)
+            Z_large_free(static_cast<void*>(in[i]), bytes);
+        return ;
+    }
+    thread_cache::current().deallocate_bulk(Z_freelist_index(bytes), in, n);
 }
 
 inline void* pool_allocator::reallocate(void* p, size_t old_size, size_t new_size) {
+    if (p == nullptr)
+        return allocate(new_size);
+    const size_t max_bytes = static_cast<size_t>(Z_max_bytes);
+    const size_t mmap_bytes = static_cast<size_t>(Z_mmap_bytes);
+    // 原地调整与 mremap 不经过 allocate / deallocate，在这里记成一次释放加一次分配
+    if (old_size <= max_bytes && new_size <= max_bytes) {
+        if (Z_freelist_index(old_size) == Z_freelist_index(new_size)) {
+            trace_deallocate(trace_source::pool, p, old_size);
+            trace_allocate(trace_source::pool, p, new_size);
+            return p;
+        }
+    }
+    else if (old_size >= mmap_bytes && new_size >= mmap_bytes) {
+        size_t old_bytes = Z_page_round(old_size);
+        size_t new_bytes = Z_page_round(new_size);
+        trace_deallocate(trace_source::pool, p, old_size);
+        if (old_bytes == new_bytes) {
+            trace_allocate(trace_source::pool, p, new_size);
+            return p;
+        }
+#ifdef MREMAP_MAYMOVE
+        // 内核只改页表，物理页不复制
+        void* q = mremap(p, old_bytes, new_bytes, MREMAP_MAYMOVE);
+        if (q == MAP_FAILED) {
+            trace_allocate(trace_source::pool, p, old_size);
+            throw std::bad_alloc();
+        }
+        trace_allocate(trace_source::pool, q, new_size);
+        return q;
+#else
+        trace_allocate(trace_source::pool, p, old_size);
+#endif
+    }
+    void* q = allocate(new_size);
+    memcpy(q, p, old_size < new_size ? old_size : new_size);
     deallocate(p, old_size);
-    return allocate(new_size);
+    return q;
+}
+
+inline size_t pool_allocator::Z_page_round(size_t bytes) {
+    return (bytes + Z_page_bytes - 1) & ~(size_t)(Z_page_bytes - 1);
+}
+
+// 大块不经过 page_source：page_source 可能从大区域中切分，不能单独 mremap
+inline void* pool_allocator::Z_large_alloc(size_t bytes) {
+    if (bytes < static_cast<size_t>(Z_mmap_bytes))
+        return ::operator new(bytes);
+    void* p = mmap(nullptr, Z_page_round(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        throw std::bad_alloc();
+    return p;
+}
+
+inline void pool_allocator::Z_large_free(void* p, size_t bytes) {
+    if (bytes < static_cast<size_t>(Z_mmap_bytes))
+        ::operator delete(p);
+    else
+        munmap(p, Z_page_round(bytes));
 }
 
 inline size_t pool_allocator::Z_round_up(size_t _size) {
-    size_t l = 0, r = 15, res = 0;
+    return Z_align_size_list[Z_freelist_index(_size)];
+}
 
-    while (l <= r) {
-        size_t mid = (l + r) / 2;
-        if (Z_align_size_list[mid] >= _size)
-            res = Z_align_size_list[mid],
-            r = mid - 1;
-        else
-            l = mid + 1;
+// O(1)：小尺寸直接除以步长，大尺寸由最高位确定所在的 2 的幂区间，再取其后两位确定区间内的级别
+inline size_t pool_allocator::Z_freelist_index(size_t _size) {
+    if (_size <= static_cast<size_t>(Z_small_bytes))
+        return _size == 0 ? 0 : (_size + Z_align - 1) / Z_align - 1;
+    int k = bsr(_size - 1);
+    return Z_small_list_size
+           + (k - 7) * Z_class_per_pow2
+           + (((_size - 1) >> (k - 2)) & (Z_class_per_pow2 - 1));
+}
+
+// 线程缓存与中心链表之间一次搬运的对象个数，小对象一次多搬一些
+inline size_t pool_allocator::Z_batch_size(size_t _size) {
+    size_t n = 4096 / _size;
+    if (n < 2) n = 2;
+    if (n > 32) n = 32;
+    return n;
+}
+
+inline span* pool_allocator::Z_span_of(void* p) {
+    return reinterpret_cast<span*>(
+            reinterpret_cast<uintptr_t>(p) & ~(uintptr_t)(Z_span_bytes - 1));
+}
+
+inline void pool_allocator::Z_list_push(span*& list, span* s) {
+    s->prev = nullptr;
+    s->next = list;
+    if (list != nullptr)
+        list->prev = s;
+    list = s;
+}
+
+inline void pool_allocator::Z_list_remove(span*& list, span* s) {
+    if (s->prev != nullptr)
+        s->prev->next = s->next;
+    else
+        list = s->next;
+    if (s->next != nullptr)
+        s->next->prev = s->prev;
+    s->prev = s->next = nullptr;
+}
+
+// 从 index 级的 span 中取出至多 nblock 个块：优先取归还回来的块，串成 [head, tail]；
+// 没有归还的块时，改为交出一段连续的、未切分的区域放入 region。返回取出的块数
+inline size_t pool_allocator::Z_fetch(size_t index, size_t nblock, Obj*& head, Obj*& tail, char*& region) {
+    std::lock_guard<spin_lock> guard(Z_lock);
+    span* s = Z_partial[index];
+    if (s == nullptr)
+        s = Z_refill(index);
+
+    size_t n = Z_align_size_list[index];
+    size_t count = 0;
+    head = tail = nullptr;
+    region = nullptr;
+    if (s->free_list != nullptr) {
+        count = 1;
+        head = tail = s->free_list;
+        while (count < nblock && tail->free_list_next != nullptr)
+            tail = tail->free_list_next,
+            ++count;
+        s->free_list = tail->free_list_next;
+        tail->free_list_next = nullptr;
     }
-    return res;
+    else {
+        count = static_cast<size_t>(s->carve_end - s->carve) / n;
+        if (count > nblock)
+            count = nblock;
+        region = s->carve;
+        s->carve += count * n;
+    }
+
+    s->live += count;
+    Z_in_use_bytes += count * n;
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    ++Z_refills[index];
+    Z_cached[index] += count;
+    if (Z_cached[index] > Z_cached_high_water[index])
+        Z_cached_high_water[index] = Z_cached[index];
+    Z_note_in_use();
+#endif
+    if (s->free_list == nullptr && s->carve == s->carve_end) {
+        Z_list_remove(Z_partial[index], s);
+        s->partial = false;
+    }
+    return count;
 }
 
-inline size_t pool_allocator::Z_freelist_index(size_t _size) {
-    return Z_round_up(_size) / 8 - 1;
+// 把一串以 nullptr 结尾的 index 级的块逐个还给各自的 span
+inline void pool_allocator::Z_release(size_t index, Obj* head) {
+    std::lock_guard<spin_lock> guard(Z_lock);
+    size_t n = Z_align_size_list[index];
+    while (head != nullptr) {
+        Obj* q = head;
+        head = head->free_list_next;
+        span* s = Z_span_of(q);
+        q->free_list_next = s->free_list;
+        s->free_list = q;
+        Z_in_use_bytes -= n;
+        ZEPHYR_STAT(--Z_cached[index]);
+        if (--s->live == 0) {
+            Z_span_free(s);
+        }
+        else if (!s->partial) {
+            Z_list_push(Z_partial[index], s);
+            s->partial = true;
+        }
+    }
 }
 
+// 取一个空闲 span，依次尝试常驻的空闲 span、已归还物理页的 span、向 page_source 申请
+// 调用者需持有 Z_lock
+inline span* pool_allocator::Z_span_alloc() {
+    span* s = Z_empty;
+    if (s != nullptr) {
+        Z_list_remove(Z_empty, s);
+        Z_empty_bytes -= Z_span_bytes;
+    }
+    else if ((s = Z_released) != nullptr) {
+        Z_list_remove(Z_released, s);
+        --Z_released_count;
+    }
+    else {
+        s = Z_chunk_alloc();
+    }
+    return s;
+}
 
-void* pool_allocator::Z_refill(size_t n) {
-    size_t nblock = 10;
-    char* c = Z_chunk_alloc(n, nblock);
-    if (nblock == 1)
-        return static_cast<void*>(c);
+// index 级没有可用的 span 时取一个新的，调用者需持有 Z_lock
+inline span* pool_allocator::Z_refill(size_t index) {
+    span* s = Z_span_alloc();
+    size_t n = Z_align_size_list[index];
+    s->index = index;
+    s->live = 0;
+    s->free_list = nullptr;
+    s->carve = reinterpret_cast<char*>(s) + Z_span_header;
+    s->carve_end = s->carve + (Z_span_bytes - Z_span_header) / n * n;
+    Z_list_push(Z_partial[index], s);
+    s->partial = true;
+    return s;
+}
 
-    Obj*& free_list_index = Z_free_list[Z_freelist_index(n)];
-    Obj* result = (Obj*)c;
-    Obj* cur = nullptr;
-    Obj* next = nullptr;
-    free_list_index = next = (Obj*)(c + n);
-    for (size_t i = 1; i < nblock; ++i) {
-        cur = next,
-        next = (Obj*)((char*) next + n);
-        cur->free_list_next = (i == nblock - 1) ? nullptr : next;
+// 从 page_source 取一个按 Z_span_bytes 对齐的 span
+inline span* pool_allocator::Z_chunk_alloc() {
+    void* p = nullptr;
+    try {
+        p = current_page_source().map(Z_span_bytes, Z_span_bytes);
     }
-    return result;
+    catch (const std::bad_alloc&) {
+        puts("out of memory");
+        throw;
+    }
+    Z_reserved_bytes += Z_span_bytes;
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    ++Z_span_allocations;
+    if (Z_reserved_bytes > Z_reserved_high_water)
+        Z_reserved_high_water = Z_reserved_bytes;
+#endif
+    span* s = static_cast<span*>(p);
+    s->prev = s->next = nullptr;
+    s->partial = false;
+    span_map::set(s, span_kind::pool);
+    return s;
+}
+
+inline void pool_allocator::Z_chunk_free(span* s) {
+    span_map::set(s, span_kind::none);
+    current_page_source().unmap(s, Z_span_bytes);
+}
+
+// span 中的块全部归还，整个 span 转入空闲链表，调用者需持有 Z_lock
+inline void pool_allocator::Z_span_free(span* s) {
+    if (s->partial) {
+        Z_list_remove(Z_partial[s->index], s);
+        s->partial = false;
+    }
+    Z_list_push(Z_empty, s);
+    Z_empty_bytes += Z_span_bytes;
+}
+
+inline void* pool_allocator::allocate_span() {
+    std::lock_guard<spin_lock> guard(Z_lock);
+    span* s = Z_span_alloc();
+    Z_in_use_bytes += Z_span_bytes;
+    ZEPHYR_STAT(Z_note_in_use());
+    return s;
+}
+
+inline void pool_allocator::deallocate_span(void* p) {
+    std::lock_guard<spin_lock> guard(Z_lock);
+    span* s = static_cast<span*>(p);
+    s->partial = false;
+    Z_in_use_bytes -= Z_span_bytes;
+    Z_span_free(s);
+}
+
+inline void pool_allocator::flush_thread_cache() {
+    thread_cache::current().flush();
+}
+
+// 系统调用不在锁内进行：先把要归还的 span 摘下来，解锁后再 munmap / madvise
+inline size_t pool_allocator::free_bytes() {
+    std::lock_guard<spin_lock> guard(Z_lock);
+    return Z_empty_bytes;
 }
 
-char* pool_allocator::Z_chunk_alloc(size_t size, size_t& nblock) {
-    char* result = nullptr;
-    size_t need_size = size * nblock;
-    size_t heap_size = Z_heap_end - Z_heap_start;
-    if (heap_size >= need_size) {
-        result = Z_heap_start;
-        Z_heap_start += need_size;
-        return result;
-    }
-    if (heap_size >= size) {
-        nblock = heap_size / size;
-        need_size = nblock * size;
-        result = Z_heap_start;
-        Z_heap_start += need_size;
-        return result;
-    }
-
-    if (heap_size > 0) {
-       ((Obj*)(Z_heap_start))->free_list_next = Z_free_list[Z_freelist_index(heap_size)];
-        Z_free_list[Z_freelist_index(heap_size)] = (Obj*)(Z_heap_start);
-    }
-    size_t require_size = need_size * 2 * 2;
-    Z_heap_start = (char*) ::operator new(require_size);
-    if (Z_heap_start == nullptr) {
-        Obj* p;
-        for (size_t i = size; i <= Z_max_bytes; i += Z_align) {
-            Obj*& free_list_index = Z_free_list[i / 8 - 1];
-            p = free_list_index;
-            if (p) {
-                free_list_index->free_list_next = p->free_list_next;
-                Z_heap_start = (char*)p;
-                Z_heap_end = Z_heap_start + i;
-                return Z_chunk_alloc(size, nblock);
+inline size_t pool_allocator::trim(size_t retain_bytes, bool unmap) {
+    flush_thread_cache();
+
+    span* victims = nullptr;
+    span* stale = nullptr;      // 物理页已经归还、这次解除映射的 span
+    size_t count = 0;
+    {
+        std::lock_guard<spin_lock> guard(Z_lock);
+        while (Z_empty != nullptr && Z_empty_bytes > retain_bytes) {
+            span* s = Z_empty;
+            Z_list_remove(Z_empty, s);
+            Z_empty_bytes -= Z_span_bytes;
+            Z_list_push(victims, s);
+            ++count;
+        }
+        if (unmap && Z_released != nullptr) {
+            stale = Z_released;
+            Z_released = nullptr;
+            Z_reserved_bytes -= Z_released_count * Z_span_bytes;
+            Z_released_count = 0;
+        }
+    }
+    if (count == 0 && stale == nullptr)
+        return 0;
+
+    size_t released = 0;
+    // 只剩 span 头部所在的页还占着物理内存
+    while (stale != nullptr) {
+        span* s = stale;
+        Z_list_remove(stale, s);
+        Z_chunk_free(s);
+        released += Z_page_bytes;
+    }
+
+    span* released_list = nullptr;
+    while (victims != nullptr) {
+        span* s = victims;
+        Z_list_remove(victims, s);
+        if (unmap) {
+            Z_chunk_free(s);
+            released += Z_span_bytes;
+        }
+        else {
+            // span 头部所在的页保留，其余物理页交还操作系统，地址空间留着下次复用
+            madvise(reinterpret_cast<char*>(s) + Z_page_bytes,
+                    Z_span_bytes - Z_page_bytes, MADV_DONTNEED);
+            Z_list_push(released_list, s);
+            released += Z_span_bytes - Z_page_bytes;
+        }
+    }
+
+    std::lock_guard<spin_lock> guard(Z_lock);
+    if (unmap)
+        Z_reserved_bytes -= count * Z_span_bytes;
+    while (released_list != nullptr) {
+        span* s = released_list;
+        Z_list_remove(released_list, s);
+        Z_list_push(Z_released, s);
+        ++Z_released_count;
+    }
+    Z_released_bytes += released;
+    return released;
+}
+
+// 调用者需持有 Z_lock
+inline void pool_allocator::Z_note_in_use() {
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    if (Z_in_use_bytes > Z_in_use_high_water)
+        Z_in_use_high_water = Z_in_use_bytes;
+#endif
+}
+
+// 各线程的计数在读取时才汇总，读到的是一个近似的快照：线程在汇总过程中仍可能继续分配
+inline pool_stats pool_allocator::stats() {
+    pool_stats result = pool_stats();
+    for (size_t i = 0; i < Z_free_list_size; ++i)
+        result.classes[i].size = Z_align_size_list[i];
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    {
+        std::lock_guard<spin_lock> guard(Z_stats_lock);
+        for (size_t i = 0; i < Z_free_list_size; ++i) {
+            result.classes[i].allocations = Z_retired_allocations[i];
+            result.classes[i].deallocations = Z_retired_deallocations[i];
+        }
+        for (thread_cache* c = Z_caches; c != nullptr; c = c->next_) {
+            for (size_t i = 0; i < Z_free_list_size; ++i) {
+                result.classes[i].allocations += c->allocations_[i].get();
+                result.classes[i].deallocations += c->deallocations_[i].get();
             }
         }
-        puts("out of memory");
-        Z_heap_start = Z_heap_end = nullptr;
-        throw std::bad_alloc();
     }
-    Z_heap_end = Z_heap_start + require_size;
-    Z_heap_size  += require_size;
-    return Z_chunk_alloc(size, nblock);
+#endif
+
+    std::lock_guard<spin_lock> guard(Z_lock);
+    result.reserved_bytes = Z_reserved_bytes;
+    result.in_use_bytes = Z_in_use_bytes;
+    result.free_bytes = Z_empty_bytes;
+    result.released_bytes = Z_released_bytes;
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    result.reserved_high_water = Z_reserved_high_water;
+    result.in_use_high_water = Z_in_use_high_water;
+    result.span_allocations = Z_span_allocations;
+    for (size_t i = 0; i < Z_free_list_size; ++i) {
+        pool_class_stats& c = result.classes[i];
+        // 一个线程分配、另一个线程释放时，两边的计数可能先后被读到
+        c.live = c.allocations > c.deallocations ? c.allocations - c.deallocations : 0;
+        c.refills = Z_refills[i];
+        c.cached = Z_cached[i];
+        c.cached_high_water = Z_cached_high_water[i];
+        result.refills += c.refills;
+        result.live_bytes += c.live * c.size;
+    }
+    size_t resident = Z_reserved_bytes - Z_released_count * (Z_span_bytes - Z_page_bytes);
+    if (resident > 0)
+        result.fragmentation = 1.0 - static_cast<double>(result.live_bytes) / resident;
+#endif
+    return result;
 }
 
+// 后台 trim 线程，进程退出时自动停止
+class pool_trimmer {
+
+public:
+    pool_trimmer() : running_(false) {}
+
+    ~pool_trimmer() { stop(); }
+
+    void start(const trim_policy& policy) {
+        stop();
+        std::lock_guard<std::mutex> guard(mutex_);
+        policy_ = policy;
+        running_ = true;
+        thread_ = std::thread(&pool_trimmer::run, this);
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (!running_) return ;
+            running_ = false;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    static pool_trimmer& instance() {
+        static pool_trimmer trimmer;
+        return trimmer;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            cv_.wait_for(lock, std::chrono::milliseconds(policy_.interval_ms));
+            if (!running_)
+                break;
+            trim_policy policy = policy_;
+            lock.unlock();
+            if (pool_allocator::free_bytes() > policy.trigger_bytes)
+                pool_allocator::trim(policy.retain_bytes, policy.unmap);
+            lock.lock();
+        }
+    }
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    trim_policy policy_;
+    bool running_;
+};
 
+inline void pool_allocator::start_background_trim(const trim_policy& policy) {
+    pool_trimmer::instance().start(policy);
+}
+
+inline void pool_allocator::stop_background_trim() {
+    pool_trimmer::instance().stop();
+}
+
+inline thread_cache& thread_cache::current() {
+    static thread_local thread_cache cache;
+    return cache;
+}
+
+inline bool& thread_cache::destroyed() {
+    static thread_local bool flag = false;
+    return flag;
+}
+
+inline thread_cache::thread_cache() {
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    std::lock_guard<spin_lock> guard(pool_allocator::Z_stats_lock);
+    prev_ = nullptr;
+    next_ = pool_allocator::Z_caches;
+    if (next_ != nullptr)
+        next_->prev_ = this;
+    pool_allocator::Z_caches = this;
+#endif
+}
+
+// 线程退出：块交还中心链表，计数并入 Z_retired_*
+inline thread_cache::~thread_cache() {
+    flush();
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    std::lock_guard<spin_lock> guard(pool_allocator::Z_stats_lock);
+    for (size_t i = 0; i < Z_free_list_size; ++i) {
+        pool_allocator::Z_retired_allocations[i] += allocations_[i].get();
+        pool_allocator::Z_retired_deallocations[i] += deallocations_[i].get();
+    }
+    if (prev_ != nullptr)
+        prev_->next_ = next_;
+    else
+        pool_allocator::Z_caches = next_;
+    if (next_ != nullptr)
+        next_->prev_ = prev_;
+#endif
+    destroyed() = true;
+}
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+inline void thread_cache::retire(size_t index, uint64_t allocations, uint64_t deallocations) {
+    std::lock_guard<spin_lock> guard(pool_allocator::Z_stats_lock);
+    pool_allocator::Z_retired_allocations[index] += allocations;
+    pool_allocator::Z_retired_deallocations[index] += deallocations;
+}
+#endif
+
+inline void* thread_cache::allocate(size_t index) {
+    ZEPHYR_STAT(allocations_[index].add());
+    free_list& list = lists_[index];
+    Obj* result = list.head;
+    if (result == nullptr) {
+        if (list.carve != list.carve_end) {
+            void* r = list.carve;
+            list.carve += pool_allocator::Z_align_size_list[index];
+            return r;
+        }
+        return fetch_from_central(index);
+    }
+    list.head = result->free_list_next;
+    --list.length;
+    return result;
+}
+
+inline void thread_cache::deallocate(void* p, size_t index) {
+    Obj* q = (Obj*)p;
+    if (destroyed()) {
+        ZEPHYR_STAT(retire(index, 0, 1));
+        q->free_list_next = nullptr;
+        pool_allocator::Z_release(index, q);
+        return ;
+    }
+    ZEPHYR_STAT(deallocations_[index].add());
+    free_list& list = lists_[index];
+    q->free_list_next = list.head;
+    list.head = q;
+    // 链表超过两批时，归还一批给中心链表，避免内存囤积在某个线程里
+    size_t n = pool_allocator::Z_align_size_list[index];
+    if (++list.length > 2 * pool_allocator::Z_batch_size(n))
+        release_to_central(index, pool_allocator::Z_batch_size(n));
+}
+
+// 依次取本地链表、本地未切分区域，不够时向中心链表一次要够剩下的个数
+template <typename T>
+inline void thread_cache::allocate_bulk(size_t index, T** out, size_t n) {
+    // 缓存析构后链表都是空的，下面直接向中心链表要够 n 个
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    if (destroyed())
+        retire(index, n, 0);
+    else
+        allocations_[index].add(n);
+#endif
+    free_list& list = lists_[index];
+    size_t size = pool_allocator::Z_align_size_list[index];
+    size_t i = 0;
+
+    Obj* q = list.head;
+    for (; i < n && q != nullptr; ++i) {
+        out[i] = static_cast<T*>(static_cast<void*>(q));
+        q = q->free_list_next;
+    }
+    list.head = q;
+    list.length -= i;
+
+    for (; i < n && list.carve != list.carve_end; ++i) {
+        out[i] = static_cast<T*>(static_cast<void*>(list.carve));
+        list.carve += size;
+    }
+
+    while (i < n) {
+        Obj* head = nullptr;
+        Obj* tail = nullptr;
+        char* region = nullptr;
+        size_t count = pool_allocator::Z_fetch(index, n - i, head, tail, region);
+        if (region != nullptr) {
+            for (size_t k = 0; k < count; ++k)
+                out[i++] = static_cast<T*>(static_cast<void*>(region + k * size));
+        }
+        else {
+            for (Obj* o = head; o != nullptr; o = o->free_list_next)
+                out[i++] = static_cast<T*>(static_cast<void*>(o));
+        }
+    }
+}
+
+// 先串成一条链表；放进本地链表会超过上限时，整条链表一次加锁交还中心链表
+template <typename T>
+inline void thread_cache::deallocate_bulk(size_t index, T** in, size_t n) {
+    if (n == 0) return ;
+    bool dead = destroyed();
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    if (dead)
+        retire(index, 0, n);
+    else
+        deallocations_[index].add(n);
+#endif
+    Obj* head = static_cast<Obj*>(static_cast<void*>(in[0]));
+    Obj* tail = head;
+    for (size_t i = 1; i < n; ++i) {
+        Obj* q = static_cast<Obj*>(static_cast<void*>(in[i]));
+        tail->free_list_next = q;
+        tail = q;
+    }
+
+    free_list& list = lists_[index];
+    size_t size = pool_allocator::Z_align_size_list[index];
+    if (!dead && list.length + n <= 2 * pool_allocator::Z_batch_size(size)) {
+        tail->free_list_next = list.head;
+        list.head = head;
+        list.length += n;
+        return ;
+    }
+    tail->free_list_next = nullptr;
+    pool_allocator::Z_release(index, head);
+}
+
+inline void* thread_cache::fetch_from_central(size_t index) {
+    size_t n = pool_allocator::Z_align_size_list[index];
+    Obj* head = nullptr;
+    Obj* tail = nullptr;
+    char* region = nullptr;
+    if (destroyed()) {
+        // allocate() 已经把这次分配记在已析构的缓存上，改记到 Z_retired_*
+        ZEPHYR_STAT(retire(index, 1, 0));
+        pool_allocator::Z_fetch(index, 1, head, tail, region);
+        return region != nullptr ? static_cast<void*>(region) : static_cast<void*>(head);
+    }
+    size_t count = pool_allocator::Z_fetch(index, pool_allocator::Z_batch_size(n), head, tail, region);
+
+    free_list& list = lists_[index];
+    if (region != nullptr) {
+        list.carve = region + n;
+        list.carve_end = region + n * count;
+        return region;
+    }
+    list.head = head->free_list_next;
+    list.length = count - 1;
+    return head;
+}
+
+inline void thread_cache::release_to_central(size_t index, size_t n) {
+    free_list& list = lists_[index];
+    Obj* head = list.head;
+    Obj* tail = head;
+    for (size_t i = 1; i < n; ++i)
+        tail = tail->free_list_next;
+    list.head = tail->free_list_next;
+    list.length -= n;
+    tail->free_list_next = nullptr;
+    pool_allocator::Z_release(index, head);
+}
+
+inline void thread_cache::flush() {
+    for (size_t i = 0; i < Z_free_list_size; ++i) {
+        free_list& list = lists_[i];
+        // 还没切分的区域也串起来一并交还
+        size_t n = pool_allocator::Z_align_size_list[i];
+        for (; list.carve != list.carve_end; list.carve += n) {
+            Obj* q = (Obj*)list.carve;
+            q->free_list_next = list.head;
+            list.head = q;
+            ++list.length;
+        }
+        if (list.length > 0)
+            release_to_central(i, list.length);
+    }
+}
+
+// 块按 alignof(T) 对齐
 template<typename T>
 class pool_alloc {
 
 public:
 
+static T* allocate() {
+    return static_cast<T*>(pool_allocator::allocate<sizeof(T), alignof(T)>());
+}
+
 static T* allocate(size_t size) {
-    return static_cast<T*>(pool_allocator::allocate(size * sizeof(T)));
+    if (size == 1)
+        return allocate();
+    return static_cast<T*>(pool_allocator::allocate(size * sizeof(T), alignof(T)));
 }
 
 static void deallocate(T* p, size_t n = 1) {
-    pool_allocator::deallocate(static_cast<void*>(p), n * sizeof(T));
+    if (n == 1)
+        pool_allocator::deallocate<sizeof(T), alignof(T)>(static_cast<void*>(p));
+    else
+        pool_allocator::deallocate(static_cast<void*>(p), n * sizeof(T), alignof(T));
 }
 
+// 一次分配、释放 n 个对象，每个对象单独一块
+static void allocate_bulk(T** out, size_t n) {
+    if (block_bytes == 0) {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = allocate();
+        return ;
+    }
+    pool_allocator::allocate_bulk(block_bytes, out, n);
+}
+
+static void deallocate_bulk(T** in, size_t n) {
+    if (block_bytes == 0) {
+        for (size_t i = 0; i < n; ++i)
+            deallocate(in[i]);
+        return ;
+    }
+    pool_allocator::deallocate_bulk(block_bytes, in, n);
+}
+
+private:
+// 满足 alignof(T) 的分级的块大小，按它批量分配与逐个按 (sizeof(T), alignof(T)) 分配落在同一分级；pool 放不下时为 0
+static constexpr size_t block_bytes =
+        pool_allocator::Z_pooled(sizeof(T), alignof(T))
+        ? pool_allocator::Z_class_size(pool_allocator::Z_aligned_index(sizeof(T), alignof(T))) : 0;
+
 };
 
+template <typename T>
+constexpr size_t pool_alloc<T>::block_bytes;
+
 } // namespace zephyr
 
 
@@ -0,0 +1,92 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_SPAN_MAP_H
+#define ZEPHYR_SPAN_MAP_H
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#include <sys/mman.h>
+
+// 这个头文件包含 span_map：记录地址空间中每个 2^span_map_shift 字节的对齐单元属于谁
+//
+// 只凭一个指针判断它是不是 zephyr 分配的（例如 free 一个来源未知的指针），不能直接去读所在 span 的头部：
+// 那块地址可能根本没有映射。span_map 是两级基数表，覆盖 48 位地址空间，第二级按需 mmap，
+// 查询只有两次加载、不加锁、不会访问未映射的内存
+
+namespace zephyr
+{
+
+enum { span_map_shift = 18 };
+
+enum class span_kind : unsigned char {
+    none = 0,
+    pool = 1,       // pool_allocator 的 span
+    large = 2       // global_allocator 直接映射的大块，头部在单元起点
+};
+
+class span_map {
+
+public:
+    // 标记 unit 所在的单元，unit 按 2^span_map_shift 对齐
+    static void set(const void* unit, span_kind kind) {
+        uintptr_t i = reinterpret_cast<uintptr_t>(unit) >> span_map_shift;
+        if (i >> (2 * level_bits) != 0)
+            return ;
+        std::atomic<unsigned char>* leaf = leaf_of(i >> level_bits, kind != span_kind::none);
+        if (leaf != nullptr)
+            leaf[i & (level_size - 1)].store(static_cast<unsigned char>(kind), std::memory_order_release);
+    }
+
+    // p 所在单元的标记，从未标记过的地址返回 none
+    static span_kind get(const void* p) {
+        uintptr_t i = reinterpret_cast<uintptr_t>(p) >> span_map_shift;
+        if (i >> (2 * level_bits) != 0)
+            return span_kind::none;
+        std::atomic<unsigned char>* leaf = top()[i >> level_bits].load(std::memory_order_acquire);
+        if (leaf == nullptr)
+            return span_kind::none;
+        return static_cast<span_kind>(leaf[i & (level_size - 1)].load(std::memory_order_acquire));
+    }
+
+private:
+    // 48 位地址空间去掉单元内的偏移后还剩 30 位，两级各 15 位
+    enum { level_bits = (48 - span_map_shift) / 2 };
+    enum { level_size = 1 << level_bits };
+
+    typedef std::atomic<std::atomic<unsigned char>*> slot;
+
+    // 常量初始化，没有线程安全的静态初始化检查
+    static slot* top() {
+        static slot table[level_size];
+        return table;
+    }
+
+    // 第二级直接 mmap，不经过 malloc，global_allocator 替换了 malloc 时也不会递归；
+    // 两个线程同时创建时，后到者解除自己的映射
+    static std::atomic<unsigned char>* leaf_of(uintptr_t index, bool create) {
+        slot& s = top()[index];
+        std::atomic<unsigned char>* leaf = s.load(std::memory_order_acquire);
+        if (leaf != nullptr || !create)
+            return leaf;
+        const size_t bytes = level_size * sizeof(std::atomic<unsigned char>);
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        std::atomic<unsigned char>* fresh = static_cast<std::atomic<unsigned char>*>(p);
+        if (!s.compare_exchange_strong(leaf, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            ::munmap(p, bytes);
+            return leaf;
+        }
+        return fresh;
+    }
+};
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_SPAN_MAP_H
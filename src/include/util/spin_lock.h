@@ -0,0 +1,46 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_SPIN_LOCK_H
+#define ZEPHYR_SPIN_LOCK_H
+
+#include <atomic>
+#include <thread>
+
+// 这个头文件包含一个轻量级自旋锁 spin_lock，满足 BasicLockable，可以配合 std::lock_guard 使用
+// 只用于保护很短的临界区（例如分配器的中心空闲链表）
+
+namespace zephyr
+{
+
+class spin_lock {
+
+public:
+    spin_lock() = default;
+    spin_lock(const spin_lock&) = delete;
+    spin_lock& operator=(const spin_lock&) = delete;
+
+    void lock() {
+        while (flag_.test_and_set(std::memory_order_acquire)) {
+            // 持有者可能被调度出去，让出时间片而不是空转
+            std::this_thread::yield();
+        }
+    }
+
+    bool try_lock() {
+        return !flag_.test_and_set(std::memory_order_acquire);
+    }
+
+    void unlock() {
+        flag_.clear(std::memory_order_release);
+    }
+
+private:
+    std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+};
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_SPIN_LOCK_H
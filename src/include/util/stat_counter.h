@@ -0,0 +1,47 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#ifndef ZEPHYR_STAT_COUNTER_H
+#define ZEPHYR_STAT_COUNTER_H
+
+#include <stdint.h>
+#include <atomic>
+
+// 这个头文件包含分配器统计用的计数器 stat_counter 与开关宏 ZEPHYR_STAT
+//
+// 定义 ZEPHYR_NO_ALLOCATOR_STATS 时所有统计代码都不参与编译，ZEPHYR_STAT(expr) 展开为空
+
+#ifndef ZEPHYR_NO_ALLOCATOR_STATS
+#define ZEPHYR_ALLOCATOR_STATS 1
+#define ZEPHYR_STAT(expr) expr
+#else
+#define ZEPHYR_STAT(expr)
+#endif
+
+namespace zephyr
+{
+
+// 只有一个线程写、任意线程可读的计数器
+// 写端用 relaxed 的 load + store 代替原子加法，快路径上没有带 lock 前缀的指令，读端也不会读到撕裂的值
+class stat_counter {
+
+public:
+    stat_counter() : value_(0) {}
+
+    void add(uint64_t n = 1) {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_;
+};
+
+} // namespace zephyr
+
+
+#endif //ZEPHYR_STAT_COUNTER_H
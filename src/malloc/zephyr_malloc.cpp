@@ -0,0 +1,227 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+// 用 global_allocator 替换全局的 operator new / delete；定义 ZEPHYR_REPLACE_MALLOC 时同时替换
+// malloc、free、calloc、realloc、posix_memalign 等
+//
+// 目标文件 zephyr_malloc 直接链接进程序即可生效；共享库 libzephyr_malloc.so 用 LD_PRELOAD 加载，
+// 编译时使用 -ftls-model=initial-exec，线程缓存的 TLS 访问不会再调用 malloc
+//
+// 定义 ZEPHYR_ALLOCATOR_TRACE 时，环境变量 ZEPHYR_TRACE 指定的文件（%p 换成进程号）在加载时开始记录
+// 分配事件，ZEPHYR_TRACE_EVENTS 指定环的容量（事件数），见 alloc_trace.h
+// 定义 ZEPHYR_HEAP_PROFILE 时，环境变量 ZEPHYR_HEAP_PROFILE 指定的文件在加载时开始堆采样、在退出时写出，
+// ZEPHYR_HEAP_PROFILE_RATE 指定采样间隔（字节），见 heap_profiler.h
+
+#include <new>
+#include <errno.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/memory/global_allocator.h"
+
+#define ZEPHYR_EXPORT __attribute__((visibility("default")))
+
+namespace
+{
+
+// 分配失败时按标准调用 new_handler，没有 new_handler 时抛出 std::bad_alloc
+void* new_or_throw(size_t n, size_t align) {
+    for (;;) {
+        void* p = zephyr::global_allocator::allocate_aligned(align, n);
+        if (p != nullptr)
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* new_nothrow(size_t n, size_t align) noexcept {
+    try {
+        return new_or_throw(n, align);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+#if defined(ZEPHYR_ALLOCATOR_TRACE) || defined(ZEPHYR_HEAP_PROFILE)
+// 把 pattern 中的 %p 换成进程号写入 path，返回是否出现过 %p。不分配内存
+bool expand_pid(const char* pattern, char* path, size_t size) {
+    char pid[24];
+    size_t pid_len = 0;
+    for (unsigned long v = static_cast<unsigned long>(getpid()); v != 0 || pid_len == 0; v /= 10)
+        pid[pid_len++] = static_cast<char>('0' + v % 10);
+    bool per_process = false;
+    size_t len = 0;
+    for (const char* c = pattern; *c != '\0'; ++c) {
+        if (c[0] == '%' && c[1] == 'p') {
+            for (size_t i = pid_len; i > 0 && len + 1 < size; --i)
+                path[len++] = pid[i - 1];
+            per_process = true;
+            ++c;
+        }
+        else if (len + 1 < size)
+            path[len++] = *c;
+    }
+    path[len] = '\0';
+    return per_process;
+}
+#endif
+
+#ifdef ZEPHYR_ALLOCATOR_TRACE
+// 文件名中的 %p 换成进程号，每个子进程各写一个文件；没有 %p 时启动后删掉环境变量，
+// 否则继承了它的子进程会截断父进程正在写的文件
+__attribute__((constructor)) void start_trace_from_environment() {
+    const char* pattern = getenv("ZEPHYR_TRACE");
+    if (pattern == nullptr || *pattern == '\0')
+        return ;
+    char path[4096];
+    bool per_process = expand_pid(pattern, path, sizeof(path));
+    const char* events = getenv("ZEPHYR_TRACE_EVENTS");
+    size_t capacity = events != nullptr ? static_cast<size_t>(strtoull(events, nullptr, 10)) : 0;
+    zephyr::alloc_trace::start(path, capacity != 0 ? capacity : size_t(1) << 20);
+    if (!per_process)
+        unsetenv("ZEPHYR_TRACE");
+}
+#endif
+
+#ifdef ZEPHYR_HEAP_PROFILE
+char heap_profile_path[4096];
+
+// 加载时开始采样，退出时写出；文件名以 .folded 结尾时写折叠栈，否则写 pprof 格式
+__attribute__((constructor)) void start_heap_profile_from_environment() {
+    const char* pattern = getenv("ZEPHYR_HEAP_PROFILE");
+    if (pattern == nullptr || *pattern == '\0')
+        return ;
+    if (!expand_pid(pattern, heap_profile_path, sizeof(heap_profile_path)))
+        unsetenv("ZEPHYR_HEAP_PROFILE");
+    const char* rate = getenv("ZEPHYR_HEAP_PROFILE_RATE");
+    size_t bytes = rate != nullptr ? static_cast<size_t>(strtoull(rate, nullptr, 10)) : 0;
+    if (!zephyr::heap_profiler::start(bytes != 0 ? bytes : size_t(zephyr::heap_profiler::default_sample_bytes)))
+        heap_profile_path[0] = '\0';
+}
+
+__attribute__((destructor)) void dump_heap_profile() {
+    if (heap_profile_path[0] == '\0')
+        return ;
+    size_t len = strlen(heap_profile_path);
+    bool folded = len >= 7 && strcmp(heap_profile_path + len - 7, ".folded") == 0;
+    if (folded)
+        zephyr::heap_profiler::dump_folded(heap_profile_path);
+    else
+        zephyr::heap_profiler::dump_pprof(heap_profile_path);
+}
+#endif
+
+} // namespace
+
+ZEPHYR_EXPORT void* operator new(size_t n) { return new_or_throw(n, zephyr::global_allocator::min_align); }
+ZEPHYR_EXPORT void* operator new[](size_t n) { return new_or_throw(n, zephyr::global_allocator::min_align); }
+ZEPHYR_EXPORT void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    return new_nothrow(n, zephyr::global_allocator::min_align);
+}
+ZEPHYR_EXPORT void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+    return new_nothrow(n, zephyr::global_allocator::min_align);
+}
+
+ZEPHYR_EXPORT void operator delete(void* p) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete[](void* p) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete(void* p, const std::nothrow_t&) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete[](void* p, const std::nothrow_t&) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete(void* p, size_t) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete[](void* p, size_t) noexcept { zephyr::global_allocator::deallocate(p); }
+
+#ifdef __cpp_aligned_new
+ZEPHYR_EXPORT void* operator new(size_t n, std::align_val_t align) {
+    return new_or_throw(n, static_cast<size_t>(align));
+}
+ZEPHYR_EXPORT void* operator new[](size_t n, std::align_val_t align) {
+    return new_or_throw(n, static_cast<size_t>(align));
+}
+ZEPHYR_EXPORT void* operator new(size_t n, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return new_nothrow(n, static_cast<size_t>(align));
+}
+ZEPHYR_EXPORT void* operator new[](size_t n, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return new_nothrow(n, static_cast<size_t>(align));
+}
+
+ZEPHYR_EXPORT void operator delete(void* p, std::align_val_t) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete[](void* p, std::align_val_t) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete(void* p, size_t, std::align_val_t) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete[](void* p, size_t, std::align_val_t) noexcept { zephyr::global_allocator::deallocate(p); }
+ZEPHYR_EXPORT void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    zephyr::global_allocator::deallocate(p);
+}
+ZEPHYR_EXPORT void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    zephyr::global_allocator::deallocate(p);
+}
+#endif
+
+#ifdef ZEPHYR_REPLACE_MALLOC
+extern "C" {
+
+ZEPHYR_EXPORT void* malloc(size_t n) noexcept {
+    return zephyr::global_allocator::allocate(n);
+}
+
+ZEPHYR_EXPORT void free(void* p) noexcept {
+    zephyr::global_allocator::deallocate(p);
+}
+
+ZEPHYR_EXPORT void* calloc(size_t count, size_t size) noexcept {
+    return zephyr::global_allocator::allocate_zeroed(count, size);
+}
+
+ZEPHYR_EXPORT void* realloc(void* p, size_t n) noexcept {
+    return zephyr::global_allocator::reallocate(p, n);
+}
+
+ZEPHYR_EXPORT int posix_memalign(void** out, size_t align, size_t n) noexcept {
+    if (align < sizeof(void*) || (align & (align - 1)) != 0)
+        return EINVAL;
+    void* p = zephyr::global_allocator::allocate_aligned(align, n);
+    if (p == nullptr)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+ZEPHYR_EXPORT void* aligned_alloc(size_t align, size_t n) noexcept {
+    if (align == 0 || (align & (align - 1)) != 0) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return zephyr::global_allocator::allocate_aligned(align, n);
+}
+
+ZEPHYR_EXPORT void* memalign(size_t align, size_t n) noexcept {
+    return aligned_alloc(align, n);
+}
+
+ZEPHYR_EXPORT void* valloc(size_t n) noexcept {
+    return zephyr::global_allocator::allocate_aligned(static_cast<size_t>(sysconf(_SC_PAGESIZE)), n);
+}
+
+ZEPHYR_EXPORT void* pvalloc(size_t n) noexcept {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return zephyr::global_allocator::allocate_aligned(page, (n + page - 1) & ~(page - 1));
+}
+
+ZEPHYR_EXPORT size_t malloc_usable_size(void* p) noexcept {
+    return zephyr::global_allocator::usable_size(p);
+}
+
+// 归还缓存的大块映射与 pool 中完全空闲的 span，pool 保留 pad 字节；有内存归还时返回 1
+ZEPHYR_EXPORT int malloc_trim(size_t pad) noexcept {
+    size_t released = zephyr::global_allocator::trim();
+    released += zephyr::pool_allocator::trim(pad);
+    return released != 0;
+}
+
+} // extern "C"
+#endif
@@ -0,0 +1,149 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <map>
+
+#include "../src/include/memory/allocator.h"
+
+namespace zephyr
+{
+
+namespace align_test
+{
+
+struct alignas(32) vec8 {
+    float lane[8];
+};
+
+struct alignas(64) line {
+    char bytes[72];
+};
+
+template <typename T>
+bool aligned(const T* p, size_t align) {
+    return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+size_t pool_align_test() {
+    size_t errors = 0;
+    for (size_t i = 0; i < Z_free_list_size; ++i)
+        errors += (pool_allocator::Z_class_size(i) != pool_allocator::class_size(i));
+
+    const size_t aligns[] = { 8, 16, 32, 64, 128, 4096 };
+    const size_t sizes[] = { 1, 8, 24, 40, 100, 130, 200, 1000, 5000, 40000 };
+    std::vector<void*> blocks;
+    for (size_t a : aligns) {
+        for (size_t n : sizes) {
+            for (int k = 0; k < 8; ++k) {
+                void* p = pool_allocator::allocate(n, a);
+                errors += !aligned(static_cast<char*>(p), a);
+                blocks.push_back(p);
+            }
+        }
+    }
+    size_t b = 0;
+    for (size_t a : aligns)
+        for (size_t n : sizes)
+            for (int k = 0; k < 8; ++k)
+                pool_allocator::deallocate(blocks[b++], n, a);
+
+    // 缓存行填充的块：按缓存行对齐，且与相邻的块不共享缓存行
+    void* x = pool_allocator::allocate_padded(8);
+    void* y = pool_allocator::allocate_padded(8);
+    errors += !aligned(static_cast<char*>(x), Z_cache_line) || !aligned(static_cast<char*>(y), Z_cache_line);
+    errors += (x == y);
+    pool_allocator::deallocate_padded(x, 8);
+    pool_allocator::deallocate_padded(y, 8);
+
+    std::vector<vec8*> v(100);
+    pool_alloc<vec8>::allocate_bulk(v.data(), v.size());
+    for (vec8* p : v)
+        errors += !aligned(p, alignof(vec8));
+    pool_alloc<vec8>::deallocate_bulk(v.data(), v.size());
+    return errors;
+}
+
+size_t typed_align_test() {
+    size_t errors = 0;
+    for (int i = 0; i < 100; ++i) {
+        line* a = loki_alloc<line>::allocate();
+        vec8* b = loki_alloc<vec8>::allocate();
+        line* c = pool_alloc<line>::allocate();
+        errors += !aligned(a, 64) || !aligned(b, 32) || !aligned(c, 64);
+        loki_alloc<line>::deallocate(a);
+        loki_alloc<vec8>::deallocate(b);
+        pool_alloc<line>::deallocate(c);
+    }
+
+    // 三种来源的 allocator<T> 都按 alignof(T) 对齐
+    zephyr::arena a;
+    zephyr::allocator<vec8> sources[] = {
+        zephyr::allocator<vec8>(),
+        zephyr::allocator<vec8>::per_thread(),
+        zephyr::allocator<vec8>(a)
+    };
+    for (zephyr::allocator<vec8>& alloc : sources) {
+        std::vector<vec8, zephyr::allocator<vec8>> v(alloc);
+        std::map<int, vec8, std::less<int>, zephyr::allocator<std::pair<const int, vec8>>> m(alloc);
+        for (int i = 0; i < 1000; ++i) {
+            v.emplace_back();
+            errors += !aligned(&m[i], alignof(vec8));
+        }
+        errors += !aligned(v.data(), alignof(vec8));
+    }
+    return errors;
+}
+
+enum { INCREMENTS = 5000000 };
+
+// 两个线程各自累加一个计数器；计数器在相邻的 8 字节块中时落在同一条缓存行上
+double false_sharing_ns(std::atomic<uint64_t>* a, std::atomic<uint64_t>* b) {
+    auto work = [](std::atomic<uint64_t>* c) {
+        for (int i = 0; i < INCREMENTS; ++i)
+            c->store(c->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    };
+    auto t0 = std::chrono::steady_clock::now();
+    std::thread first(work, a), second(work, b);
+    first.join();
+    second.join();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / INCREMENTS;
+}
+
+void false_sharing_benchmark() {
+    typedef std::atomic<uint64_t> counter;
+    void* a = pool_allocator::allocate(sizeof(counter));
+    void* b = pool_allocator::allocate(sizeof(counter));
+    void* c = pool_allocator::allocate_padded(sizeof(counter));
+    void* d = pool_allocator::allocate_padded(sizeof(counter));
+    counter* packed[] = { ::new(a) counter(0), ::new(b) counter(0) };
+    counter* padded[] = { ::new(c) counter(0), ::new(d) counter(0) };
+
+    double shared = false_sharing_ns(packed[0], packed[1]);
+    double alone = false_sharing_ns(padded[0], padded[1]);
+    std::cout << "two-thread counters, ns/increment: 8-byte class " << std::fixed << std::setprecision(2)
+              << shared << ", cache-line padded " << alone << std::endl;
+
+    pool_allocator::deallocate(a, sizeof(counter));
+    pool_allocator::deallocate(b, sizeof(counter));
+    pool_allocator::deallocate_padded(c, sizeof(counter));
+    pool_allocator::deallocate_padded(d, sizeof(counter));
+}
+
+void align_test() {
+    size_t errors = pool_align_test() + typed_align_test();
+    std::cout << "over-aligned allocation: errors = " << errors << std::endl;
+    false_sharing_benchmark();
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::align_test
+
+} // namespace zephyr
@@ -3,6 +3,12 @@
 //
 
 #include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstring>
 
 #include "../src/include/memory/pool_allocator.h"
 #include "../src/include/memory/loki_allocator.h"
@@ -17,6 +23,14 @@ void* operator new(size_t size) {
     return std::malloc(size);
 }
 
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
 namespace zephyr
 {
 
@@ -81,6 +95,168 @@ void alloc_test() {
     std::cout << "after" << std::endl;
 }
 
+// 尺寸分级在编译期可求值，且覆盖 1 ~ 32 KiB 的每个大小
+static_assert(zephyr::pool_allocator::Z_class_index(24) == 2, "24 bytes -> 24-byte class");
+static_assert(zephyr::pool_allocator::Z_class_index(129) == 16, "129 bytes -> 160-byte class");
+static_assert(zephyr::pool_allocator::Z_class_index(32768) == zephyr::Z_free_list_size - 1,
+              "32 KiB is the largest class");
+
+void size_class_test() {
+    std::vector<std::pair<char*, size_t>> blocks;
+    for (size_t n = 1; n <= zephyr::Z_max_bytes; n += 7) {
+        char* q = static_cast<char*>(zephyr::pool_allocator::allocate(n));
+        memset(q, static_cast<int>(n & 0xff), n);
+        blocks.emplace_back(q, n);
+    }
+    size_t broken = 0;
+    for (auto& b : blocks) {
+        for (size_t i = 0; i < b.second; i++)
+            broken += (static_cast<unsigned char>(b.first[i]) != (b.second & 0xff));
+        zephyr::pool_allocator::deallocate(b.first, b.second);
+    }
+
+    // 超过 32 KiB 的请求交给 operator new 或 mmap，且不再丢失请求的大小
+    size_t large = 100000;
+    char* q = static_cast<char*>(zephyr::pool_allocator::allocate(large));
+    memset(q, 0x5a, large);
+    zephyr::pool_allocator::deallocate(q, large);
+
+    std::cout << "size classes 1 ~ " << zephyr::Z_max_bytes << ": " << blocks.size()
+              << " blocks, corrupted bytes = " << broken << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+enum { BULK = 1024 };
+enum { BULK_ROUNDS = 2000 };
+
+// 每轮分配 BULK 个对象再全部释放，返回每个对象的纳秒数
+template <typename Alloc, typename Dealloc>
+double bulk_round(Alloc alloc, Dealloc dealloc) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < BULK_ROUNDS; r++) {
+        alloc();
+        dealloc();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (2.0 * BULK_ROUNDS * BULK);
+}
+
+// 批量接口与逐个调用的对比；批量分配的块应当互不重叠
+void bulk_test() {
+    test_node** q = p;
+    size_t broken = 0;
+
+    zephyr::pool_alloc<test_node>::allocate_bulk(q, BULK);
+    zephyr::loki_alloc<test_node>::allocate_bulk(q + BULK, BULK);
+    for (int i = 0; i < 2 * BULK; i++)
+        q[i]->data3 = i;
+    for (int i = 0; i < 2 * BULK; i++)
+        broken += (q[i]->data3 != i);
+    std::vector<test_node*> sorted(q, q + 2 * BULK);
+    std::sort(sorted.begin(), sorted.end());
+    broken += (std::unique(sorted.begin(), sorted.end()) != sorted.end());
+    zephyr::pool_alloc<test_node>::deallocate_bulk(q, BULK);
+    zephyr::loki_alloc<test_node>::deallocate_bulk(q + BULK, BULK);
+
+    // 其他线程分配的块：按 chunk 串成一段交给 remote 链表
+    std::thread producer([q]() {
+        zephyr::loki_alloc<test_node>::allocate_bulk(q, BULK);
+        zephyr::pool_alloc<test_node>::allocate_bulk(q + BULK, BULK);
+    });
+    producer.join();
+    zephyr::loki_alloc<test_node>::deallocate_bulk(q, BULK);
+    zephyr::pool_alloc<test_node>::deallocate_bulk(q + BULK, BULK);
+
+    double pool_one = bulk_round(
+            [q]() { for (int i = 0; i < BULK; i++) q[i] = zephyr::pool_alloc<test_node>::allocate(); },
+            [q]() { for (int i = 0; i < BULK; i++) zephyr::pool_alloc<test_node>::deallocate(q[i]); });
+    double pool_bulk = bulk_round(
+            [q]() { zephyr::pool_alloc<test_node>::allocate_bulk(q, BULK); },
+            [q]() { zephyr::pool_alloc<test_node>::deallocate_bulk(q, BULK); });
+    double loki_one = bulk_round(
+            [q]() { for (int i = 0; i < BULK; i++) q[i] = zephyr::loki_alloc<test_node>::allocate(); },
+            [q]() { for (int i = 0; i < BULK; i++) zephyr::loki_alloc<test_node>::deallocate(q[i]); });
+    double loki_bulk = bulk_round(
+            [q]() { zephyr::loki_alloc<test_node>::allocate_bulk(q, BULK); },
+            [q]() { zephyr::loki_alloc<test_node>::deallocate_bulk(q, BULK); });
+
+    std::cout << "bulk of " << BULK << ": corrupted = " << broken << std::fixed << std::setprecision(2)
+              << ", ns/op pool " << pool_one << " -> " << pool_bulk
+              << ", loki " << loki_one << " -> " << loki_bulk << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+size_t reallocate_check() {
+    size_t errors = 0;
+    // 同一分级内原地返回
+    char* p = static_cast<char*>(zephyr::pool_allocator::allocate(100));
+    errors += (zephyr::pool_allocator::reallocate(p, 100, 104) != p);
+
+    // 依次经过小分级、operator new、mmap 再缩回来，内容保持不变
+    const size_t sizes[] = { 104, 3000, 40000, 200000, 5000000, 300000, 50000, 20, 7 };
+    size_t old = 104;
+    for (size_t i = 0; i < old; i++)
+        p[i] = static_cast<char>(i * 7);
+    for (size_t n : sizes) {
+        p = static_cast<char*>(zephyr::pool_allocator::reallocate(p, old, n));
+        size_t keep = old < n ? old : n;
+        for (size_t i = 0; i < keep; i++)
+            errors += (p[i] != static_cast<char>(i * 7));
+        for (size_t i = keep; i < n; i++)
+            p[i] = static_cast<char>(i * 7);
+        old = n;
+    }
+    zephyr::pool_allocator::deallocate(p, old);
+    errors += (zephyr::pool_allocator::reallocate(nullptr, 0, 64) == nullptr);
+    return errors;
+}
+
+enum { GROW_STEP = 64 * 1024 };
+enum { GROW_LIMIT = 8 * 1024 * 1024 };
+
+// 每次追加 GROW_STEP 字节直到 GROW_LIMIT，grow(p, old, new) 返回扩张后的缓冲区，返回总毫秒数
+template <typename Grow, typename Free>
+double grow_buffer(Grow grow, Free release) {
+    auto start = std::chrono::steady_clock::now();
+    char* p = nullptr;
+    size_t size = 0;
+    for (size_t n = GROW_STEP; n <= GROW_LIMIT; n += GROW_STEP) {
+        p = grow(p, size, n);
+        memset(p + size, 1, n - size);
+        size = n;
+    }
+    release(p, size);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void reallocate_test() {
+    size_t errors = reallocate_check();
+
+    double copy = grow_buffer(
+            [](char* p, size_t old, size_t n) {
+                char* q = static_cast<char*>(zephyr::pool_allocator::allocate(n));
+                if (p != nullptr) {
+                    memcpy(q, p, old);
+                    zephyr::pool_allocator::deallocate(p, old);
+                }
+                return q;
+            },
+            [](char* p, size_t n) { zephyr::pool_allocator::deallocate(p, n); });
+    double remap = grow_buffer(
+            [](char* p, size_t old, size_t n) {
+                return static_cast<char*>(zephyr::pool_allocator::reallocate(p, old, n));
+            },
+            [](char* p, size_t n) { zephyr::pool_allocator::deallocate(p, n); });
+    double libc = grow_buffer(
+            [](char* p, size_t, size_t n) { return static_cast<char*>(std::realloc(p, n)); },
+            [](char* p, size_t) { std::free(p); });
+
+    std::cout << "reallocate: errors = " << errors << ", grow to " << GROW_LIMIT / (1024 * 1024)
+              << " MiB by " << GROW_STEP / 1024 << " KiB, ms: allocate + copy " << std::fixed << std::setprecision(2)
+              << copy << ", reallocate " << remap << ", realloc " << libc << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
 } // namespace zephyr::alloc_test
 
 } // namespace zephyr
\ No newline at end of file
@@ -0,0 +1,134 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "../src/include/memory/allocator.h"
+
+namespace zephyr
+{
+
+namespace allocator_test
+{
+
+typedef std::pair<const int, long> value_type;
+
+static_assert(std::is_same<std::allocator_traits<zephyr::allocator<int>>::rebind_alloc<long>,
+                           zephyr::allocator<long>>::value, "rebind");
+static_assert(std::allocator_traits<zephyr::allocator<int>>::propagate_on_container_swap::value,
+              "allocators follow their containers on swap");
+
+// 不同来源的 allocator 不相等，rebind 之后仍然相等
+size_t equality_test() {
+    zephyr::arena a;
+    size_t errors = 0;
+    errors += !(zephyr::allocator<int>() == zephyr::allocator<long>());
+    errors += !(zephyr::allocator<int>(a) == zephyr::allocator<long>(zephyr::allocator<int>(a)));
+    errors += (zephyr::allocator<int>(a) == zephyr::allocator<int>());
+    errors += (zephyr::allocator<int>::per_thread() == zephyr::allocator<int>());
+
+    std::list<std::string, zephyr::allocator<std::string>> l1{zephyr::allocator<std::string>(a)};
+    std::list<std::string, zephyr::allocator<std::string>> l2;
+    l1.push_back("arena");
+    l2.push_back("pool");
+    l1.swap(l2);
+    errors += (l1.front() != "pool" || l2.front() != "arena");
+    errors += (l2.get_allocator() != zephyr::allocator<std::string>(a));
+    return errors;
+}
+
+enum { KEYS = 20000 };
+enum { CHURN = 200000 };
+
+// 先插入 KEYS 个键，再随机地删除一个、插入一个
+template <typename Map>
+double map_churn(Map& map) {
+    std::mt19937 rng(1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < KEYS; i++)
+        map.emplace(i, i);
+    for (int i = 0; i < CHURN; i++) {
+        int key = static_cast<int>(rng() % (2 * KEYS));
+        if (map.erase(key) == 0)
+            map.emplace(key, i);
+    }
+    map.clear();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template <typename List>
+double list_churn(List& list) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < KEYS; i++)
+        list.push_back(i);
+    for (int i = 0; i < CHURN; i++) {
+        list.pop_front();
+        list.push_back(i);
+    }
+    list.clear();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template <template <typename> class Alloc>
+struct containers {
+    typedef std::map<int, long, std::less<int>, Alloc<value_type>> map;
+    typedef std::unordered_map<int, long, std::hash<int>, std::equal_to<int>, Alloc<value_type>> hash_map;
+    typedef std::list<int, Alloc<int>> list;
+};
+
+void report(const char* name, double map, double hash_map, double list) {
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(2)
+              << std::setw(12) << map << std::setw(16) << hash_map << std::setw(12) << list << std::endl;
+}
+
+void churn_benchmark() {
+    std::cout << "allocator     map ms   unordered_map ms     list ms" << std::endl;
+    {
+        containers<std::allocator>::map m;
+        containers<std::allocator>::hash_map h;
+        containers<std::allocator>::list l;
+        report("std", map_churn(m), map_churn(h), list_churn(l));
+    }
+    {
+        containers<zephyr::allocator>::map m;
+        containers<zephyr::allocator>::hash_map h;
+        containers<zephyr::allocator>::list l;
+        report("pool", map_churn(m), map_churn(h), list_churn(l));
+    }
+    {
+        zephyr::allocator<value_type> alloc = zephyr::allocator<value_type>::per_thread();
+        containers<zephyr::allocator>::map m(alloc);
+        containers<zephyr::allocator>::hash_map h(alloc);
+        containers<zephyr::allocator>::list l(alloc);
+        report("thread_pool", map_churn(m), map_churn(h), list_churn(l));
+    }
+    {
+        zephyr::arena a;
+        zephyr::allocator<value_type> alloc(a);
+        containers<zephyr::allocator>::map m(alloc);
+        containers<zephyr::allocator>::hash_map h(alloc);
+        containers<zephyr::allocator>::list l(alloc);
+        report("arena", map_churn(m), map_churn(h), list_churn(l));
+    }
+}
+
+void allocator_test() {
+    std::cout << "zephyr::allocator rebind / equality / swap: errors = " << equality_test() << std::endl;
+    churn_benchmark();
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::allocator_test
+
+} // namespace zephyr
@@ -0,0 +1,104 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <cstring>
+
+#include "../src/include/memory/arena.h"
+
+namespace zephyr
+{
+
+namespace arena_test
+{
+
+// 检查点、初始缓冲区、对齐与超过一个 span 的大块
+void checkpoint_test() {
+    size_t errors = 0;
+    alignas(16) char buffer[1024];
+    zephyr::arena a(buffer, sizeof(buffer));
+
+    char* p = static_cast<char*>(a.allocate(100));
+    errors += (p < buffer || p >= buffer + sizeof(buffer));
+    arena::checkpoint cp = a.mark();
+    {
+        arena_scope scope(a);
+        for (int i = 0; i < 10000; i++) {
+            char* q = static_cast<char*>(a.allocate(48));
+            memset(q, i & 0xff, 48);
+        }
+        void* aligned = a.allocate(10, 64);
+        errors += (reinterpret_cast<uintptr_t>(aligned) & 63) != 0;
+        char* big = static_cast<char*>(a.allocate(1 << 20));
+        memset(big, 1, 1 << 20);
+    }
+    // 作用域结束后回到 cp，下一个块紧接着 p 之后
+    errors += (a.mark().cursor != cp.cursor);
+    errors += (a.allocate(4, 4) != cp.cursor);
+
+    std::vector<int, arena_alloc<int>> v{arena_alloc<int>(a)};
+    for (int i = 0; i < 100000; i++)
+        v.push_back(i);
+    for (int i = 0; i < 100000; i++)
+        errors += (v[i] != i);
+
+    a.reset();
+    errors += (a.allocate(1) != buffer);
+    std::cout << "arena checkpoint / stack buffer / adapter: errors = " << errors << std::endl;
+}
+
+struct request_node {
+    request_node* next;
+    long key;
+    char payload[40];
+};
+
+enum { REQUESTS = 20000 };
+enum { NODES_PER_REQUEST = 300 };
+
+// 每个“请求”分配几百个小对象后一起丢弃：逐个还给 pool_allocator 与整体 reset arena 的对比
+void request_benchmark() {
+    std::vector<request_node*> nodes(NODES_PER_REQUEST);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < REQUESTS; r++) {
+        for (int i = 0; i < NODES_PER_REQUEST; i++) {
+            nodes[i] = static_cast<request_node*>(pool_allocator::allocate<sizeof(request_node)>());
+            nodes[i]->key = i;
+        }
+        for (int i = 0; i < NODES_PER_REQUEST; i++)
+            pool_allocator::deallocate<sizeof(request_node)>(nodes[i]);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    zephyr::arena a;
+    for (int r = 0; r < REQUESTS; r++) {
+        for (int i = 0; i < NODES_PER_REQUEST; i++) {
+            nodes[i] = static_cast<request_node*>(a.allocate(sizeof(request_node), alignof(request_node)));
+            nodes[i]->key = i;
+        }
+        a.reset();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double total = static_cast<double>(REQUESTS) * NODES_PER_REQUEST;
+    std::cout << "per request lifetime, ns/object: pool_allocator "
+              << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::nano>(t1 - t0).count() / total
+              << ", arena " << std::chrono::duration<double, std::nano>(t2 - t1).count() / total
+              << std::endl;
+}
+
+void arena_test() {
+    checkpoint_test();
+    request_benchmark();
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::arena_test
+
+} // namespace zephyr
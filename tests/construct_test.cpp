@@ -0,0 +1,200 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <list>
+
+#include "../src/include/memory/construct.h"
+
+namespace zephyr
+{
+
+namespace construct_test
+{
+
+// 统计存活的对象，第 limit 次构造时抛出异常
+struct counted {
+    static int live;
+    static int limit;
+
+    int value;
+
+    counted() : value(0) { enter(); }
+    counted(int v) : value(v) { enter(); }
+    counted(const counted& rhs) : value(rhs.value) { enter(); }
+    counted(counted&& rhs) : value(rhs.value) { enter(); rhs.value = -1; }
+    ~counted() { --live; }
+
+    static void enter() {
+        if (limit == 0)
+            throw std::runtime_error("counted");
+        if (limit > 0)
+            --limit;
+        ++live;
+    }
+};
+
+int counted::live = 0;
+int counted::limit = -1;
+
+// 持有堆上的指针，没有指向自身的指针，可以按字节搬移
+struct handle {
+    std::unique_ptr<int> p;
+    explicit handle(int v) : p(new int(v)) {}
+};
+
+} // namespace zephyr::construct_test
+
+template <>
+struct is_trivially_relocatable<construct_test::handle> : std::true_type {};
+
+namespace construct_test
+{
+
+template <typename T>
+T* raw(size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+}
+
+size_t copy_move_test() {
+    size_t errors = 0;
+    const int src[] = {1, 2, 3, 4, 5};
+    int* dst = raw<int>(5);
+    errors += (zephyr::uninitialized_copy(src, src + 5, dst) != dst + 5);
+    for (int i = 0; i < 5; i++)
+        errors += (dst[i] != i + 1);
+    errors += (zephyr::uninitialized_copy(src, src, dst) != dst);
+    ::operator delete(dst);
+
+    // 非指针迭代器走逐个构造
+    std::list<std::string> words = {"alpha", "beta", "gamma"};
+    std::string* s = raw<std::string>(3);
+    std::string* end = zephyr::uninitialized_copy(words.begin(), words.end(), s);
+    errors += (end != s + 3 || s[0] != "alpha" || s[2] != "gamma");
+    std::string* m = raw<std::string>(3);
+    zephyr::uninitialized_move(s, end, m);
+    errors += (m[1] != "beta");
+    zephyr::destroy(s, end);
+    zephyr::destroy(m, m + 3);
+    ::operator delete(s);
+    ::operator delete(m);
+    return errors;
+}
+
+size_t fill_test() {
+    size_t errors = 0;
+    int* a = raw<int>(64);
+    zephyr::uninitialized_fill(a, a + 64, -1);          // 每个字节相同，memset
+    for (int i = 0; i < 64; i++)
+        errors += (a[i] != -1);
+    zephyr::uninitialized_fill_n(a, 64, 0x01020304);    // 字节不同，逐个赋值
+    for (int i = 0; i < 64; i++)
+        errors += (a[i] != 0x01020304);
+    ::operator delete(a);
+
+    double* d = raw<double>(16);
+    zephyr::uninitialized_value_construct(d, d + 16);
+    for (int i = 0; i < 16; i++)
+        errors += (d[i] != 0.0);
+    ::operator delete(d);
+
+    std::string* s = raw<std::string>(4);
+    zephyr::uninitialized_fill(s, s + 4, std::string(40, 'x'));
+    errors += (s[3] != std::string(40, 'x'));
+    zephyr::destroy(s, s + 4);
+    zephyr::uninitialized_value_construct_n(s, 4);
+    errors += !s[0].empty();
+    zephyr::destroy(s, s + 4);
+    ::operator delete(s);
+    return errors;
+}
+
+// 构造中途抛出时已经构造的对象全部析构，异常继续向外传
+size_t rollback_test() {
+    size_t errors = 0;
+    std::vector<counted> src(8);
+    counted* dst = raw<counted>(8);
+    int before = counted::live;
+
+    for (int which = 0; which < 4; which++) {
+        counted::limit = 5;
+        bool thrown = false;
+        try {
+            switch (which) {
+                case 0: zephyr::uninitialized_copy(src.begin(), src.end(), dst); break;
+                case 1: zephyr::uninitialized_move(src.begin(), src.end(), dst); break;
+                case 2: zephyr::uninitialized_fill_n(dst, 8, src[0]); break;
+                default: zephyr::uninitialized_value_construct(dst, dst + 8); break;
+            }
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        counted::limit = -1;
+        errors += !thrown;
+        errors += (counted::live != before);
+    }
+    ::operator delete(dst);
+    return errors;
+}
+
+size_t relocate_test() {
+    size_t errors = 0;
+
+    // 特化为可平凡重定位：整段 memmove，允许区间重叠
+    handle* h = raw<handle>(6);
+    for (int i = 0; i < 4; i++)
+        ::new (h + i) handle(i);
+    handle* end = zephyr::relocate(h, h + 4, h + 2);
+    errors += (end != h + 6);
+    for (int i = 0; i < 4; i++)
+        errors += (*h[i + 2].p != i);
+    zephyr::destroy(h + 2, h + 6);
+    ::operator delete(h);
+
+    std::string* s = raw<std::string>(3);
+    std::string* t = raw<std::string>(3);
+    for (int i = 0; i < 3; i++)
+        ::new (s + i) std::string(30, char('a' + i));
+    zephyr::relocate(s, s + 3, t);
+    errors += (t[2] != std::string(30, 'c'));
+    zephyr::destroy(t, t + 3);
+
+    // 移动可能抛出：走复制，失败时源区间原样保留
+    std::vector<counted> init = {1, 2, 3, 4};
+    counted* c = raw<counted>(4);
+    counted* d = raw<counted>(4);
+    zephyr::uninitialized_copy(init.begin(), init.end(), c);
+    int before = counted::live;
+    counted::limit = 2;
+    try {
+        zephyr::relocate(c, c + 4, d);
+        errors++;
+    }
+    catch (const std::runtime_error&) {}
+    counted::limit = -1;
+    errors += (counted::live != before || c[3].value != 4);
+    zephyr::relocate(c, c + 4, d);
+    errors += (counted::live != before || d[0].value != 1 || d[3].value != 4);
+    zephyr::destroy(d, d + 4);
+    ::operator delete(s);
+    ::operator delete(t);
+    ::operator delete(c);
+    ::operator delete(d);
+    return errors;
+}
+
+void construct_test() {
+    size_t errors = copy_move_test() + fill_test() + rollback_test() + relocate_test();
+    std::cout << "uninitialized copy / move / fill / value_construct / relocate: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::construct_test
+
+} // namespace zephyr
@@ -0,0 +1,163 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+#include "../src/include/memory/global_allocator.h"
+
+namespace zephyr
+{
+
+namespace global_allocator_test
+{
+
+typedef zephyr::global_allocator ga;
+
+size_t basic_test() {
+    size_t errors = 0;
+    const size_t sizes[] = { 0, 1, 8, 24, 100, 4000, 32768, 40000, 200000, 3000000 };
+    for (size_t n : sizes) {
+        char* p = static_cast<char*>(ga::allocate(n));
+        errors += (p == nullptr || !ga::owns(p) || ga::usable_size(p) < n);
+        errors += (n > 8 && reinterpret_cast<uintptr_t>(p) % ga::min_align != 0);
+        memset(p, 0x3c, n);
+        ga::deallocate(p);
+    }
+
+    char* z = static_cast<char*>(ga::allocate_zeroed(1000, 3));
+    for (size_t i = 0; i < 3000; i++)
+        errors += (z[i] != 0);
+    ga::deallocate(z);
+    errors += (ga::allocate_zeroed(SIZE_MAX / 2, 4) != nullptr);
+
+    const size_t aligns[] = { 32, 64, 4096, 1 << 20 };
+    for (size_t a : aligns) {
+        for (size_t n : { size_t(10), size_t(50000) }) {
+            void* p = ga::allocate_aligned(a, n);
+            errors += (reinterpret_cast<uintptr_t>(p) % a != 0 || ga::usable_size(p) < n);
+            memset(p, 1, n);
+            ga::deallocate(p);
+        }
+    }
+    return errors;
+}
+
+// 依次经过 pool、大块原地扩张、搬移，再缩回 pool，内容保持不变
+size_t realloc_test() {
+    size_t errors = 0;
+    const size_t sizes[] = { 10, 100, 30000, 100000, 5000000, 60000000, 200000, 64, 3 };
+    char* p = nullptr;
+    size_t old = 0;
+    for (size_t n : sizes) {
+        p = static_cast<char*>(ga::reallocate(p, n));
+        size_t keep = old < n ? old : n;
+        for (size_t i = 0; i < keep; i += 97)
+            errors += (p[i] != static_cast<char>(i));
+        for (size_t i = (keep + 96) / 97 * 97; i < n; i += 97)
+            p[i] = static_cast<char>(i);
+        old = n;
+    }
+    errors += (ga::reallocate(p, 0) != nullptr);
+    return errors;
+}
+
+// 不是 global_allocator 分配的指针交还 libc；与大块落在同一个单元的外来指针也不会被误认
+size_t foreign_test() {
+    size_t errors = 0;
+#if defined(__GLIBC__)
+    void* small = __libc_realloc(nullptr, 100);
+    errors += ga::owns(small);
+    small = ga::reallocate(small, 200);
+    errors += ga::owns(small);
+    ga::deallocate(small);
+#endif
+    int on_stack = 0;
+    errors += ga::owns(&on_stack);
+
+    char* large = static_cast<char*>(ga::allocate(40000));
+    errors += !ga::owns(large) || ga::owns(large + 64 * 1024);
+    ga::deallocate(large);
+    return errors;
+}
+
+// 释放的大块留在缓存中，同一分级的下一次请求复用同一段映射；calloc 取到复用的大块时仍然清零
+size_t large_cache_test() {
+    size_t errors = 0;
+    ga::trim();
+    char* p = static_cast<char*>(ga::allocate(40000));
+    errors += (ga::usable_size(p) < 40000 || (ga::usable_size(p) + 64) % 4096 != 0);
+    memset(p, 0x5a, ga::usable_size(p));
+    ga::deallocate(p);
+    errors += ga::owns(p);
+
+    // 40000 与 39000 落在同一个分级
+    char* q = static_cast<char*>(ga::allocate_zeroed(39000, 1));
+    errors += (q != p || !ga::owns(q));
+    for (size_t i = 0; i < 39000; i += 61)
+        errors += (q[i] != 0);
+
+    // 在缓存的分级之内 realloc 扩张，内容保持不变
+    q[38999] = 7;
+    q = static_cast<char*>(ga::reallocate(q, 900000));
+    errors += (q[38999] != 7 || ga::usable_size(q) < 900000);
+    q[899999] = 9;
+    ga::deallocate(q);
+
+    // 超过 large_cache_max 的大块不缓存
+    char* big = static_cast<char*>(ga::allocate(ga::large_cache_max + 1));
+    ga::deallocate(big);
+    errors += (ga::trim() == 0);
+    errors += (ga::trim() != 0);
+
+    // 缓存的总量不超过 large_cache_bytes
+    std::vector<void*> blocks;
+    for (size_t bytes = 0; bytes < 2 * static_cast<size_t>(ga::large_cache_bytes); bytes += 200000)
+        blocks.push_back(ga::allocate(200000));
+    for (void* b : blocks)
+        ga::deallocate(b);
+    size_t released = ga::trim();
+    errors += (released == 0 || released > static_cast<size_t>(ga::large_cache_bytes));
+    return errors;
+}
+
+enum { THREADS = 4 };
+enum { OBJECTS = 20000 };
+
+// 一个线程分配，另一个线程释放
+size_t cross_thread_test() {
+    std::vector<void*> blocks(THREADS * OBJECTS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&blocks, t]() {
+            for (int i = 0; i < OBJECTS; i++)
+                blocks[t * OBJECTS + i] = ga::allocate(static_cast<size_t>(i % 300 + 1));
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    threads.clear();
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&blocks, t]() {
+            int from = (t + 1) % THREADS;
+            for (int i = 0; i < OBJECTS; i++)
+                ga::deallocate(blocks[from * OBJECTS + i]);
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    return 0;
+}
+
+void global_allocator_test() {
+    size_t errors = basic_test() + realloc_test() + foreign_test() + large_cache_test() + cross_thread_test();
+    std::cout << "global_allocator malloc / realloc / foreign free: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::global_allocator_test
+
+} // namespace zephyr
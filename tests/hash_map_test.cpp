@@ -0,0 +1,149 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#include <iostream>
+#include <string>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../src/include/container/hash_map.h"
+
+namespace zephyr
+{
+
+namespace hash_map_test
+{
+
+// 所有键落在同一个 h1、同一个 h2 上，每次查找都要越过整组候选
+struct bad_hash {
+    size_t operator()(uint64_t) const { return 0; }
+};
+
+// 随机插入、删除、查找，结果与 std::unordered_map 一致
+template <typename Map>
+size_t random_test(Map& m) {
+    size_t errors = 0;
+    std::unordered_map<uint64_t, uint64_t> expect;
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 200000; i++) {
+        uint64_t key = rng() % 5000;
+        switch (rng() % 4) {
+            case 0:
+            case 1: {
+                bool inserted = m.insert(std::make_pair(key, uint64_t(i))).second;
+                errors += (inserted != expect.insert(std::make_pair(key, uint64_t(i))).second);
+                break;
+            }
+            case 2:
+                errors += (m.erase(key) != expect.erase(key));
+                break;
+            default: {
+                auto it = m.find(key);
+                auto e = expect.find(key);
+                errors += ((it == m.end()) != (e == expect.end()));
+                if (it != m.end() && e != expect.end())
+                    errors += (it->second != e->second);
+            }
+        }
+    }
+    errors += (m.size() != expect.size());
+    size_t seen = 0;
+    for (const auto& kv : m) {
+        auto e = expect.find(kv.first);
+        errors += (e == expect.end() || e->second != kv.second);
+        seen++;
+    }
+    errors += (seen != expect.size());
+    errors += (m.load_factor() > m.max_load_factor());
+    return errors;
+}
+
+size_t flat_test() {
+    size_t errors = 0;
+    flat_hash_map<uint64_t, uint64_t> m;
+    errors += (m.find(1) != m.end() || m.erase(1) != 0 || m.capacity() != 0);
+    errors += random_test(m);
+
+    // 同一批键反复插入、删除：删除留下的槽位不会让表无限增长
+    flat_hash_map<uint64_t, uint64_t> churn;
+    for (uint64_t i = 0; i < 100000; i++) {
+        churn[i] = i;
+        churn.erase(i - 10);
+    }
+    errors += (churn.size() != 10 || churn.capacity() > 64);
+
+    flat_hash_map<uint64_t, uint64_t, bad_hash> collide;
+    for (uint64_t i = 0; i < 100; i++)
+        collide.emplace(i, i * 2);
+    for (uint64_t i = 0; i < 100; i += 2)
+        collide.erase(i);
+    for (uint64_t i = 0; i < 100; i++)
+        errors += (collide.contains(i) != (i % 2 == 1));
+    errors += (collide.at(51) != 102);
+
+    flat_hash_map<std::string, std::vector<int>> s = {{"alpha", {1}}, {"beta", {2, 2}}};
+    s["gamma"].push_back(3);
+    s.try_emplace("beta", 10, 0);
+    s.insert_or_assign("alpha", std::vector<int>(4, 4));
+    errors += (s.size() != 3 || s["beta"].size() != 2 || s.at("alpha").size() != 4 || s["gamma"][0] != 3);
+    bool thrown = false;
+    try {
+        s.at("delta");
+    }
+    catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    errors += !thrown;
+
+    flat_hash_map<std::string, std::vector<int>> copy(s);
+    flat_hash_map<std::string, std::vector<int>> moved(std::move(copy));
+    errors += (!copy.empty() || moved.size() != 3 || moved["gamma"][0] != 3);
+    copy = moved;
+    copy.erase(copy.find("alpha"));
+    copy.swap(moved);
+    errors += (copy.size() != 3 || moved.size() != 2 || moved.contains("alpha"));
+
+    // 遍历时删除
+    for (auto it = copy.begin(); it != copy.end(); )
+        it = it->first == "beta" ? copy.erase(it) : std::next(it);
+    errors += (copy.size() != 2 || copy.contains("beta"));
+    copy.clear();
+    errors += (!copy.empty() || copy.begin() != copy.end());
+
+    flat_hash_map<int, int> r;
+    r.reserve(1000);
+    size_t cap = r.capacity();
+    for (int i = 0; i < 1000; i++)
+        r[i] = i;
+    errors += (r.capacity() != cap);
+    return errors;
+}
+
+// node_hash_map 的元素地址在扩容前后不变
+size_t node_test() {
+    size_t errors = 0;
+    node_hash_map<uint64_t, uint64_t> m;
+    errors += random_test(m);
+
+    node_hash_map<int, std::string> n;
+    std::string* first = &n[0];
+    *first = "stable";
+    for (int i = 1; i < 10000; i++)
+        n[i] = std::to_string(i);
+    errors += (&n[0] != first || *first != "stable" || n.at(9999) != "9999");
+    n.erase(5000);
+    errors += (n.size() != 9999 || n.count(5000) != 0);
+    return errors;
+}
+
+void hash_map_test() {
+    size_t errors = flat_test() + node_test();
+    std::cout << "flat_hash_map / node_hash_map: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::hash_map_test
+
+} // namespace zephyr
@@ -0,0 +1,127 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../src/include/memory/heap_profiler.h"
+#include "../src/include/memory/pool_allocator.h"
+
+namespace zephyr
+{
+
+namespace heap_profile_test
+{
+
+// 间隔为 1 字节时每次分配都会被采样；释放后样本随之消失
+size_t sample_test() {
+    size_t errors = 0;
+    heap_profile_summary before = heap_profiler::summary();
+    errors += !heap_profiler::start(1);
+    static char blocks[64][32];
+    for (int i = 0; i < 64; i++)
+        heap_profiler::on_allocate(blocks[i], 32);
+    heap_profile_summary s = heap_profiler::summary();
+    errors += (s.live_samples != before.live_samples + 64 || s.live_bytes != before.live_bytes + 64 * 32);
+    errors += (s.estimated_bytes < s.live_bytes || s.stacks == 0);
+    for (int i = 0; i < 32; i++)
+        heap_profiler::on_deallocate(blocks[i]);
+    s = heap_profiler::summary();
+    errors += (s.live_samples != before.live_samples + 32);
+
+    // stop 之后不再采样，但释放仍然更新
+    heap_profiler::stop();
+    static char late[32];
+    heap_profiler::on_allocate(late, 1 << 20);
+    for (int i = 32; i < 64; i++)
+        heap_profiler::on_deallocate(blocks[i]);
+    s = heap_profiler::summary();
+    errors += (s.live_samples != before.live_samples);
+    return errors;
+}
+
+size_t dump_test() {
+    size_t errors = 0;
+    errors += !heap_profiler::start(4096);
+    std::vector<char*> blocks;
+    for (int i = 0; i < 1000; i++) {
+        char* p = new char[1000];
+        heap_profiler::on_allocate(p, 1000);
+        blocks.push_back(p);
+    }
+
+    char path[] = "/tmp/zephyr_heap_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0)
+        close(fd);
+    std::string text;
+    char line[4096];
+
+    errors += !heap_profiler::dump_pprof(path);
+    FILE* f = fopen(path, "r");
+    errors += (f == nullptr || fgets(line, sizeof(line), f) == nullptr);
+    if (f != nullptr) {
+        text = line;
+        errors += (text.compare(0, 13, "heap profile:") != 0 || text.find("heap_v2/4096") == std::string::npos);
+        bool maps = false;
+        while (fgets(line, sizeof(line), f) != nullptr)
+            maps = maps || std::string(line) == "MAPPED_LIBRARIES:\n";
+        errors += !maps;
+        fclose(f);
+    }
+
+    // 折叠栈：每行以空格加估计字节数结尾，总和与 summary 的估计值一致
+    errors += !heap_profiler::dump_folded(path);
+    f = fopen(path, "r");
+    unsigned long long total = 0;
+    while (f != nullptr && fgets(line, sizeof(line), f) != nullptr) {
+        text = line;
+        size_t space = text.rfind(' ');
+        errors += (space == std::string::npos);
+        if (space != std::string::npos)
+            total += strtoull(text.c_str() + space + 1, nullptr, 10);
+    }
+    if (f != nullptr)
+        fclose(f);
+    heap_profile_summary s = heap_profiler::summary();
+    errors += (total != s.estimated_bytes);
+    // 约 100 万字节，按 4 KiB 采样大约 240 个样本，估计值应当在真实值附近
+    errors += (s.estimated_bytes < 500000 || s.estimated_bytes > 2000000);
+    unlink(path);
+
+    heap_profiler::stop();
+    for (char* p : blocks) {
+        heap_profiler::on_deallocate(p);
+        delete[] p;
+    }
+    errors += (heap_profiler::summary().live_samples != 0);
+    return errors;
+}
+
+// 记录点编译进来时，pool_allocator 的分配进入分析器
+size_t hook_test() {
+    size_t errors = 0;
+#ifdef ZEPHYR_HEAP_PROFILE
+    errors += !heap_profiler::start(1);
+    void* p = pool_allocator::allocate(100);
+    errors += (heap_profiler::summary().live_samples != 1);
+    pool_allocator::deallocate(p, 100);
+    errors += (heap_profiler::summary().live_samples != 0);
+    heap_profiler::stop();
+#endif
+    return errors;
+}
+
+void heap_profile_test() {
+    size_t errors = sample_test() + dump_test() + hook_test();
+    std::cout << "heap_profiler sampling / pprof / folded dump: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::heap_profile_test
+
+} // namespace zephyr
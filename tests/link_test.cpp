@@ -0,0 +1,51 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+// 单独编译的第二个翻译单元，与 test.cpp 一起链接：头文件中的非模板函数、静态成员如果没有标成 inline
+// 或放进类模板，链接时会报 multiple definition
+
+#include <iostream>
+#include <string>
+
+#include "../src/include/math/math.h"
+#include "../src/include/memory/pool_allocator.h"
+#include "../src/include/memory/loki_allocator.h"
+#include "../src/include/memory/allocator.h"
+#include "../src/include/memory/arena.h"
+#include "../src/include/memory/object_pool.h"
+#include "../src/include/memory/global_allocator.h"
+#include "../src/include/memory/alloc_trace.h"
+#include "../src/include/memory/heap_profiler.h"
+#include "../src/include/container/vector.h"
+#include "../src/include/container/hash_map.h"
+#include "../src/include/container/lru_cache.h"
+
+namespace zephyr
+{
+
+namespace link_test
+{
+
+// page_source_test 用它比较两个翻译单元中 page_sources::heap 的地址
+const page_source* heap_source() {
+    return &page_sources::heap;
+}
+
+void link_test() {
+    size_t errors = 0;
+    errors += (ceil_pow2(5) != 3 || bsf(8) != 3 || lowbit(12) != 4 || !is_power_of2(64));
+
+    vector<std::string> v(3, "x");
+    flat_hash_map<int, int> flat = {{1, 2}};
+    lru_cache<int, int> lru(2);
+    lru.put(1, 1);
+    errors += (v.size() != 3 || flat.at(1) != 2 || lru.get(1) == nullptr);
+
+    std::cout << "link (second translation unit): errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::link_test
+
+} // namespace zephyr
@@ -0,0 +1,349 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <cstdio>
+#include <type_traits>
+
+#include "../src/include/memory/loki_allocator.h"
+
+namespace zephyr
+{
+
+namespace loki_test
+{
+
+struct loki_node {
+    loki_node* next;
+    long value;
+    double weight;
+};
+
+enum { NODES = 100000 };
+enum { ROUNDS = 10 };
+
+// 生产者线程分配，消费者线程释放；下一轮生产者应当重新用上这些块
+void producer_consumer_test() {
+    std::vector<loki_node*> nodes(NODES);
+    std::vector<loki_node*> first_round;
+    size_t reused = 0;
+
+    std::thread producer([&]() {
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < NODES; i++) {
+                nodes[i] = zephyr::loki_alloc<loki_node>::allocate();
+                nodes[i]->value = i;
+            }
+            if (r == 0) {
+                first_round = nodes;
+                std::sort(first_round.begin(), first_round.end());
+            }
+            else if (r == 1) {
+                for (int i = 0; i < NODES; i++)
+                    reused += std::binary_search(first_round.begin(), first_round.end(), nodes[i]);
+            }
+
+            std::thread consumer([&]() {
+                for (int i = 0; i < NODES; i++)
+                    zephyr::loki_alloc<loki_node>::deallocate(nodes[i]);
+            });
+            consumer.join();
+        }
+    });
+    producer.join();
+
+    std::cout << "loki_alloc producer/consumer: " << ROUNDS << " rounds of " << NODES
+              << " remote frees, reused in round 2 = " << reused << std::endl;
+}
+
+// 析构时才分配、释放 loki 块的 thread_local 对象；它在 loki 的 heap 之前构造，所以在 heap 交出之后析构
+struct exit_probe {
+    std::vector<loki_node*> held;
+    std::atomic<size_t>* errors;
+
+    ~exit_probe() {
+        std::vector<loki_node*> late(1000);
+        for (size_t i = 0; i < late.size(); i++) {
+            late[i] = zephyr::loki_alloc<loki_node>::allocate();
+            late[i]->value = static_cast<long>(i);
+        }
+        for (size_t i = 0; i < late.size(); i++) {
+            *errors += (late[i]->value != static_cast<long>(i));
+            zephyr::loki_alloc<loki_node>::deallocate(late[i]);
+        }
+        for (loki_node* n : held)
+            zephyr::loki_alloc<loki_node>::deallocate(n);
+    }
+};
+
+// 线程退出后 heap 可能已被其他线程接管，此后的分配、释放不能再走拥有者路径
+size_t thread_exit_test() {
+    std::atomic<size_t> errors(0);
+#ifdef ZEPHYR_LOKI_SINGLE_THREAD
+    const int nthreads = 1;
+#else
+    const int nthreads = 4;
+#endif
+    for (int r = 0; r < 4; r++) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nthreads; t++) {
+            threads.emplace_back([&errors]() {
+                static thread_local exit_probe probe;
+                probe.errors = &errors;
+                for (int i = 0; i < 1000; i++)
+                    probe.held.push_back(zephyr::loki_alloc<loki_node>::allocate());
+                for (int i = 0; i < 20000; i++)
+                    zephyr::loki_alloc<loki_node>::deallocate(zephyr::loki_alloc<loki_node>::allocate());
+            });
+        }
+        for (auto& th : threads)
+            th.join();
+    }
+    std::cout << "loki_alloc from thread_local destructors: errors = " << errors.load() << std::endl;
+    return errors.load();
+}
+
+enum { BATCH = 256 };
+enum { ITERATIONS = 4000 };
+
+double run(int nthreads) {
+    std::vector<loki_node*> slots(static_cast<size_t>(nthreads) * BATCH);
+    std::vector<std::thread> threads;
+    threads.reserve(nthreads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < nthreads; t++) {
+        threads.emplace_back([&slots, t]() {
+            loki_node** mine = &slots[t * BATCH];
+            for (int r = 0; r < ITERATIONS; r++) {
+                for (int i = 0; i < BATCH; i++)
+                    mine[i] = zephyr::loki_alloc<loki_node>::allocate();
+                for (int i = 0; i < BATCH; i++)
+                    zephyr::loki_alloc<loki_node>::deallocate(mine[i]);
+            }
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return 2.0 * nthreads * ITERATIONS * BATCH / seconds / 1e6;
+}
+
+// 活跃对象越来越多时，乱序释放的单次开销应保持平稳
+void random_free_test() {
+    std::cout << "live nodes   chunks   ns/free (random order)" << std::endl;
+    std::mt19937 rng(42);
+    for (size_t live = 1000; live <= 1000000; live *= 10) {
+        zephyr::fixed_allocator<sizeof(loki_node)> allocator;
+        std::vector<void*> nodes(live);
+        for (size_t i = 0; i < live; i++)
+            nodes[i] = allocator.allocate();
+        std::shuffle(nodes.begin(), nodes.end(), rng);
+        size_t chunks = allocator.chunk_count();
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < live; i++)
+            allocator.deallocate(nodes[i]);
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / live;
+        std::cout << std::setw(10) << live << std::setw(9) << chunks
+                  << std::setw(14) << std::fixed << std::setprecision(2) << ns << std::endl;
+    }
+}
+
+// 运行期大小的分配；大小相近的多种类型共用 chunk，比每种大小一个 fixed_allocator 用到的 chunk 更少
+void small_object_test() {
+    zephyr::small_object_allocator allocator(128);
+    std::vector<std::pair<unsigned char*, size_t>> blocks;
+    for (int r = 0; r < 100; r++) {
+        for (size_t n = 1; n <= 160; n++) {
+            unsigned char* q = static_cast<unsigned char*>(allocator.allocate(n));
+            for (size_t i = 0; i < n; i++)
+                q[i] = static_cast<unsigned char>(n);
+            blocks.emplace_back(q, n);
+        }
+    }
+    size_t broken = 0;
+    for (auto& b : blocks) {
+        for (size_t i = 0; i < b.second; i++)
+            broken += (b.first[i] != static_cast<unsigned char>(b.second));
+    }
+
+    std::vector<zephyr::fixed_allocator<sizeof(uint16_t)>> per_size;
+    per_size.reserve(128);
+    for (size_t n = 1; n <= 128; n++)
+        per_size.emplace_back(n);
+    std::vector<void*> per_size_blocks;
+    for (int r = 0; r < 100; r++)
+        for (size_t n = 1; n <= 128; n++)
+            per_size_blocks.push_back(per_size[n - 1].allocate());
+    size_t per_size_chunks = 0;
+    for (auto& a : per_size)
+        per_size_chunks += a.chunk_count();
+
+    std::cout << "small_object_allocator: corrupted bytes = " << broken
+              << ", chunks = " << allocator.chunk_count()
+              << " (one fixed_allocator per size: " << per_size_chunks << ")" << std::endl;
+
+    for (auto& b : blocks)
+        allocator.deallocate(b.first, b.second);
+    for (size_t i = 0; i < per_size_blocks.size(); i++)
+        per_size[i % 128].deallocate(per_size_blocks[i]);
+}
+
+static_assert(std::is_same<zephyr::chunk_traits<1>::index_type, uint8_t>::value,
+              "1-byte blocks can only hold an 8-bit index");
+static_assert(std::is_same<zephyr::chunk_traits<24>::index_type, uint16_t>::value,
+              "24-byte blocks in a 64 KiB chunk need a 16-bit index");
+static_assert(std::is_same<zephyr::chunk_traits<8, 1 << 20>::index_type, uint32_t>::value,
+              "8-byte blocks in a 1 MiB chunk need a 32-bit index");
+
+// 每种下标位宽都要能把整个 chunk 分配完、全部释放后再完整地分配一遍
+template <size_t Block_size, size_t Chunk_bytes>
+size_t index_width_round_trip() {
+    zephyr::fixed_allocator<Block_size, Chunk_bytes> allocator;
+    size_t n = allocator.num_blocks();
+    std::vector<unsigned char*> blocks(n);
+    size_t broken = 0;
+    for (int r = 0; r < 2; r++) {
+        for (size_t i = 0; i < n; i++) {
+            blocks[i] = static_cast<unsigned char*>(allocator.allocate());
+            memset(blocks[i], static_cast<int>(i & 0xff), Block_size);
+        }
+        for (size_t i = 0; i < n; i++)
+            broken += (blocks[i][Block_size - 1] != static_cast<unsigned char>(i & 0xff));
+        broken += (allocator.chunk_count() != 1);
+        for (size_t i = n; i > 0; i--)
+            allocator.deallocate(blocks[(i * 7919) % n]);
+    }
+    return broken;
+}
+
+void index_width_test() {
+    size_t broken = index_width_round_trip<1, 65536>()
+                  + index_width_round_trip<3, 65536>()
+                  + index_width_round_trip<24, 65536>()
+                  + index_width_round_trip<8, 1 << 20>();
+    std::cout << "chunk index widths 8/16/32 bit: blocks per chunk "
+              << zephyr::fixed_allocator<1>().num_blocks() << " / "
+              << zephyr::fixed_allocator<24>().num_blocks() << " / "
+              << zephyr::fixed_allocator<8, 1 << 20>().num_blocks()
+              << ", errors = " << broken << std::endl;
+}
+
+// nullptr 与另一个同样大小的 fixed_allocator 分配的块都被忽略，不改变计数
+size_t foreign_block_test() {
+    size_t errors = 0;
+    zephyr::fixed_allocator<32> a, b;
+    void* mine = a.allocate();
+    void* other = b.allocate();
+    a.deallocate(nullptr);
+    a.deallocate(other);
+    errors += (a.stats().live != 1 || b.stats().live != 1);
+    a.deallocate(mine);
+    b.deallocate(other);
+    errors += (a.stats().live != 0 || b.stats().live != 0);
+    std::cout << "fixed_allocator nullptr / other allocator's block: errors = " << errors << std::endl;
+    return errors;
+}
+
+// 批量释放：按 chunk 分段串回空闲链表；顺序释放时一段就是一整个 chunk，交错释放时每段只有一个块
+size_t bulk_free_test() {
+    size_t errors = 0;
+    const size_t n = 200000;
+    std::vector<loki_node*> nodes(n);
+    double ns[2];
+    for (int order = 0; order < 2; order++) {
+        zephyr::fixed_allocator<sizeof(loki_node)> allocator;
+        allocator.allocate_bulk(nodes.data(), n);
+        for (size_t i = 0; i < n; i++)
+            nodes[i]->value = static_cast<long>(i);
+        if (order == 1) {
+            // 相邻两个元素来自不同的 chunk
+            size_t per_chunk = allocator.num_blocks();
+            std::vector<loki_node*> mixed;
+            for (size_t k = 0; k < per_chunk; k++)
+                for (size_t i = k; i < n; i += per_chunk)
+                    mixed.push_back(nodes[i]);
+            nodes.swap(mixed);
+        }
+        auto start = std::chrono::steady_clock::now();
+        allocator.deallocate_bulk(nodes.data(), n);
+        auto end = std::chrono::steady_clock::now();
+        ns[order] = std::chrono::duration<double, std::nano>(end - start).count() / n;
+        errors += (allocator.stats().live != 0);
+
+        // 释放的块全部可以重新分配，且互不相同
+        allocator.allocate_bulk(nodes.data(), n);
+        std::vector<loki_node*> sorted(nodes);
+        std::sort(sorted.begin(), sorted.end());
+        errors += (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end());
+        allocator.deallocate_bulk(nodes.data(), n);
+        errors += (allocator.stats().live != 0);
+    }
+    std::cout << "fixed_allocator deallocate_bulk: " << std::fixed << std::setprecision(2) << ns[0]
+              << " ns/block in chunk order, " << ns[1] << " ns/block interleaved, errors = " << errors << std::endl;
+    return errors;
+}
+
+// 当前进程常驻内存的字节数，读取失败时返回 0
+size_t resident_bytes() {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f == nullptr) return 0;
+    unsigned long size = 0, resident = 0;
+    if (fscanf(f, "%lu %lu", &size, &resident) != 2) resident = 0;
+    fclose(f);
+    return resident * 4096;
+}
+
+// 新 chunk 惰性切分：分配少量块时，常驻内存只随用到的块增长，而不是随 chunk 大小增长
+void first_touch_test() {
+    zephyr::fixed_allocator<64, 1 << 22> allocator;
+    size_t before = resident_bytes();
+    auto start = std::chrono::steady_clock::now();
+    void* q = allocator.allocate();
+    auto end = std::chrono::steady_clock::now();
+    size_t after = resident_bytes();
+    std::cout << "first allocate from a 4 MiB chunk: "
+              << std::chrono::duration<double, std::micro>(end - start).count() << " us, RSS +"
+              << (after - before) / 1024 << " KiB" << std::endl;
+    allocator.deallocate(q);
+}
+
+void loki_test() {
+    producer_consumer_test();
+    thread_exit_test();
+    first_touch_test();
+    index_width_test();
+    foreign_block_test();
+    bulk_free_test();
+    small_object_test();
+    random_free_test();
+
+    int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (max_threads < 2) max_threads = 2;
+#ifdef ZEPHYR_LOKI_SINGLE_THREAD
+    max_threads = 1;
+#endif
+    std::cout << "threads   loki_alloc Mops/s" << std::endl;
+    for (int t = 1; t <= max_threads; t *= 2)
+        std::cout << std::setw(7) << t << std::setw(20) << std::fixed << std::setprecision(2)
+                  << run(t) << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::loki_test
+
+} // namespace zephyr
@@ -0,0 +1,200 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <algorithm>
+
+#include "../src/include/container/lru_cache.h"
+
+namespace zephyr
+{
+
+namespace lru_cache_test
+{
+
+// 从最近使用到最久未使用的键
+template <typename Cache>
+std::vector<int> order(const Cache& c) {
+    std::vector<int> keys;
+    c.for_each([&keys](int k, const std::string&) { keys.push_back(k); });
+    return keys;
+}
+
+size_t count_test() {
+    size_t errors = 0;
+    lru_cache<int, std::string> c(3);
+    errors += (c.get(1) != nullptr || !c.empty());
+    c.put(1, "one");
+    c.put(2, "two");
+    c.put(3, "three");
+    errors += (order(c) != std::vector<int>({3, 2, 1}));
+
+    // get 把 1 移到最前，再插入时淘汰最久未使用的 2
+    errors += (c.get(1) == nullptr || *c.get(1) != "one");
+    c.put(4, "four");
+    errors += (order(c) != std::vector<int>({4, 1, 3}) || c.contains(2) || c.size() != 3);
+
+    // peek 不改变顺序
+    errors += (c.peek(3) == nullptr || *c.peek(3) != "three" || order(c) != std::vector<int>({4, 1, 3}));
+
+    // 覆盖已有的键：值更新、移到最前、不淘汰
+    c.put(3, std::string("THREE"));
+    errors += (order(c) != std::vector<int>({3, 4, 1}) || *c.peek(3) != "THREE" || c.usage() != 3);
+
+    errors += (!c.erase(4) || c.erase(4) || order(c) != std::vector<int>({3, 1}));
+    c.put(5, "five");
+    c.put(6, "six");
+    errors += (order(c) != std::vector<int>({6, 5, 3}));
+
+    c.set_capacity(1);
+    errors += (order(c) != std::vector<int>({6}) || c.usage() != 1);
+    c.set_capacity(2);
+    c.put(7, "seven");
+    errors += (order(c) != std::vector<int>({7, 6}));
+
+    lru_stats s = c.stats();
+    errors += (s.hits != 2 || s.misses != 1 || s.evictions != 4);
+
+    c.clear();
+    errors += (!c.empty() || c.usage() != 0 || !order(c).empty());
+    c.put(8, "eight");
+    errors += (order(c) != std::vector<int>({8}));
+
+    // 容量为 0 时什么都不保留
+    lru_cache<int, std::string> none(0);
+    errors += (none.put(1, "x") || !none.empty() || none.usage() != 0);
+    return errors;
+}
+
+size_t charge_test() {
+    size_t errors = 0;
+    // 显式给出费用：按字符串长度计
+    lru_cache<int, std::string> c(10);
+    errors += !c.put(1, std::string(4, 'a'), 4);
+    errors += !c.put(2, std::string(4, 'b'), 4);
+    errors += (c.usage() != 8 || c.size() != 2);
+    errors += !c.put(3, std::string(3, 'c'), 3);
+    errors += (c.usage() != 7 || order(c) != std::vector<int>({3, 2}));
+
+    // 覆盖时按新的费用重新计算
+    errors += !c.put(2, std::string(1, 'b'), 1);
+    errors += (c.usage() != 4 || order(c) != std::vector<int>({2, 3}));
+
+    // 超过整个容量的条目不保留，也不影响其他条目；已有的键被覆盖成过大的值时删除
+    errors += c.put(4, std::string(11, 'd'), 11);
+    errors += (c.contains(4) || c.usage() != 4 || c.size() != 2);
+    errors += c.put(3, std::string(11, 'c'), 11);
+    errors += (c.contains(3) || c.usage() != 1 || order(c) != std::vector<int>({2}));
+
+    // lru_bytes：容量按节点字节数计
+    typedef lru_cache<int, std::string, std::hash<int>, std::equal_to<int>, lru_bytes> byte_cache;
+    size_t node_bytes = lru_bytes()(0, std::string());
+    byte_cache b(node_bytes * 5);
+    for (int i = 0; i < 100; i++)
+        b.put(i, std::to_string(i));
+    errors += (b.size() != 5 || b.usage() != node_bytes * 5 || !b.contains(99) || b.contains(94));
+    return errors;
+}
+
+// 条目在表扩容前后地址不变，与 std 的 list + unordered_map 实现做随机对比
+size_t stable_test() {
+    size_t errors = 0;
+    lru_cache<int, int> c(5000);
+    c.put(-1, 42);
+    int* first = c.get(-1);
+    for (int i = 0; i < 4000; i++)
+        c.put(i, i);
+    errors += (c.get(-1) != first || *first != 42);
+
+    lru_cache<int, int> r(100);
+    std::vector<int> expect;     // 最近使用在前
+    std::mt19937 rng(11);
+    for (int i = 0; i < 50000; i++) {
+        int key = static_cast<int>(rng() % 300);
+        std::vector<int>::iterator it = std::find(expect.begin(), expect.end(), key);
+        if (rng() % 2) {
+            r.put(key, key);
+            if (it != expect.end())
+                expect.erase(it);
+            expect.insert(expect.begin(), key);
+            if (expect.size() > 100)
+                expect.pop_back();
+        }
+        else {
+            int* v = r.get(key);
+            errors += ((v != nullptr) != (it != expect.end()));
+            if (it != expect.end()) {
+                expect.erase(it);
+                expect.insert(expect.begin(), key);
+            }
+        }
+    }
+    std::vector<int> keys;
+    r.for_each([&keys](int k, int) { keys.push_back(k); });
+    errors += (keys != expect);
+    return errors;
+}
+
+size_t sharded_test() {
+    size_t errors = 0;
+    sharded_lru_cache<int, int> one(4, 1);
+    for (int i = 0; i < 10; i++)
+        one.put(i, i * 2);
+    int v = 0;
+    errors += (one.shard_count() != 1 || one.size() != 4 || !one.get(9, v) || v != 18 || one.get(0, v));
+
+    sharded_lru_cache<int, int> c(4096, 6);
+    errors += (c.shard_count() != 8 || c.capacity() != 4096);
+
+    // 每个线程写自己的一段键，再读回来；总容量足够，不会淘汰
+#ifdef ZEPHYR_LOKI_SINGLE_THREAD
+    const int threads = 1, per_thread = 2000;
+#else
+    const int threads = 4, per_thread = 500;
+#endif
+    std::vector<std::thread> workers;
+    std::vector<size_t> thread_errors(threads, 0);
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&c, &thread_errors, t]() {
+            for (int round = 0; round < 20; round++)
+                for (int i = 0; i < per_thread; i++) {
+                    int key = t * per_thread + i;
+                    int got = -1;
+                    if (c.get(key, got))
+                        thread_errors[t] += (got != key);
+                    else
+                        c.put(key, key);
+                }
+        });
+    for (std::thread& w : workers)
+        w.join();
+    for (size_t e : thread_errors)
+        errors += e;
+    lru_stats s = c.stats();
+    errors += (c.size() != threads * per_thread || s.misses != threads * per_thread || s.evictions != 0);
+    errors += (s.hits != size_t(threads * per_thread * 19));
+    errors += (!c.erase(0) || c.contains(0) || c.size() != threads * per_thread - 1);
+
+    // 键远多于容量：每个分片都不超过自己的容量
+    for (int i = 0; i < 100000; i++)
+        c.put(i, i);
+    errors += (c.size() > 4096 || c.usage() != c.size());
+    c.clear();
+    errors += (c.size() != 0);
+    return errors;
+}
+
+void lru_cache_test() {
+    size_t errors = count_test() + charge_test() + stable_test() + sharded_test();
+    std::cout << "lru_cache / sharded_lru_cache: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::lru_cache_test
+
+} // namespace zephyr
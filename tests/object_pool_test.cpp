@@ -0,0 +1,99 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "../src/include/memory/object_pool.h"
+
+namespace zephyr
+{
+
+namespace object_pool_test
+{
+
+// 构造代价高的对象：内部有预留好容量的缓冲区
+struct buffer {
+    std::vector<char> data;
+    std::string name;
+    static int constructed;
+
+    buffer() : data(), name("buffer") {
+        data.reserve(16384);
+        ++constructed;
+    }
+};
+
+int buffer::constructed = 0;
+
+void clear_buffer(buffer& b) {
+    b.data.clear();
+}
+
+size_t handle_test() {
+    size_t errors = 0;
+    zephyr::object_pool<buffer> pool(2, clear_buffer);
+    buffer::constructed = 0;
+    {
+        auto a = pool.acquire();
+        auto b = pool.acquire();
+        auto c = pool.acquire();
+        a->data.push_back('a');
+        errors += (pool.live() != 3);
+        auto moved = std::move(c);
+        errors += (c || !moved);
+    }
+    // 三个对象都已归还，最多保留两个
+    errors += (pool.live() != 0 || pool.retained() != 2);
+    {
+        auto a = pool.acquire();
+        errors += (!a->data.empty() || a->data.capacity() < 16384);
+    }
+    errors += (buffer::constructed != 3);
+
+    zephyr::object_pool<buffer> plain;
+    plain.acquire().reset();
+    errors += (plain.retained() != 0);
+    return errors;
+}
+
+enum { ROUNDS = 200000 };
+
+void reuse_benchmark() {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        buffer* b = zephyr::loki_alloc<buffer>::allocate();
+        zephyr::construct(b);
+        b->data.push_back(static_cast<char>(i));
+        zephyr::destroy(b);
+        zephyr::loki_alloc<buffer>::deallocate(b);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    zephyr::object_pool<buffer> pool(16, clear_buffer);
+    for (int i = 0; i < ROUNDS; i++) {
+        auto b = pool.acquire();
+        b->data.push_back(static_cast<char>(i));
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << "buffer reuse, ns/round: loki_alloc + construct/destroy "
+              << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::nano>(t1 - t0).count() / ROUNDS
+              << ", object_pool " << std::chrono::duration<double, std::nano>(t2 - t1).count() / ROUNDS
+              << std::endl;
+}
+
+void object_pool_test() {
+    std::cout << "object_pool handles / retention: errors = " << handle_test() << std::endl;
+    reuse_benchmark();
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::object_pool_test
+
+} // namespace zephyr
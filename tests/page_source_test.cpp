@@ -0,0 +1,145 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+
+#include "../src/include/memory/page_source.h"
+
+namespace zephyr
+{
+
+namespace page_source_test
+{
+
+// 数据 TLB 读缺失计数器；没有权限或硬件不支持时 fd < 0
+struct dtlb_counter {
+    int fd;
+
+    dtlb_counter() {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB
+                      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~dtlb_counter() { if (fd >= 0) close(fd); }
+
+    void start() {
+        if (fd < 0) return ;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    long long stop() {
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+        return count;
+    }
+};
+
+// 进程中由透明大页映射的匿名内存字节数，读取失败时返回 0
+size_t anon_huge_bytes() {
+    FILE* f = fopen("/proc/self/smaps_rollup", "r");
+    if (f == nullptr) return 0;
+    char line[256];
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1)
+            break;
+    }
+    fclose(f);
+    return kb * 1024;
+}
+
+enum { REGION_BYTES = 64 << 20 };
+enum { SLOT_BYTES = 64 };
+enum { HOPS = 1 << 22 };
+
+// 在一块区域里按随机顺序串起所有 64 字节的槽，再沿链表跳转：相当于大量小对象被随机访问
+void run(const page_source& source) {
+    size_t slots = REGION_BYTES / SLOT_BYTES;
+    size_t huge_before = anon_huge_bytes();
+
+    auto t0 = std::chrono::steady_clock::now();
+    char* base = static_cast<char*>(source.map(REGION_BYTES, 1 << 21));
+    std::vector<size_t> order(slots);
+    for (size_t i = 0; i < slots; i++)
+        order[i] = i;
+    std::shuffle(order.begin() + 1, order.end(), std::mt19937(7));
+    for (size_t i = 0; i < slots; i++)
+        *reinterpret_cast<char**>(base + order[i] * SLOT_BYTES) = base + order[(i + 1) % slots] * SLOT_BYTES;
+    auto t1 = std::chrono::steady_clock::now();
+    size_t huge = anon_huge_bytes() - huge_before;
+
+    dtlb_counter counter;
+    char* p = base;
+    counter.start();
+    auto t2 = std::chrono::steady_clock::now();
+    for (int i = 0; i < HOPS; i++)
+        p = *reinterpret_cast<char**>(p);
+    auto t3 = std::chrono::steady_clock::now();
+    long long misses = counter.stop();
+
+    std::cout << std::setw(6) << source.name
+              << std::setw(12) << std::fixed << std::setprecision(1)
+              << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << std::setw(12) << std::setprecision(2)
+              << std::chrono::duration<double, std::nano>(t3 - t2).count() / HOPS
+              << std::setw(14);
+    if (misses < 0)
+        std::cout << "n/a";
+    else
+        std::cout << std::setprecision(3) << static_cast<double>(misses) / HOPS;
+    std::cout << std::setw(12) << (huge >> 20) << (p == nullptr ? "!" : "") << std::endl;
+
+    source.unmap(base, REGION_BYTES);
+}
+
+} // namespace zephyr::page_source_test
+
+namespace link_test
+{
+
+const page_source* heap_source();
+
+} // namespace zephyr::link_test
+
+namespace page_source_test
+{
+
+void page_source_test() {
+    std::cout << "page source in use: " << current_page_source().name << std::endl;
+    // 另一个翻译单元看到的内置来源与本翻译单元是同一个对象
+    size_t errors = (link_test::heap_source() != &page_sources::heap || page_sources::from_name("heap") != &page_sources::heap);
+    std::cout << "builtin page sources shared across translation units: errors = " << errors << std::endl;
+    std::cout << "source   setup ms    ns/hop   dTLB miss/hop   THP MiB" << std::endl;
+    run(page_sources::heap);
+    run(page_sources::mmap);
+    run(page_sources::huge);
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::page_source_test
+
+} // namespace zephyr
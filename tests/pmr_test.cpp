@@ -0,0 +1,111 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include "../src/include/memory/memory_resource.h"
+
+#ifdef ZEPHYR_HAS_MEMORY_RESOURCE
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <memory_resource>
+#include <unordered_map>
+
+namespace zephyr
+{
+
+namespace pmr_test
+{
+
+// 各种对齐都应当满足，并且能原样释放
+size_t alignment_check(std::pmr::memory_resource* r) {
+    size_t errors = 0;
+    std::vector<std::pair<void*, std::pair<size_t, size_t>>> blocks;
+    for (size_t align = 1; align <= 128; align *= 2) {
+        for (size_t bytes = 1; bytes <= 40000; bytes = bytes * 3 + 1) {
+            void* p = r->allocate(bytes, align);
+            errors += (reinterpret_cast<uintptr_t>(p) % align) != 0;
+            memset(p, 0x5a, bytes);
+            blocks.push_back({p, {bytes, align}});
+        }
+    }
+    for (auto& b : blocks)
+        r->deallocate(b.first, b.second.first, b.second.second);
+    return errors;
+}
+
+enum { VECTOR_ROUNDS = 2000 };
+enum { VECTOR_SIZE = 1000 };
+enum { MAP_KEYS = 100000 };
+
+// 反复构造小 vector：模拟请求内的临时容器
+double vector_workload(std::pmr::memory_resource* r) {
+    auto start = std::chrono::steady_clock::now();
+    long sum = 0;
+    for (int round = 0; round < VECTOR_ROUNDS; round++) {
+        std::pmr::vector<std::pmr::vector<int>> outer(r);
+        for (int i = 0; i < 20; i++) {
+            outer.emplace_back();
+            for (int j = 0; j < VECTOR_SIZE / 20; j++)
+                outer.back().push_back(j);
+        }
+        sum += outer.back().back();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() + (sum < 0);
+}
+
+// 插入、查找、删除大量键：节点分配占主要开销
+double map_workload(std::pmr::memory_resource* r) {
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::pmr::unordered_map<int, long> map(r);
+        for (int i = 0; i < MAP_KEYS; i++)
+            map.emplace(i * 7, i);
+        long sum = 0;
+        for (int i = 0; i < MAP_KEYS; i++)
+            sum += map.count(i);
+        for (int i = 0; i < MAP_KEYS; i += 2)
+            map.erase(i * 7);
+        for (int i = 0; i < MAP_KEYS; i += 2)
+            map.emplace(i * 7 + 1, sum);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const char* name, std::pmr::memory_resource* r) {
+    std::cout << std::setw(22) << name
+              << std::setw(14) << std::fixed << std::setprecision(2) << vector_workload(r)
+              << std::setw(14) << map_workload(r) << std::endl;
+}
+
+void pmr_test() {
+    zephyr::small_object_resource small;
+    zephyr::arena_resource arena;
+    size_t errors = alignment_check(&pool_resource::instance())
+                  + alignment_check(&small)
+                  + alignment_check(&arena);
+    pool_resource other;
+    zephyr::small_object_resource small_other;
+    errors += !pool_resource::instance().is_equal(other);
+    errors += small.is_equal(small_other);
+    errors += !small.is_equal(small);
+    std::cout << "memory_resource alignment / is_equal: errors = " << errors << std::endl;
+
+    std::cout << "resource                vector ms        map ms" << std::endl;
+    report("default", std::pmr::get_default_resource());
+    report("pool_resource", &pool_resource::instance());
+    report("small_object_resource", &small);
+    report("arena_resource", &arena);
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::pmr_test
+
+} // namespace zephyr
+
+#endif // ZEPHYR_HAS_MEMORY_RESOURCE
@@ -0,0 +1,82 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+
+#include "../src/include/memory/pool_allocator.h"
+
+namespace zephyr
+{
+
+namespace pool_trim_test
+{
+
+// 当前进程常驻内存的字节数，读取失败时返回 0
+size_t rss() {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f == nullptr) return 0;
+    unsigned long size = 0, resident = 0;
+    if (fscanf(f, "%lu %lu", &size, &resident) != 2) resident = 0;
+    fclose(f);
+    return resident * 4096;
+}
+
+void print(const char* stage) {
+    pool_stats s = pool_allocator::stats();
+    std::cout << stage << ": reserved " << (s.reserved_bytes >> 20)
+              << " MiB, in use " << (s.in_use_bytes >> 20)
+              << " MiB, free spans " << (s.free_bytes >> 20)
+              << " MiB, released " << (s.released_bytes >> 20)
+              << " MiB, RSS " << (rss() >> 20) << " MiB" << std::endl;
+}
+
+enum { SPIKE = 200000 };
+
+// 瞬时分配一大批对象再全部释放，trim 之后常驻内存应当回落
+void spike(std::vector<void*>& blocks) {
+    for (size_t i = 0; i < blocks.size(); i++) {
+        blocks[i] = pool_allocator::allocate(64 + (i % 4) * 64);
+        *static_cast<size_t*>(blocks[i]) = i;
+    }
+    for (size_t i = 0; i < blocks.size(); i++)
+        pool_allocator::deallocate(blocks[i], 64 + (i % 4) * 64);
+}
+
+void pool_trim_test() {
+    std::vector<void*> blocks(SPIKE);
+    print("before spike");
+    spike(blocks);
+    pool_allocator::flush_thread_cache();
+    print("after spike ");
+    size_t released = pool_allocator::trim();
+    print("after trim  ");
+    std::cout << "trim released " << (released >> 20) << " MiB" << std::endl;
+
+    // 后台线程：空闲 span 超过 trigger 时回收到 retain 为止
+    pool_allocator::start_background_trim(trim_policy(4 * Z_span_bytes, 2 * Z_span_bytes, 10));
+    spike(blocks);
+    pool_allocator::flush_thread_cache();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    pool_allocator::stop_background_trim();
+    print("background  ");
+
+    // 前面只归还了物理页的 span，unmap 时一并解除映射，reserved 随之下降
+    size_t errors = (pool_allocator::free_bytes() != pool_allocator::stats().free_bytes);
+    pool_stats before = pool_allocator::stats();
+    size_t unmapped = pool_allocator::trim(0, true);
+    pool_stats after = pool_allocator::stats();
+    print("after unmap ");
+    errors += (unmapped == 0 || before.reserved_bytes - after.reserved_bytes < Z_span_bytes);
+    errors += (pool_allocator::free_bytes() != 0 || pool_allocator::trim(0, true) != 0);
+    std::cout << "trim with unmap: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::pool_trim_test
+
+} // namespace zephyr
@@ -0,0 +1,134 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <string>
+
+#include "../src/include/memory/allocator_stats.h"
+
+namespace zephyr
+{
+
+namespace stats_test
+{
+
+enum { OBJECTS = 10000 };
+
+// 两个线程各自分配，其中一个线程已经退出，计数仍应汇总进来
+size_t pool_stats_test() {
+    size_t errors = 0;
+    const size_t index = pool_allocator::Z_class_index(48);
+    pool_stats before = pool_allocator::stats();
+
+    std::vector<void*> blocks(2 * OBJECTS);
+    std::thread worker([&blocks]() {
+        for (int i = 0; i < OBJECTS; i++)
+            blocks[i] = pool_allocator::allocate(48);
+    });
+    worker.join();
+    for (int i = OBJECTS; i < 2 * OBJECTS; i++)
+        blocks[i] = pool_allocator::allocate(48);
+
+    pool_stats during = pool_allocator::stats();
+    for (size_t i = 0; i < blocks.size(); i++)
+        pool_allocator::deallocate(blocks[i], 48);
+    pool_stats after = pool_allocator::stats();
+
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    errors += (during.classes[index].allocations - before.classes[index].allocations != 2 * OBJECTS);
+    errors += (during.classes[index].live - before.classes[index].live != 2 * OBJECTS);
+    errors += (after.classes[index].live != before.classes[index].live);
+    errors += (during.classes[index].cached_high_water < 2 * OBJECTS);
+    errors += (during.live_bytes > during.in_use_bytes || during.in_use_bytes > during.reserved_bytes);
+    errors += (during.fragmentation < 0 || during.fragmentation > 1);
+#else
+    // 统计关闭时计数都为 0，前后两次快照没有可比较的内容
+    (void)before;
+    (void)after;
+#endif
+    errors += (during.classes[index].size != 48);
+
+    std::cout << "pool stats: live 48-byte objects " << during.classes[index].live
+              << ", refills " << during.classes[index].refills
+              << ", fragmentation " << during.fragmentation
+              << ", json " << to_json(during).size() << " bytes, prometheus "
+              << to_prometheus(during).size() << " bytes" << std::endl;
+    return errors;
+}
+
+size_t fixed_stats_test() {
+    size_t errors = 0;
+    zephyr::fixed_allocator<32> allocator;
+    std::vector<void*> blocks(OBJECTS);
+    for (int i = 0; i < OBJECTS; i++)
+        blocks[i] = allocator.allocate();
+    for (int i = 0; i < OBJECTS / 2; i++)
+        allocator.deallocate(blocks[i]);
+
+    fixed_allocator_stats s = allocator.stats();
+    errors += (s.live != OBJECTS / 2 || s.in_use_bytes != OBJECTS / 2 * 32);
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    errors += (s.allocations != OBJECTS || s.deallocations != OBJECTS / 2 || s.high_water != OBJECTS);
+    errors += (s.chunk_allocations < s.chunks);
+#endif
+    std::string text = to_prometheus(s);
+    errors += (text.find("zephyr_fixed_live_objects{size=\"32\"} 5000") == std::string::npos);
+    std::cout << to_json(s) << std::endl;
+
+    for (int i = OBJECTS / 2; i < OBJECTS; i++)
+        allocator.deallocate(blocks[i]);
+    return errors;
+}
+
+// 一个线程分配后退出，heap 被挂起；其他线程释放的块在下一个接管该 heap 的线程退出时收回并计入
+size_t concurrent_stats_test() {
+    typedef zephyr::concurrent_fixed_allocator<72> allocator;
+    size_t errors = 0;
+    fixed_allocator_stats before = allocator::stats();
+
+    std::vector<void*> blocks(OBJECTS);
+    std::thread producer([&blocks]() {
+        for (int i = 0; i < OBJECTS; i++)
+            blocks[i] = allocator::allocate();
+    });
+    producer.join();
+    fixed_allocator_stats during = allocator::stats();
+
+    for (int i = 0; i < OBJECTS; i++)
+        allocator::deallocate(blocks[i]);
+    std::thread adopter([]() {
+        allocator::deallocate(allocator::allocate());
+    });
+    adopter.join();
+    fixed_allocator_stats after = allocator::stats();
+
+    errors += (during.block_size != 72);
+#ifdef ZEPHYR_ALLOCATOR_STATS
+    errors += (during.allocations - before.allocations != OBJECTS);
+    errors += (during.live - before.live != OBJECTS || during.in_use_bytes - before.in_use_bytes != OBJECTS * 72);
+    errors += (during.chunks <= before.chunks || during.reserved_bytes < during.in_use_bytes);
+    errors += (during.high_water < OBJECTS);
+    errors += (after.deallocations - before.deallocations != OBJECTS + 1 || after.live != before.live);
+    errors += (after.chunks != before.chunks);
+#else
+    (void)before;
+    (void)after;
+#endif
+    std::string text = to_prometheus(allocator());
+    errors += (text.find("zephyr_loki_allocations_total{size=\"72\"}") == std::string::npos);
+    std::cout << "loki stats: " << to_json(during) << std::endl;
+    return errors;
+}
+
+void stats_test() {
+    size_t errors = pool_stats_test() + fixed_stats_test() + concurrent_stats_test();
+    std::cout << "allocator stats: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::stats_test
+
+} // namespace zephyr
@@ -3,11 +3,54 @@
 //
 
 #include "alloc_test.cpp"
+#include "thread_cache_test.cpp"
+#include "loki_test.cpp"
+#include "pool_trim_test.cpp"
+#include "page_source_test.cpp"
+#include "arena_test.cpp"
+#include "pmr_test.cpp"
+#include "allocator_test.cpp"
+#include "stats_test.cpp"
+#include "object_pool_test.cpp"
+#include "align_test.cpp"
+#include "global_allocator_test.cpp"
+#include "trace_test.cpp"
+#include "heap_profile_test.cpp"
+#include "construct_test.cpp"
+#include "vector_test.cpp"
+#include "hash_map_test.cpp"
+#include "lru_cache_test.cpp"
+
+// 定义在 link_test.cpp，单独编译后与本文件链接
+namespace zephyr { namespace link_test { void link_test(); } }
 
 int main()
 {
 
     zephyr::alloc_test::alloc_test();
+    zephyr::alloc_test::size_class_test();
+    zephyr::alloc_test::bulk_test();
+    zephyr::alloc_test::reallocate_test();
+    zephyr::thread_cache_test::thread_cache_test();
+    zephyr::loki_test::loki_test();
+    zephyr::pool_trim_test::pool_trim_test();
+    zephyr::page_source_test::page_source_test();
+    zephyr::arena_test::arena_test();
+    zephyr::allocator_test::allocator_test();
+    zephyr::stats_test::stats_test();
+    zephyr::object_pool_test::object_pool_test();
+    zephyr::align_test::align_test();
+    zephyr::global_allocator_test::global_allocator_test();
+    zephyr::trace_test::trace_test();
+    zephyr::heap_profile_test::heap_profile_test();
+    zephyr::construct_test::construct_test();
+    zephyr::vector_test::vector_test();
+    zephyr::hash_map_test::hash_map_test();
+    zephyr::lru_cache_test::lru_cache_test();
+    zephyr::link_test::link_test();
+#ifdef ZEPHYR_HAS_MEMORY_RESOURCE
+    zephyr::pmr_test::pmr_test();
+#endif
     return 0;
 
 }
\ No newline at end of file
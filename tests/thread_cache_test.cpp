@@ -0,0 +1,130 @@
+//
+// Created by Cu1 on 2026/10/17.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+#include "../src/include/memory/pool_allocator.h"
+
+namespace zephyr
+{
+
+namespace thread_cache_test
+{
+
+enum { BATCH = 64 };
+enum { ROUNDS = 20000 };
+
+// 每个线程反复申请 BATCH 个不同大小的块再全部释放
+template <typename Alloc, typename Dealloc>
+void worker(void** slots, Alloc alloc, Dealloc dealloc) {
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < BATCH; i++)
+            slots[i] = alloc(static_cast<size_t>((i % 16 + 1) * 8));
+        for (int i = 0; i < BATCH; i++)
+            dealloc(slots[i], static_cast<size_t>((i % 16 + 1) * 8));
+    }
+}
+
+template <typename Alloc, typename Dealloc>
+double run(int nthreads, Alloc alloc, Dealloc dealloc) {
+    // 提前准备好每个线程的槽位，线程内部不再调用 operator new
+    std::vector<void*> slots(static_cast<size_t>(nthreads) * BATCH);
+    std::vector<std::thread> threads;
+    threads.reserve(nthreads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < nthreads; t++)
+        threads.emplace_back(worker<Alloc, Dealloc>, &slots[t * BATCH], alloc, dealloc);
+    for (auto& th : threads)
+        th.join();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double ops = 2.0 * nthreads * ROUNDS * BATCH;
+    return ops / seconds / 1e6;
+}
+
+void* pool_alloc_fn(size_t n) { return pool_allocator::allocate(n); }
+void pool_dealloc_fn(void* p, size_t n) { pool_allocator::deallocate(p, n); }
+void* malloc_fn(size_t n) { return std::malloc(n); }
+void malloc_dealloc_fn(void* p, size_t) { std::free(p); }
+
+// 一个线程申请，另一个线程释放
+void cross_thread_test() {
+    std::vector<void*> blocks(BATCH * 16);
+    std::thread producer([&blocks]() {
+        for (size_t i = 0; i < blocks.size(); i++)
+            blocks[i] = pool_allocator::allocate(24);
+    });
+    producer.join();
+    std::thread consumer([&blocks]() {
+        for (size_t i = 0; i < blocks.size(); i++)
+            pool_allocator::deallocate(blocks[i], 24);
+    });
+    consumer.join();
+    std::cout << "cross thread free of " << blocks.size() << " blocks: ok" << std::endl;
+}
+
+// 在线程缓存之前构造的 thread_local 对象，析构时缓存已经析构，释放的块要直接回到中心链表
+struct exit_holder {
+    std::vector<void*> blocks;
+
+    ~exit_holder() {
+        for (void* p : blocks)
+            pool_allocator::deallocate(p, 40);
+        // 析构之后的分配、释放也不能留在缓存里
+        for (int i = 0; i < 100; i++)
+            pool_allocator::deallocate(pool_allocator::allocate(40), 40);
+        void* bulk[BATCH];
+        pool_allocator::allocate_bulk(40, bulk, BATCH);
+        pool_allocator::deallocate_bulk(40, bulk, BATCH);
+    }
+};
+
+// 线程退出后 in_use_bytes 回到原值
+size_t exit_free_test() {
+    size_t before = pool_allocator::stats().in_use_bytes;
+    for (int t = 0; t < 8; t++) {
+        std::thread th([]() {
+            static thread_local exit_holder holder;
+            for (int i = 0; i < BATCH; i++)
+                holder.blocks.push_back(pool_allocator::allocate(40));
+        });
+        th.join();
+    }
+    size_t after = pool_allocator::stats().in_use_bytes;
+    std::cout << "frees from thread_local destructors: in_use_bytes " << before << " -> " << after
+              << ", errors = " << (after != before) << std::endl;
+    return after != before;
+}
+
+void thread_cache_test() {
+    cross_thread_test();
+    exit_free_test();
+
+    int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (max_threads < 2) max_threads = 2;
+
+    std::cout << "threads   pool Mops/s   scaling   malloc Mops/s" << std::endl;
+    double base = 0;
+    for (int t = 1; t <= max_threads; t *= 2) {
+        double pool = run(t, pool_alloc_fn, pool_dealloc_fn);
+        double sys = run(t, malloc_fn, malloc_dealloc_fn);
+        if (t == 1) base = pool;
+        std::cout << std::setw(7) << t
+                  << std::setw(14) << std::fixed << std::setprecision(2) << pool
+                  << std::setw(10) << pool / base
+                  << std::setw(16) << sys << std::endl;
+    }
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::thread_cache_test
+
+} // namespace zephyr
@@ -0,0 +1,107 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../src/include/memory/alloc_trace.h"
+#include "../src/include/memory/pool_allocator.h"
+#include "../src/include/memory/loki_allocator.h"
+
+namespace zephyr
+{
+
+namespace trace_test
+{
+
+std::string temp_path() {
+    char path[] = "/tmp/zephyr_trace_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0)
+        close(fd);
+    return path;
+}
+
+// 按序号读回；写满以后只剩最近的 capacity 个，dropped 为被覆盖的个数
+size_t ring_test() {
+    size_t errors = 0;
+    std::string path = temp_path();
+    int dummy[1];
+
+    errors += !alloc_trace::start(path.c_str(), 8);
+    errors += alloc_trace::start(path.c_str(), 8);
+    for (size_t i = 0; i < 5; i++)
+        alloc_trace::record(trace_op::allocate, trace_source::pool, dummy, i);
+    alloc_trace::stop();
+    alloc_trace::record(trace_op::allocate, trace_source::pool, dummy, 100);
+
+    std::vector<trace_event> events;
+    uint64_t dropped = 1;
+    errors += !alloc_trace::read(path.c_str(), events, &dropped);
+    errors += (events.size() != 5 || dropped != 0);
+    for (size_t i = 0; i < events.size(); i++)
+        errors += (events[i].size != i || events[i].op != trace_op::allocate || events[i].thread == 0);
+
+    errors += !alloc_trace::start(path.c_str(), 8);
+    for (size_t i = 0; i < 20; i++)
+        alloc_trace::record(i % 2 ? trace_op::deallocate : trace_op::allocate, trace_source::fixed, dummy, i);
+    alloc_trace::stop();
+    errors += !alloc_trace::read(path.c_str(), events, &dropped);
+    errors += (events.size() != 8 || dropped != 12);
+    for (size_t i = 0; i < events.size(); i++)
+        errors += (events[i].size != 12 + i || events[i].source != trace_source::fixed);
+    for (size_t i = 1; i < events.size(); i++)
+        errors += (events[i].time < events[i - 1].time);
+
+    unlink(path.c_str());
+    errors += alloc_trace::read(path.c_str(), events);
+    return errors;
+}
+
+// 记录点编译进来时，分配、释放都留下事件，同一分级内的 reallocate 记成一次释放加一次分配
+size_t hook_test() {
+    size_t errors = 0;
+#ifdef ZEPHYR_ALLOCATOR_TRACE
+    std::string path = temp_path();
+    errors += !alloc_trace::start(path.c_str(), 1 << 12);
+    void* a = pool_allocator::allocate(40);
+    pool_allocator::deallocate(a, 40);
+    void* b = pool_allocator::allocate(41);
+    b = pool_allocator::reallocate(b, 41, 44);
+    pool_allocator::deallocate(b, 44);
+    void* c = concurrent_fixed_allocator<24>::allocate();
+    concurrent_fixed_allocator<24>::deallocate(c);
+    alloc_trace::stop();
+
+    std::vector<trace_event> events;
+    errors += !alloc_trace::read(path.c_str(), events);
+    const trace_op expect[] = {
+        trace_op::allocate, trace_op::deallocate,
+        trace_op::allocate, trace_op::deallocate, trace_op::allocate, trace_op::deallocate,
+        trace_op::allocate, trace_op::deallocate
+    };
+    errors += (events.size() != 8);
+    for (size_t i = 0; i < events.size() && i < 8; i++)
+        errors += (events[i].op != expect[i]);
+    if (events.size() == 8) {
+        errors += (events[1].address != reinterpret_cast<uintptr_t>(a));
+        errors += (events[4].size != 44 || events[5].size != 44);
+        errors += (events[6].source != trace_source::fixed || events[6].size != 24);
+    }
+    unlink(path.c_str());
+#endif
+    return errors;
+}
+
+void trace_test() {
+    size_t errors = ring_test() + hook_test();
+    std::cout << "alloc_trace ring / read back / hooks: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::trace_test
+
+} // namespace zephyr
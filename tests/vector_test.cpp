@@ -0,0 +1,268 @@
+//
+// Created by Cu1 on 2026/10/18.
+//
+
+#include <iostream>
+#include <sstream>
+#include <iterator>
+#include <string>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/include/container/vector.h"
+
+namespace zephyr
+{
+
+namespace vector_test
+{
+
+// 复制第 limit 次时抛出异常，统计存活的对象；移动可能抛出，vector 增长时只能复制
+struct fragile {
+    static int live;
+    static int limit;
+
+    int value;
+
+    fragile(int v = 0) : value(v) { ++live; }
+    fragile(const fragile& rhs) : value(rhs.value) {
+        if (limit == 0)
+            throw std::runtime_error("fragile");
+        if (limit > 0)
+            --limit;
+        ++live;
+    }
+    fragile(fragile&& rhs) : fragile(static_cast<const fragile&>(rhs)) {}
+    fragile& operator=(const fragile&) = default;
+    ~fragile() { --live; }
+};
+
+int fragile::live = 0;
+int fragile::limit = -1;
+
+// 只能移动、可以按字节搬移的句柄
+struct handle {
+    std::unique_ptr<int> p;
+    explicit handle(int v) : p(new int(v)) {}
+};
+
+} // namespace zephyr::vector_test
+
+template <>
+struct is_trivially_relocatable<vector_test::handle> : std::true_type {};
+
+namespace vector_test
+{
+
+template <typename V, typename R>
+bool same(const V& v, const R& expect) {
+    return v.size() == expect.size() && std::equal(v.begin(), v.end(), expect.begin());
+}
+
+size_t basic_test() {
+    size_t errors = 0;
+    zephyr::vector<int> v;
+    errors += (!v.empty() || v.capacity() != 0 || v.data() != nullptr);
+    for (int i = 0; i < 1000; i++)
+        v.push_back(i);
+    errors += (v.size() != 1000 || v.front() != 0 || v.back() != 999 || v[500] != 500);
+    // 池内的块按分级取整，容量取满整个块
+    errors += (v.capacity() * sizeof(int) != pool_allocator::good_size(v.capacity() * sizeof(int)));
+    v.pop_back();
+    errors += (v.size() != 999 || v.at(998) != 998);
+    bool thrown = false;
+    try {
+        v.at(999);
+    }
+    catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    errors += !thrown;
+
+    // 超过 Z_mmap_bytes 以后经 mremap 增长，内容不变
+    zephyr::vector<long> big;
+    for (long i = 0; i < 200000; i++)
+        big.push_back(i * 3);
+    long bad = 0;
+    for (long i = 0; i < 200000; i++)
+        bad += (big[i] != i * 3);
+    errors += (bad != 0);
+    big.resize(10);
+    big.shrink_to_fit();
+    errors += (big.size() != 10 || big.capacity() * sizeof(long) > 128 || big[9] != 27);
+
+    zephyr::vector<int> w(5, 7);
+    w.resize(8);
+    errors += !same(w, std::vector<int>{7, 7, 7, 7, 7, 0, 0, 0});
+    w.assign({1, 2, 3});
+    errors += !same(w, std::vector<int>{1, 2, 3});
+    w.clear();
+    w.shrink_to_fit();
+    errors += (w.capacity() != 0 || w.data() != nullptr);
+    return errors;
+}
+
+// 中间插入、删除与 std::vector 的结果一致
+size_t modify_test() {
+    size_t errors = 0;
+    zephyr::vector<std::string> v;
+    std::vector<std::string> expect;
+    for (int i = 0; i < 20; i++) {
+        std::string s(20 + i, char('a' + i));
+        v.push_back(s);
+        expect.push_back(s);
+    }
+    v.insert(v.begin() + 3, "x");
+    expect.insert(expect.begin() + 3, "x");
+    v.insert(v.begin() + 5, 4, "yy");
+    expect.insert(expect.begin() + 5, 4, "yy");
+    v.insert(v.end() - 2, 30, "zz");                  // 触发增长
+    expect.insert(expect.end() - 2, 30, "zz");
+    std::list<std::string> words = {"p", "q", "r"};
+    v.insert(v.begin() + 1, words.begin(), words.end());
+    expect.insert(expect.begin() + 1, words.begin(), words.end());
+    std::istringstream in("k l m");
+    v.insert(v.begin() + 2, std::istream_iterator<std::string>(in), std::istream_iterator<std::string>());
+    expect.insert(expect.begin() + 2, {"k", "l", "m"});
+    v.emplace(v.begin(), 3, 'e');
+    expect.emplace(expect.begin(), 3, 'e');
+    errors += !same(v, expect);
+
+    v.erase(v.begin() + 4);
+    expect.erase(expect.begin() + 4);
+    v.erase(v.begin() + 10, v.begin() + 30);
+    expect.erase(expect.begin() + 10, expect.begin() + 30);
+    errors += !same(v, expect);
+
+    // 参数引用容器自己的元素
+    v.shrink_to_fit();
+    v.push_back(v[0]);
+    expect.push_back(expect[0]);
+    v.insert(v.begin(), v.back());
+    expect.insert(expect.begin(), expect.back());
+    v.insert(v.begin() + 1, 2, v[3]);
+    expect.insert(expect.begin() + 1, 2, expect[3]);
+    errors += !same(v, expect);
+
+    zephyr::vector<std::string> copy(v);
+    zephyr::vector<std::string> moved(std::move(copy));
+    errors += (!copy.empty() || moved != v);
+    copy = moved;
+    moved.resize(3, "tail");
+    errors += (copy != v || moved.size() != 3 || !(moved < v || v < moved));
+    copy.swap(moved);
+    errors += (copy.size() != 3 || moved != v);
+    return errors;
+}
+
+size_t small_vector_test() {
+    size_t errors = 0;
+    zephyr::small_vector<std::string, 4> s;
+    errors += (!s.is_inline() || s.capacity() != 4);
+    for (int i = 0; i < 4; i++)
+        s.emplace_back(30, char('a' + i));
+    errors += !s.is_inline();
+    s.emplace_back(30, 'e');
+    errors += (s.is_inline() || s.size() != 5 || s[4] != std::string(30, 'e'));
+    s.pop_back();
+    s.shrink_to_fit();
+    errors += (!s.is_inline() || s[3] != std::string(30, 'd'));
+
+    // 移动内部的元素需要逐个搬移，交换一边在堆上、一边在内部的两个对象
+    zephyr::small_vector<std::string, 4> t(std::move(s));
+    errors += (!s.empty() || t.size() != 4 || t[0] != std::string(30, 'a'));
+    zephyr::small_vector<std::string, 4> u(10, "u");
+    t.swap(u);
+    errors += (t.size() != 10 || u.size() != 4 || !u.is_inline() || t.is_inline() || u[1] != std::string(30, 'b'));
+    u = t;
+    errors += (u != t);
+
+    zephyr::small_vector<int, 8> n = {1, 2, 3};
+    n.insert(n.begin() + 1, {9, 9});
+    n.erase(n.begin());
+    errors += !same(n, std::vector<int>{9, 9, 2, 3});
+    return errors;
+}
+
+// 可以平凡重定位的只能移动的类型：增长、插入、删除都整段搬移，没有泄漏也没有重复释放
+size_t relocate_test() {
+    size_t errors = 0;
+    zephyr::vector<handle> v;
+    for (int i = 0; i < 100; i++)
+        v.emplace_back(i);
+    v.emplace(v.begin() + 10, -1);
+    v.erase(v.begin() + 20, v.begin() + 30);
+    errors += (v.size() != 91 || *v[10].p != -1 || *v[11].p != 10 || *v[20].p != 29);
+
+    zephyr::small_vector<handle, 2> s;
+    s.emplace_back(1);
+    s.emplace_back(2);
+    s.emplace_back(3);
+    zephyr::small_vector<handle, 2> t(std::move(s));
+    errors += (t.size() != 3 || *t[2].p != 3);
+    t.pop_back();
+    t.shrink_to_fit();
+    errors += (!t.is_inline() || *t[1].p != 2);
+    return errors;
+}
+
+// 增长时复制失败：容器保持原样，没有多出或丢失的对象
+size_t exception_test() {
+    size_t errors = 0;
+    {
+        zephyr::vector<fragile> v;
+        for (int i = 0; i < 8; i++)
+            v.emplace_back(i);
+        v.shrink_to_fit();
+        int live = fragile::live;
+        fragile::limit = 4;
+        try {
+            v.push_back(fragile(100));
+            errors++;
+        }
+        catch (const std::runtime_error&) {}
+        fragile::limit = -1;
+        errors += (fragile::live != live || v.size() != 8 || v[7].value != 7);
+
+        fragile::limit = 3;
+        try {
+            v.insert(v.begin() + 2, 10, fragile(5));
+            errors++;
+        }
+        catch (const std::runtime_error&) {}
+        fragile::limit = -1;
+        errors += (fragile::live != live || v.size() != 8);
+    }
+    errors += (fragile::live != 0);
+    return errors;
+}
+
+// 其他内存来源：线程池、arena 与 std::allocator
+size_t backend_test() {
+    size_t errors = 0;
+    zephyr::arena a;
+    zephyr::vector<int> on_arena{allocator<int>(a)};
+    zephyr::vector<int> on_thread{allocator<int>::per_thread()};
+    zephyr::vector<int, std::allocator<int>> on_std;
+    for (int i = 0; i < 5000; i++) {
+        on_arena.push_back(i);
+        on_thread.push_back(i);
+        on_std.push_back(i);
+    }
+    errors += (on_arena.back() != 4999 || on_thread[1234] != 1234 || on_std.size() != 5000);
+    errors += (on_arena.get_allocator().backend() != allocator_backend::arena);
+    return errors;
+}
+
+void vector_test() {
+    size_t errors = basic_test() + modify_test() + small_vector_test() + relocate_test()
+                    + exception_test() + backend_test();
+    std::cout << "vector / small_vector: errors = " << errors << std::endl;
+    std::cout << "-------------------------------------------------------------------------" << std::endl;
+}
+
+} // namespace zephyr::vector_test
+
+} // namespace zephyr